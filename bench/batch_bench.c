@@ -0,0 +1,172 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+// Benchmark des parties aléatoires (rollouts) : une position à la fois avec
+// awale_play, contre des lots AwaleBatch avancés en parallèle
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../include/batch.h"
+
+#define NUM_BATCHES 64
+#define STEPS 20000
+
+static uint8_t nth_bit[1 << PITS_PER_SIDE][PITS_PER_SIDE];
+static uint8_t bit_count[1 << PITS_PER_SIDE];
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static inline uint32_t xorshift(uint32_t* x) {
+    *x ^= *x << 13;
+    *x ^= *x >> 17;
+    *x ^= *x << 5;
+    return *x;
+}
+
+static void init_bit_tables(void) {
+    for (int m = 0; m < (1 << PITS_PER_SIDE); m++) {
+        for (int i = 0; i < PITS_PER_SIDE; i++) {
+            if (m & (1 << i)) {
+                nth_bit[m][bit_count[m]++] = (uint8_t)i;
+            }
+        }
+    }
+}
+
+/**
+ * Choisit une case au hasard parmi celles du masque (BATCH_NO_MOVE si vide)
+ */
+static inline uint8_t pick(uint8_t mask, int player, uint32_t* rng) {
+    if (mask == 0) {
+        return BATCH_NO_MOVE;
+    }
+    return (uint8_t)(player * PITS_PER_SIDE + nth_bit[mask][xorshift(rng) % bit_count[mask]]);
+}
+
+static uint8_t scalar_mask(const AwaleState* s) {
+    return (uint8_t)awale_legal_moves(s);
+}
+
+/**
+ * Compare noyaux vectoriels et scalaires sur des positions de parties aléatoires
+ */
+static int verify(void) {
+    uint32_t rng = 12345;
+    AwaleBatch a, b;
+    AwaleState init;
+    awale_init(&init);
+    for (int lane = 0; lane < BATCH_LANES; lane++) {
+        batch_load(&a, lane, &init);
+    }
+
+    for (int step = 0; step < 200000; step++) {
+        uint8_t masks[BATCH_LANES], pits[BATCH_LANES], cap_a[BATCH_LANES], cap_b[BATCH_LANES];
+        uint32_t over = batch_terminal_mask(&a);
+        batch_move_masks(&a, masks);
+        for (int lane = 0; lane < BATCH_LANES; lane++) {
+            AwaleState s;
+            batch_store(&a, lane, &s);
+            if (((over >> lane) & 1) != (uint32_t)awale_is_over(&s) || masks[lane] != scalar_mask(&s)) {
+                fprintf(stderr, "Divergence masque/fin de partie (pas %d, voie %d)\n", step, lane);
+                return 1;
+            }
+            if (over & (1u << lane)) {
+                batch_load(&a, lane, &init);
+                pits[lane] = BATCH_NO_MOVE;
+            } else {
+                pits[lane] = pick(masks[lane], a.player[lane], &rng);
+            }
+        }
+        b = a;
+        batch_play(&a, pits, cap_a);
+        batch_play_scalar(&b, pits, cap_b);
+        if (memcmp(&a, &b, sizeof(a)) != 0 || memcmp(cap_a, cap_b, sizeof(cap_a)) != 0) {
+            fprintf(stderr, "Divergence batch_play / batch_play_scalar (pas %d)\n", step);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(void) {
+    init_bit_tables();
+    if (verify() != 0) {
+        return 1;
+    }
+
+    static AwaleState states[NUM_BATCHES * BATCH_LANES];
+    static AwaleBatch batches[NUM_BATCHES];
+    AwaleState init;
+    awale_init(&init);
+
+    // Une position à la fois
+    uint32_t rng = 1;
+    for (int i = 0; i < NUM_BATCHES * BATCH_LANES; i++) {
+        states[i] = init;
+    }
+    double t0 = now_sec();
+    for (int step = 0; step < STEPS; step++) {
+        for (int i = 0; i < NUM_BATCHES * BATCH_LANES; i++) {
+            if (awale_is_over(&states[i])) {
+                states[i] = init;
+            }
+            awale_play(&states[i], pick(scalar_mask(&states[i]), states[i].current_player, &rng));
+        }
+    }
+    double scalar = now_sec() - t0;
+
+    // Lots en parallèle
+    rng = 1;
+    for (int k = 0; k < NUM_BATCHES; k++) {
+        for (int lane = 0; lane < BATCH_LANES; lane++) {
+            batch_load(&batches[k], lane, &init);
+        }
+    }
+    t0 = now_sec();
+    for (int step = 0; step < STEPS; step++) {
+        for (int k = 0; k < NUM_BATCHES; k++) {
+            uint8_t masks[BATCH_LANES], pits[BATCH_LANES], cap[BATCH_LANES];
+            uint32_t over = batch_terminal_mask(&batches[k]);
+            while (over) {
+                int lane = __builtin_ctz(over);
+                batch_load(&batches[k], lane, &init);
+                over &= over - 1;
+            }
+            batch_move_masks(&batches[k], masks);
+            for (int lane = 0; lane < BATCH_LANES; lane++) {
+                pits[lane] = pick(masks[lane], batches[k].player[lane], &rng);
+            }
+            batch_play(&batches[k], pits, cap);
+        }
+    }
+    double batched = now_sec() - t0;
+
+    double moves = (double)STEPS * NUM_BATCHES * BATCH_LANES;
+    printf("%d voies x %d lots, %d pas (%s)\n", BATCH_LANES, NUM_BATCHES, STEPS,
+#if defined(BATCH_SCALAR)
+           "scalaire"
+#elif defined(__AVX2__)
+           "AVX2"
+#elif defined(__SSE2__)
+           "SSE2"
+#else
+           "scalaire"
+#endif
+    );
+    printf("awale_play (une position) : %8.1f M coups/s\n", moves / scalar / 1e6);
+    printf("batch_play (lots)         : %8.1f M coups/s (x%.2f)\n", moves / batched / 1e6, scalar / batched);
+    return 0;
+}
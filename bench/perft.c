@@ -0,0 +1,188 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+// Perft : énumère l'arbre de jeu jusqu'à une profondeur donnée et compte les
+// feuilles. Sert à la fois de test de non-régression des règles (comparaison
+// avec des valeurs de référence) et de mesure de vitesse du moteur (noeuds/s).
+//
+// Usage : perft [-d profondeur] [fichier]
+//   -d N     : perft de la position initiale, profondeurs 1 à N (sans référence)
+//   fichier  : suite de positions avec leurs valeurs de référence
+//              (bench/perft_positions.txt par défaut)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../include/game.h"
+
+#define DEFAULT_SUITE "bench/perft_positions.txt"
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Nombre de positions atteintes en exactement depth demi-coups.
+ * Une partie terminée (score gagnant, ou aucun coup légal) n'a pas de
+ * successeur : elle ne compte que si elle est atteinte à la profondeur voulue.
+ */
+static unsigned long long perft(const AwaleState* s, int depth) {
+    if (depth == 0) {
+        return 1;
+    }
+    if (s->scores[0] >= WINNING_SCORE || s->scores[1] >= WINNING_SCORE) {
+        return 0;
+    }
+    int legal = awale_legal_moves(s);
+    if (depth == 1) {
+        return (unsigned long long)__builtin_popcount(legal);
+    }
+
+    unsigned long long nodes = 0;
+    int first = s->current_player * PITS_PER_SIDE;
+    while (legal) {
+        int i = __builtin_ctz(legal);
+        legal &= legal - 1;
+        AwaleState child = *s;
+        awale_play(&child, first + i);
+        nodes += perft(&child, depth - 1);
+    }
+    return nodes;
+}
+
+/**
+ * Lance un perft chronométré et affiche le résultat.
+ * expected < 0 : pas de valeur de référence. Retourne 1 en cas d'écart.
+ */
+static int run(const AwaleState* s, int depth, long long expected, int line, double* total_time,
+               unsigned long long* total_nodes) {
+    double t0 = now_sec();
+    unsigned long long nodes = perft(s, depth);
+    double elapsed = now_sec() - t0;
+    *total_time += elapsed;
+    *total_nodes += nodes;
+
+    double rate = elapsed > 0 ? nodes / elapsed / 1e6 : 0;
+    if (expected < 0) {
+        printf("profondeur %2d : %14llu noeuds  %8.3f s  %7.2f M noeuds/s\n", depth, nodes, elapsed, rate);
+        return 0;
+    }
+    int ok = nodes == (unsigned long long)expected;
+    printf("ligne %3d, profondeur %2d : %14llu noeuds  %8.3f s  %7.2f M noeuds/s  %s\n",
+           line, depth, nodes, elapsed, rate, ok ? "OK" : "ECHEC");
+    if (!ok) {
+        printf("    attendu : %lld\n", expected);
+    }
+    return !ok;
+}
+
+/**
+ * Lit une suite de positions. Une ligne par test (# pour les commentaires) :
+ *   12 cases (0 à 11), score P1, score P2, joueur au trait (0/1), profondeur, noeuds attendus
+ */
+static int run_suite(const char* path, double* total_time, unsigned long long* total_nodes) {
+    FILE* f = fopen(path, "r");
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    char buffer[256];
+    int line = 0;
+    int tests = 0;
+    int failures = 0;
+    while (fgets(buffer, sizeof(buffer), f) != NULL) {
+        line++;
+        char* p = buffer;
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == '\0') {
+            continue;
+        }
+
+        int v[NUM_PITS + 4];
+        long long expected;
+        int n = 0;
+        int used;
+        for (; n < NUM_PITS + 4 && sscanf(p, "%d%n", &v[n], &used) == 1; n++) {
+            p += used;
+        }
+        if (n != NUM_PITS + 4 || sscanf(p, "%lld", &expected) != 1) {
+            fprintf(stderr, "%s:%d : ligne invalide\n", path, line);
+            failures++;
+            continue;
+        }
+
+        AwaleState s;
+        int seeds = v[NUM_PITS] + v[NUM_PITS + 1];
+        for (int i = 0; i < NUM_PITS; i++) {
+            s.board[i] = (char)v[i];
+            seeds += v[i];
+        }
+        s.scores[0] = (char)v[NUM_PITS];
+        s.scores[1] = (char)v[NUM_PITS + 1];
+        s.current_player = (char)v[NUM_PITS + 2];
+        s.key = awale_hash(&s);
+        if (seeds != TOTAL_SEEDS || (s.current_player != 0 && s.current_player != 1)) {
+            fprintf(stderr, "%s:%d : position invalide (%d graines)\n", path, line, seeds);
+            failures++;
+            continue;
+        }
+
+        failures += run(&s, v[NUM_PITS + 3], expected, line, total_time, total_nodes);
+        tests++;
+    }
+    fclose(f);
+
+    printf("%d tests, %d échec(s)\n", tests, failures);
+    return failures;
+}
+
+int main(int argc, char** argv) {
+    int depth = 0;
+    const char* suite = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            depth = atoi(argv[++i]);
+        } else if (argv[i][0] != '-') {
+            suite = argv[i];
+        } else {
+            fprintf(stderr, "Usage : %s [-d profondeur] [fichier]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    double total_time = 0;
+    unsigned long long total_nodes = 0;
+    int failures = 0;
+
+    if (depth > 0) {
+        AwaleState s;
+        awale_init(&s);
+        printf("Position initiale\n");
+        for (int d = 1; d <= depth; d++) {
+            run(&s, d, -1, 0, &total_time, &total_nodes);
+        }
+    }
+    if (depth == 0 || suite != NULL) {
+        failures = run_suite(suite != NULL ? suite : DEFAULT_SUITE, &total_time, &total_nodes);
+        if (failures < 0) {
+            return 2;
+        }
+    }
+
+    printf("total : %llu noeuds en %.3f s (%.2f M noeuds/s)\n", total_nodes, total_time,
+           total_time > 0 ? total_nodes / total_time / 1e6 : 0);
+    return failures > 0;
+}
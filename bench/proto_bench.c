@@ -0,0 +1,317 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+// Benchmark de la sérialisation des messages : ligne STATE (snprintf côté
+// serveur, sscanf côté client) contre trame STATE v2 et STATE_DELTA entre
+// deux positions consécutives, et traduction d'une ligne MSG en trame.
+// Affiche le coût par message et les octets envoyés. Mesure aussi la
+// diffusion d'une ligne à de nombreux destinataires : copie dans chaque
+// OutputQueue (ce que fait le serveur) contre une référence vers un message
+// partagé à compteur, à comparer au send que chaque destinataire coûte de
+// toute façon (un socket TCP par client).
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../include/outq.h"
+#include "../include/proto.h"
+
+#define NUM_POSITIONS 4096
+#define ROUNDS 500
+#define FANOUT_QUEUES 1000  // Destinataires d'une diffusion
+#define FANOUT_ROUNDS 2000
+#define SEND_COUNT 200000   // send d'une ligne sur la boucle locale
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Mêmes formats que le serveur et le client
+static int format_state(char* out, size_t cap, const AwaleState* s) {
+    return snprintf(out, cap, "STATE %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d\n",
+                    s->board[0], s->board[1], s->board[2], s->board[3], s->board[4], s->board[5],
+                    s->board[6], s->board[7], s->board[8], s->board[9], s->board[10], s->board[11],
+                    s->scores[0], s->scores[1], s->current_player);
+}
+
+static int parse_state(const char* line, AwaleState* s) {
+    int b[12], s0, s1, cur;
+    if (sscanf(line + 6, "%d %d %d %d %d %d %d %d %d %d %d %d %d %d %d",
+               &b[0], &b[1], &b[2], &b[3], &b[4], &b[5], &b[6], &b[7], &b[8], &b[9], &b[10], &b[11],
+               &s0, &s1, &cur) != 15) {
+        return 0;
+    }
+    for (int k = 0; k < NUM_PITS; k++) {
+        s->board[k] = (char)b[k];
+    }
+    s->scores[0] = (char)s0;
+    s->scores[1] = (char)s1;
+    s->current_player = (char)cur;
+    s->key = awale_hash(s);
+    return 1;
+}
+
+// Message partagé par tous ses destinataires : ce que coûterait, au mieux,
+// une file de références (sans la construction des iovec à l'envoi)
+typedef struct {
+    const char* data;
+    size_t len;
+    int refs;
+} SharedMessage;
+
+typedef struct {
+    SharedMessage* items[8];
+    int count;
+} RefQueue;
+
+// Copie de la ligne dans la file de chaque destinataire, puis remise des
+// files comme en fin de tour (outq_take, outq_sent) ; ns par destinataire
+static double fanout_copy(OutputQueue* queues, const char* msg, size_t len) {
+    double t0 = now_sec();
+    for (int r = 0; r < FANOUT_ROUNDS; r++) {
+        for (int q = 0; q < FANOUT_QUEUES; q++) {
+            outq_push(&queues[q], msg, len);
+        }
+        for (int q = 0; q < FANOUT_QUEUES; q++) {
+            outq_sent(&queues[q], outq_take(&queues[q]));
+        }
+    }
+    return 1e9 * (now_sec() - t0) / ((double)FANOUT_ROUNDS * FANOUT_QUEUES);
+}
+
+static double fanout_ref(RefQueue* queues, const char* msg, size_t len) {
+    SharedMessage m = {msg, len, 0};
+    double t0 = now_sec();
+    for (int r = 0; r < FANOUT_ROUNDS; r++) {
+        for (int q = 0; q < FANOUT_QUEUES; q++) {
+            __atomic_add_fetch(&m.refs, 1, __ATOMIC_RELAXED);
+            queues[q].items[queues[q].count++] = &m;
+        }
+        for (int q = 0; q < FANOUT_QUEUES; q++) {
+            while (queues[q].count > 0) {
+                __atomic_sub_fetch(&queues[q].items[--queues[q].count]->refs, 1, __ATOMIC_ACQ_REL);
+            }
+        }
+    }
+    return 1e9 * (now_sec() - t0) / ((double)FANOUT_ROUNDS * FANOUT_QUEUES);
+}
+
+// Un send de la ligne sur une connexion TCP locale, comme le serveur en
+// fait un par destinataire et par tour ; ns par send, lecture exclue
+static double send_cost(const char* msg, size_t len) {
+    int srv = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in a = {0};
+    socklen_t alen = sizeof(a);
+    a.sin_family = AF_INET;
+    a.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (srv < 0 || bind(srv, (struct sockaddr*)&a, sizeof(a)) < 0 || listen(srv, 1) < 0 ||
+        getsockname(srv, (struct sockaddr*)&a, &alen) < 0) {
+        return -1;
+    }
+    int out = socket(AF_INET, SOCK_STREAM, 0);
+    if (out < 0 || connect(out, (struct sockaddr*)&a, sizeof(a)) < 0) {
+        return -1;
+    }
+    int in = accept(srv, NULL, NULL);
+    int one = 1;
+    setsockopt(out, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    
+    char drain[65536];
+    double elapsed = 0;
+    for (int i = 0; i < SEND_COUNT; i += 64) {
+        double t0 = now_sec();
+        for (int k = 0; k < 64; k++) {
+            if (send(out, msg, len, MSG_NOSIGNAL) < 0) {
+                return -1;
+            }
+        }
+        elapsed += now_sec() - t0;
+        size_t pending = 64 * len;
+        while (pending > 0) {
+            ssize_t n = recv(in, drain, sizeof(drain), 0);
+            if (n <= 0) {
+                return -1;
+            }
+            pending -= (size_t)n;
+        }
+    }
+    close(in);
+    close(out);
+    close(srv);
+    return 1e9 * elapsed / SEND_COUNT;
+}
+
+int main(void) {
+    // Positions de parties aléatoires
+    static AwaleState positions[NUM_POSITIONS];
+    AwaleState s;
+    awale_init(&s);
+    srand(1);
+    for (int i = 0; i < NUM_POSITIONS; i++) {
+        if (awale_is_over(&s) || awale_legal_moves(&s) == 0) {
+            awale_init(&s);
+        }
+        int moves = awale_legal_moves(&s);
+        int pit;
+        do {
+            pit = rand() % PITS_PER_SIDE;
+        } while (!(moves & (1 << pit)));
+        awale_play(&s, s.current_player * PITS_PER_SIDE + pit);
+        positions[i] = s;
+    }
+
+    // Vérification : les deux formes rendent la même position
+    for (int i = 0; i < NUM_POSITIONS; i++) {
+        char line[128];
+        char frame[PROTO_HEADER_LEN + PROTO_STATE_LEN];
+        AwaleState a, b;
+        format_state(line, sizeof(line), &positions[i]);
+        proto_encode_state(frame, &positions[i]);
+        if (!parse_state(line, &a)) {
+            fprintf(stderr, "Ligne STATE illisible : %s", line);
+            return 1;
+        }
+        proto_decode_state(frame + PROTO_HEADER_LEN, &b);
+        if (memcmp(a.board, b.board, NUM_PITS) != 0 || a.scores[0] != b.scores[0] ||
+            a.scores[1] != b.scores[1] || a.current_player != b.current_player || a.key != b.key) {
+            fprintf(stderr, "Divergence texte / trame (position %d)\n", i);
+            return 1;
+        }
+        char delta[PROTO_HEADER_LEN + PROTO_DELTA_MAX_LEN];
+        size_t n = proto_encode_delta(delta, i > 0 ? &positions[i - 1] : NULL, &positions[i], (unsigned)i);
+        int seq = i - 1;
+        AwaleState c = i > 0 ? positions[i - 1] : positions[i];
+        if (proto_apply_delta(delta + PROTO_HEADER_LEN, n - PROTO_HEADER_LEN, &c, &seq) != 1 ||
+            memcmp(&c, &positions[i], sizeof(AwaleState)) != 0) {
+            fprintf(stderr, "Divergence delta (position %d)\n", i);
+            return 1;
+        }
+    }
+
+    double count = (double)NUM_POSITIONS * ROUNDS;
+    char line[128];
+    char frame[PROTO_HEADER_LEN + PROTO_MAX_PAYLOAD];
+    size_t text_bytes = 0;
+    size_t frame_bytes = 0;
+    unsigned sink = 0;
+
+    double t0 = now_sec();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < NUM_POSITIONS; i++) {
+            text_bytes += (size_t)format_state(line, sizeof(line), &positions[i]);
+        }
+    }
+    double text_encode = now_sec() - t0;
+
+    t0 = now_sec();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < NUM_POSITIONS; i++) {
+            frame_bytes += proto_encode_state(frame, &positions[i]);
+            sink += (unsigned char)frame[PROTO_HEADER_LEN + i % PROTO_STATE_LEN];
+        }
+    }
+    double frame_encode = now_sec() - t0;
+
+    t0 = now_sec();
+    for (int r = 0; r < ROUNDS / 10; r++) {
+        for (int i = 0; i < NUM_POSITIONS; i++) {
+            format_state(line, sizeof(line), &positions[i]);
+            parse_state(line, &s);
+            sink += (unsigned)s.key;
+        }
+    }
+    double text_decode = (now_sec() - t0) * 10;
+
+    t0 = now_sec();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < NUM_POSITIONS; i++) {
+            proto_encode_state(frame, &positions[i]);
+            proto_decode_state(frame + PROTO_HEADER_LEN, &s);
+            sink += (unsigned)s.key;
+        }
+    }
+    double frame_decode = now_sec() - t0 - frame_encode;
+
+    // Deltas entre positions consécutives (la première est une position complète)
+    size_t delta_bytes = 0;
+    t0 = now_sec();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 1; i < NUM_POSITIONS; i++) {
+            delta_bytes += proto_encode_delta(frame, &positions[i - 1], &positions[i], (unsigned)i);
+            sink += (unsigned char)frame[PROTO_HEADER_LEN];
+        }
+    }
+    double delta_encode = now_sec() - t0;
+
+    t0 = now_sec();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 1; i < NUM_POSITIONS; i++) {
+            size_t n = proto_encode_delta(frame, &positions[i - 1], &positions[i], (unsigned)i);
+            int seq = i - 1;
+            s = positions[i - 1];
+            proto_apply_delta(frame + PROTO_HEADER_LEN, n - PROTO_HEADER_LEN, &s, &seq);
+            sink += (unsigned)s.key;
+        }
+    }
+    double delta_apply = now_sec() - t0 - delta_encode;
+    double delta_count = (double)(NUM_POSITIONS - 1) * ROUNDS;
+
+    // Une ligne MSG typique d'un coup, traduite en trame pour un client v2
+    const char* msg = "MSG alice a déplacé les graines de la case 3.\n";
+    t0 = now_sec();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < NUM_POSITIONS; i++) {
+            sink += (unsigned)proto_encode_line(msg, strlen(msg), frame, sizeof(frame));
+        }
+    }
+    double msg_encode = now_sec() - t0;
+
+    printf("%d positions x %d (contrôle %u)\n", NUM_POSITIONS, ROUNDS, sink);
+    printf("STATE texte  : %5.1f octets, encodage %6.1f ns, décodage (sscanf) %6.1f ns\n",
+           (double)text_bytes / count, 1e9 * text_encode / count, 1e9 * (text_decode - text_encode) / count);
+    printf("STATE trame  : %5.1f octets, encodage %6.1f ns, décodage          %6.1f ns\n",
+           (double)frame_bytes / count, 1e9 * frame_encode / count, 1e9 * frame_decode / count);
+    printf("STATE_DELTA  : %5.1f octets, encodage %6.1f ns, application       %6.1f ns\n",
+           (double)delta_bytes / delta_count, 1e9 * delta_encode / delta_count,
+           1e9 * delta_apply / delta_count);
+    printf("MSG -> trame : %5zu octets, traduction %6.1f ns\n", strlen(msg) + PROTO_HEADER_LEN - 5,
+           1e9 * msg_encode / count);
+
+    // Diffusion d'une ligne STATE et d'un CHAT long à FANOUT_QUEUES destinataires
+    static OutputQueue queues[FANOUT_QUEUES];
+    static RefQueue refs[FANOUT_QUEUES];
+    for (int q = 0; q < FANOUT_QUEUES; q++) {
+        outq_init(&queues[q]);
+    }
+    char chat[256];
+    int chat_len = snprintf(chat, sizeof(chat), "CHAT alice %0198d\n", 0);
+    const char* lines[2] = {line, chat};
+    size_t lens[2] = {(size_t)format_state(line, sizeof(line), &positions[0]), (size_t)chat_len};
+    printf("Diffusion à %d destinataires, par destinataire :\n", FANOUT_QUEUES);
+    for (int k = 0; k < 2; k++) {
+        double copy = fanout_copy(queues, lines[k], lens[k]);
+        double shared = fanout_ref(refs, lines[k], lens[k]);
+        double sent = send_cost(lines[k], lens[k]);
+        printf("  %3zu octets : copie %5.1f ns, référence %5.1f ns, send TCP %7.1f ns (copie : %.1f %%)\n",
+               lens[k], copy, shared, sent, 100 * copy / (copy + sent));
+    }
+    for (int q = 0; q < FANOUT_QUEUES; q++) {
+        outq_free(&queues[q]);
+    }
+    return 0;
+}
@@ -0,0 +1,179 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+// Benchmark de la recherche alpha-bêta : même suite de positions, à
+// profondeur fixe, sans table de transposition puis avec des tables de
+// tailles croissantes. Affiche noeuds, temps, taux de succès, de collision
+// (bucket occupé par une autre position) et de remplacement de la table pour
+// aider à la dimensionner.
+// Mesure ensuite le temps pour atteindre la profondeur avec 1, 2, 4 et 8
+// threads (Lazy SMP, table vidée avant chaque série).
+//
+// Usage : search_bench [-d profondeur] [fichier]
+//   fichier : positions au format de bench/perft_positions.txt (les deux
+//             dernières colonnes sont ignorées)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../include/engine.h"
+
+#define DEFAULT_SUITE "bench/perft_positions.txt"
+#define DEFAULT_DEPTH 14
+#define MAX_POSITIONS 64
+
+#define SMP_TT_MB 16
+
+static const size_t TT_SIZES_MB[] = {0, 1, 4, 16, 64};
+static const int THREAD_COUNTS[] = {1, 2, 4, 8};
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Charge les positions distinctes et non terminées du fichier
+ */
+static int load_positions(const char* path, AwaleState* positions) {
+    FILE* f = fopen(path, "r");
+    if (f == NULL) {
+        perror(path);
+        return -1;
+    }
+
+    char buffer[256];
+    int n = 0;
+    while (n < MAX_POSITIONS && fgets(buffer, sizeof(buffer), f) != NULL) {
+        int v[NUM_PITS + 3];
+        char* p = buffer;
+        int k = 0;
+        int used;
+        for (; k < NUM_PITS + 3 && sscanf(p, "%d%n", &v[k], &used) == 1; k++) {
+            p += used;
+        }
+        if (k != NUM_PITS + 3) {
+            continue;  // Commentaire ou ligne vide
+        }
+
+        AwaleState s;
+        for (int i = 0; i < NUM_PITS; i++) {
+            s.board[i] = (char)v[i];
+        }
+        s.scores[0] = (char)v[NUM_PITS];
+        s.scores[1] = (char)v[NUM_PITS + 1];
+        s.current_player = (char)v[NUM_PITS + 2];
+        s.key = awale_hash(&s);
+
+        int duplicate = 0;
+        for (int i = 0; i < n; i++) {
+            duplicate |= positions[i].key == s.key;
+        }
+        if (!duplicate && !awale_is_over(&s)) {
+            positions[n++] = s;
+        }
+    }
+    fclose(f);
+    return n;
+}
+
+int main(int argc, char** argv) {
+    int depth = DEFAULT_DEPTH;
+    const char* suite = DEFAULT_SUITE;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            depth = atoi(argv[++i]);
+        } else if (argv[i][0] != '-') {
+            suite = argv[i];
+        } else {
+            fprintf(stderr, "Usage : %s [-d profondeur] [fichier]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    static AwaleState positions[MAX_POSITIONS];
+    int n = load_positions(suite, positions);
+    if (n <= 0) {
+        return 2;
+    }
+    printf("%d positions, profondeur %d\n", n, depth);
+    printf("%8s %14s %9s %10s %8s %10s %9s %11s\n",
+           "table", "noeuds", "temps (s)", "M noeuds/s", "succès", "collisions", "remplac.", "remplissage");
+
+    for (size_t t = 0; t < sizeof(TT_SIZES_MB) / sizeof(TT_SIZES_MB[0]); t++) {
+        TranspositionTable tt;
+        TranspositionTable* table = NULL;
+        if (TT_SIZES_MB[t] > 0) {
+            if (tt_init(&tt, TT_SIZES_MB[t]) != 0) {
+                fprintf(stderr, "Allocation de %zu Mo impossible\n", TT_SIZES_MB[t]);
+                return 1;
+            }
+            table = &tt;
+        }
+
+        unsigned long long nodes = 0;
+        double t0 = now_sec();
+        for (int i = 0; i < n; i++) {
+            EngineLimits limits = {.max_depth = depth, .tt = table, .threads = 1};
+            EngineResult result;
+            engine_search(&positions[i], &limits, &result);
+            nodes += result.nodes;
+        }
+        double elapsed = now_sec() - t0;
+
+        char label[16];
+        if (table == NULL) {
+            printf("%8s %14llu %9.3f %10.2f %8s %10s %9s %11s\n", "aucune", nodes, elapsed,
+                   nodes / elapsed / 1e6, "-", "-", "-", "-");
+            continue;
+        }
+        TTStats stats;
+        tt_get_stats(table, &stats);
+        snprintf(label, sizeof(label), "%zu Mo", TT_SIZES_MB[t]);
+        printf("%8s %14llu %9.3f %10.2f %7.1f%% %9.1f%% %8.1f%% %10.1f%%\n", label, nodes, elapsed,
+               nodes / elapsed / 1e6,
+               stats.probes ? 100.0 * stats.hits / stats.probes : 0.0,
+               stats.probes ? 100.0 * stats.collisions / stats.probes : 0.0,
+               stats.stores ? 100.0 * stats.replacements / stats.stores : 0.0,
+               tt_fill_permille(table) / 10.0);
+        tt_free(table);
+    }
+
+    TranspositionTable tt;
+    if (tt_init(&tt, SMP_TT_MB) != 0) {
+        fprintf(stderr, "Allocation de %d Mo impossible\n", SMP_TT_MB);
+        return 1;
+    }
+    printf("\nLazy SMP, table %d Mo : temps pour atteindre la profondeur %d\n", SMP_TT_MB, depth);
+    printf("%8s %14s %9s %10s %8s\n", "threads", "noeuds", "temps (s)", "M noeuds/s", "accél.");
+
+    double base = 0;
+    for (size_t t = 0; t < sizeof(THREAD_COUNTS) / sizeof(THREAD_COUNTS[0]); t++) {
+        tt_clear(&tt);
+        unsigned long long nodes = 0;
+        double t0 = now_sec();
+        for (int i = 0; i < n; i++) {
+            EngineLimits limits = {.max_depth = depth, .tt = &tt, .threads = THREAD_COUNTS[t]};
+            EngineResult result;
+            engine_search(&positions[i], &limits, &result);
+            nodes += result.nodes;
+        }
+        double elapsed = now_sec() - t0;
+        if (t == 0) {
+            base = elapsed;
+        }
+        printf("%8d %14llu %9.3f %10.2f %7.2fx\n", THREAD_COUNTS[t], nodes, elapsed,
+               nodes / elapsed / 1e6, base / elapsed);
+    }
+    tt_free(&tt);
+    return 0;
+}
@@ -0,0 +1,164 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+// Benchmark du noyau de semis : boucle graine par graine (ancienne version)
+// contre le noyau à tables précalculées de game.c (awale_sow + awale_capture,
+// qui ne touchent que le plateau), puis le coup complet awale_play (légalité
+// et mise à jour de la clé de Zobrist comprises)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../include/game.h"
+
+#define NUM_POSITIONS 4096
+#define ROUNDS 2000
+
+/**
+ * Ancien semis (une graine par itération, avec modulo)
+ */
+static int legacy_sow(AwaleState* s, int pit) {
+    int seeds = s->board[pit];
+    s->board[pit] = 0;
+    int index = pit;
+    while (seeds > 0) {
+        index = (index + 1) % NUM_PITS;
+        if (index != pit) {
+            s->board[index]++;
+            seeds--;
+        }
+    }
+    return index;
+}
+
+/**
+ * Ancienne capture récursive
+ */
+static int legacy_capture(AwaleState* s, int player, int last_pit) {
+    if ((((player == 0) && (last_pit >= 6 && last_pit <= 11)) ||
+         ((player == 1) && (last_pit >= 0 && last_pit < 6)))
+        && (s->board[last_pit] == 2 || s->board[last_pit] == 3)) {
+        int collected = s->board[last_pit];
+        s->board[last_pit] = 0;
+        return collected + legacy_capture(s, player, (last_pit - 1 + NUM_PITS) % NUM_PITS);
+    }
+    return 0;
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Génère des positions réalistes par parties aléatoires
+ */
+static int build_positions(AwaleState* positions, int* pits) {
+    int n = 0;
+    srand(42);
+    while (n < NUM_POSITIONS) {
+        AwaleState s;
+        awale_init(&s);
+        while (!awale_is_over(&s) && n < NUM_POSITIONS) {
+            int legal = awale_legal_moves(&s);
+            int i;
+            do {
+                i = rand() % PITS_PER_SIDE;
+            } while (!(legal & (1 << i)));
+            int pit = s.current_player * PITS_PER_SIDE + i;
+            positions[n] = s;
+            pits[n] = pit;
+            n++;
+            awale_play(&s, pit);
+        }
+    }
+    return n;
+}
+
+int main(void) {
+    static AwaleState positions[NUM_POSITIONS];
+    static int pits[NUM_POSITIONS];
+    int n = build_positions(positions, pits);
+
+    // Vérifier que les deux versions donnent exactement le même résultat.
+    // Seul un grand chelem (tout le camp adverse pris) peut les séparer :
+    // awale_capture l'annule, l'ancienne capture le prenait. Ces positions
+    // sont comptées à part, leurs graines servent au contrôle final.
+    int grand_slams = 0;
+    long grand_slam_seeds = 0;
+    for (int i = 0; i < n; i++) {
+        AwaleState a = positions[i], b = positions[i];
+        int la = legacy_sow(&a, pits[i]);
+        int lb = awale_sow(&b, pits[i]);
+        int ca = legacy_capture(&a, a.current_player, la);
+        int cb = awale_capture(&b, b.current_player, lb);
+        int first = (1 - a.current_player) * PITS_PER_SIDE;
+        int left = 0;
+        for (int k = first; k < first + PITS_PER_SIDE; k++) {
+            left += a.board[k];
+        }
+        if (la == lb && ca > 0 && cb == 0 && left == 0) {
+            grand_slams++;
+            grand_slam_seeds += ca;
+        } else if (la != lb || ca != cb || memcmp(a.board, b.board, NUM_PITS) != 0) {
+            fprintf(stderr, "Divergence sur la position %d (pit %d)\n", i, pits[i]);
+            return 1;
+        }
+        AwaleState c = positions[i];
+        awale_play(&c, pits[i]);
+        if (c.key != awale_hash(&c)) {
+            fprintf(stderr, "Clé fausse après le coup %d de la position %d\n", pits[i], i);
+            return 1;
+        }
+    }
+
+    long legacy_captured = 0;
+    long table_captured = 0;
+    double t0 = now_sec();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < n; i++) {
+            AwaleState s = positions[i];
+            int last = legacy_sow(&s, pits[i]);
+            legacy_captured += legacy_capture(&s, s.current_player, last);
+        }
+    }
+    double legacy = now_sec() - t0;
+
+    t0 = now_sec();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < n; i++) {
+            AwaleState s = positions[i];
+            int last = awale_sow(&s, pits[i]);
+            table_captured += awale_capture(&s, s.current_player, last);
+        }
+    }
+    double table = now_sec() - t0;
+
+    long played_captured = 0;
+    t0 = now_sec();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int i = 0; i < n; i++) {
+            AwaleState s = positions[i];
+            played_captured += awale_play(&s, pits[i]);
+        }
+    }
+    double played = now_sec() - t0;
+
+    double moves = (double)n * ROUNDS;
+    printf("positions: %d, coups joués: %.0f\n", n, moves);
+    printf("boucle graine par graine : %8.2f ns/coup\n", legacy * 1e9 / moves);
+    printf("noyau à tables           : %8.2f ns/coup (x%.2f)\n", table * 1e9 / moves, legacy / table);
+    printf("awale_play (légal + clé) : %8.2f ns/coup\n", played * 1e9 / moves);
+    printf("graines capturées: %ld (ancienne capture), %ld (avec grand chelem), %d grands chelems annulés\n",
+           legacy_captured, table_captured, grand_slams);
+    return legacy_captured - table_captured != grand_slam_seeds * ROUNDS || played_captured != table_captured;
+}
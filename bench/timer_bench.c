@@ -0,0 +1,80 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+// Benchmark de la roue de timers du serveur : coût d'armer, de réarmer
+// (déplacer un timer armé, comme le battement de cœur d'un client actif)
+// et d'annuler, puis de rendre les timers échus en faisant avancer
+// l'horloge, pour des roues de 1 000 à 1 000 000 timers. Le coût par
+// opération doit rester le même quelle que soit la taille.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../include/timer.h"
+
+#define TICK_MS 100
+#define MAX_DELAY_MS (3600 * 1000)  // Délais tirés jusqu'à une heure
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void run(int n) {
+    Timer* timers = malloc(n * sizeof(Timer));
+    uint64_t* delays = malloc(n * sizeof(uint64_t));
+    unsigned seed = 12345;
+    for (int i = 0; i < n; i++) {
+        timer_init(&timers[i], 0, i);
+        delays[i] = (uint64_t)(rand_r(&seed) % MAX_DELAY_MS);
+    }
+    TimerWheel w;
+    timer_wheel_init(&w, TICK_MS, 0);
+
+    double t0 = now_sec();
+    for (int i = 0; i < n; i++) {
+        timer_arm(&w, &timers[i], delays[i], 0);
+    }
+    double t1 = now_sec();
+    for (int i = 0; i < n; i++) {
+        timer_arm(&w, &timers[i], delays[n - 1 - i], 0);
+    }
+    double t2 = now_sec();
+    for (int i = 0; i < n; i++) {
+        timer_cancel(&w, &timers[i]);
+    }
+    double t3 = now_sec();
+
+    // Expiration : l'horloge avance par pas d'une seconde sur une heure
+    for (int i = 0; i < n; i++) {
+        timer_arm(&w, &timers[i], delays[i], 0);
+    }
+    int expired = 0;
+    double t4 = now_sec();
+    for (uint64_t now = 0; now <= MAX_DELAY_MS + 1000; now += 1000) {
+        while (timer_next_expired(&w, now) != NULL) {
+            expired++;
+        }
+    }
+    double t5 = now_sec();
+
+    printf("%8d timers : armer %5.1f ns, réarmer %5.1f ns, annuler %5.1f ns, échoir %5.1f ns (%d rendus)\n",
+           n, (t1 - t0) * 1e9 / n, (t2 - t1) * 1e9 / n, (t3 - t2) * 1e9 / n, (t5 - t4) * 1e9 / n, expired);
+    free(timers);
+    free(delays);
+}
+
+int main(void) {
+    for (int n = 1000; n <= 1000000; n *= 10) {
+        run(n);
+    }
+    return 0;
+}
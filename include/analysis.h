@@ -0,0 +1,75 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+//---------- Interface of the <Analysis> (file analysis.h) ----------------
+// Service d'analyse du serveur : un groupe de threads exécute les recherches
+// demandées (HINT, ANALYZE) et renvoie chaque tâche terminée par un pipe
+// surveillé par la boucle select. Les résultats sont gardés dans un cache
+// LRU indexé par clé de position, sans verrou interne : le serveur, dont
+// chaque réacteur peut le consulter, en sérialise l'accès.
+
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+#include <stdint.h>
+
+#include "engine.h"
+
+typedef enum {
+    ANALYSIS_HINT = 0,     // Conseil rapide
+    ANALYSIS_FULL,         // Analyse plus profonde (ANALYZE)
+    ANALYSIS_KINDS
+} AnalysisKind;
+
+typedef struct {
+    int pit;               // Meilleur coup, -1 si aucun
+    int score;             // Évaluation pour le joueur au trait
+    int depth;
+    unsigned long long nodes;
+    int time_ms;
+} AnalysisResult;
+
+typedef struct {
+    int client_idx;        // Demandeur
+    unsigned serial;       // Partie au moment de la demande
+    AnalysisKind kind;
+    AwaleState state;
+    AnalysisResult result;
+} AnalysisJob;
+
+// Ressources partagées par toutes les recherches
+typedef struct {
+    TranspositionTable* tt;
+    const EndgameDB* egdb;
+} AnalysisConfig;
+
+// Lance workers threads ; chaque tâche terminée est écrite (pointeur) dans notify_fd
+int analysis_start(int workers, int notify_fd, const AnalysisConfig* config);
+
+// Confie une tâche (allouée avec malloc) au groupe ; -1 si la file est pleine
+int analysis_submit(AnalysisJob* job);
+
+// Cache LRU des résultats (boucle principale uniquement)
+typedef struct AnalysisCacheEntry AnalysisCacheEntry;
+typedef struct {
+    AnalysisCacheEntry* entries;
+    int* buckets;          // Tête de chaîne par bucket (-1 = vide)
+    int capacity;
+    int num_buckets;       // Puissance de 2
+    int used;
+    int head;              // Plus récemment utilisée
+    int tail;              // Prochaine à évincer
+    unsigned long long hits;
+    unsigned long long misses;
+} AnalysisCache;
+
+int analysis_cache_init(AnalysisCache* cache, int capacity);
+int analysis_cache_get(AnalysisCache* cache, uint64_t key, AnalysisKind kind, AnalysisResult* result);
+void analysis_cache_put(AnalysisCache* cache, uint64_t key, AnalysisKind kind, const AnalysisResult* result);
+
+#endif // ANALYSIS_H
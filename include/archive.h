@@ -0,0 +1,53 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+//---------- Interface of the <Archive> (file archive.h) ----------------
+// Lecture des parties sauvegardées par le serveur (saved_games/*.txt).
+// Chaque partie est rejouée depuis la position initiale : un coup illégal ou
+// une capture différente de celle enregistrée rend le fichier invalide.
+
+#ifndef ARCHIVE_H
+#define ARCHIVE_H
+#include <stdio.h>
+
+#include "game.h"
+
+#define ARCHIVE_DIR "saved_games"
+#define ARCHIVE_NAME_LEN 32
+#define ARCHIVE_MAX_MOVES 512
+
+enum { ARCHIVE_DRAW = -1, ARCHIVE_UNFINISHED = -2 };
+
+typedef struct {
+    char players[2][ARCHIVE_NAME_LEN];
+    int winner;                     // 0 ou 1, ARCHIVE_DRAW ou ARCHIVE_UNFINISHED
+    int final_scores[2];            // Tels qu'enregistrés
+    int num_moves;
+    int pits[ARCHIVE_MAX_MOVES];
+    AwaleState final_state;         // Position après le dernier coup
+    int line;                       // Ligne fautive si la lecture échoue
+    const char* error;              // Cause de l'échec (NULL si succès)
+} ArchiveGame;
+
+// Lit et rejoue une partie ; 0 si succès, -1 sinon (game->error, game->line)
+int archive_read_game(FILE* f, ArchiveGame* game);
+
+// Compare le score final enregistré à la simulation : NULL s'il est cohérent,
+// sinon la cause. Une partie terminée doit avoir le score obtenu après
+// ramassage des graines restantes ; une partie arrêtée avant la fin (abandon,
+// forfait, égalité acceptée) le score courant ; une partie arbitrée par la
+// base de finales un score complété jusqu'à 48 graines.
+const char* archive_check_result(const ArchiveGame* game);
+
+// Parcourt les fichiers .txt d'un dossier un par un ; visit reçoit chaque
+// partie, lue ou non (ok). Retourne le nombre de fichiers, -1 si dossier illisible.
+typedef void (*ArchiveVisitor)(const char* path, const ArchiveGame* game, int ok, void* ctx);
+int archive_scan(const char* dir, ArchiveVisitor visit, void* ctx);
+
+#endif // ARCHIVE_H
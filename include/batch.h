@@ -0,0 +1,44 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+//---------- Interface of the <Batch> (file batch.h) ----------------
+// Lot de BATCH_LANES positions indépendantes rangées en structure de tableaux :
+// chaque case est une ligne de BATCH_LANES octets, ce qui permet de faire
+// avancer toutes les positions du lot en même temps (SSE2/AVX2 ou scalaire).
+
+#ifndef BATCH_H
+#define BATCH_H
+#include <stdint.h>
+
+#include "game.h"
+
+#define BATCH_LANES 32
+#define BATCH_NO_MOVE 0xFF  // Valeur de case pour une voie qui ne joue pas
+
+typedef struct {
+    uint8_t pits[NUM_PITS][BATCH_LANES];  // pits[case][voie]
+    uint8_t scores[2][BATCH_LANES];
+    uint8_t player[BATCH_LANES];          // Joueur au trait de chaque voie
+} __attribute__((aligned(32))) AwaleBatch;
+
+void batch_load(AwaleBatch* b, int lane, const AwaleState* s);
+void batch_store(const AwaleBatch* b, int lane, AwaleState* s);
+
+// Joue pits[voie] sur chaque voie (coups supposés valides, BATCH_NO_MOVE pour passer)
+// captured[voie] reçoit le nombre de graines capturées
+void batch_play(AwaleBatch* b, const uint8_t pits[BATCH_LANES], uint8_t captured[BATCH_LANES]);
+void batch_play_scalar(AwaleBatch* b, const uint8_t pits[BATCH_LANES], uint8_t captured[BATCH_LANES]);
+
+// Coups légaux du joueur au trait (bit i = i-ème case de son camp, comme awale_legal_moves)
+void batch_move_masks(const AwaleBatch* b, uint8_t masks[BATCH_LANES]);
+
+// Bit v à 1 si la position de la voie v est terminée (même règle que awale_is_over)
+uint32_t batch_terminal_mask(const AwaleBatch* b);
+
+#endif // BATCH_H
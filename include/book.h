@@ -0,0 +1,62 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+//---------- Interface of the <OpeningBook> (file book.h) ----------------
+// Livre d'ouvertures construit à partir des parties sauvegardées
+// (src/tools/build_book.c) : pour chaque position des premiers demi-coups et
+// chaque coup joué, le nombre de parties et leur issue. Les entrées sont
+// triées par clé de Zobrist : une recherche dichotomique sur le fichier
+// projeté en mémoire suffit.
+
+#ifndef BOOK_H
+#define BOOK_H
+#include <stddef.h>
+#include <stdint.h>
+
+#include "game.h"
+
+#define BOOK_MAGIC "AWBK"
+#define BOOK_VERSION 1
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint64_t count;      // Nombre d'entrées qui suivent l'en-tête
+} BookHeader;
+
+typedef struct {
+    uint64_t key;        // Clé de Zobrist de la position
+    uint8_t pit;         // Coup joué (case 0-11)
+    uint8_t reserved[3];
+    uint32_t games;      // Parties où ce coup a été joué
+    uint32_t wins;       // ... gagnées par le joueur qui l'a joué
+    uint32_t draws;
+} BookEntry;
+
+typedef struct {
+    void* map;           // Fichier projeté (NULL = pas de livre)
+    size_t size;
+    const BookEntry* entries;
+    uint64_t count;
+} OpeningBook;
+
+// 0 si succès ; book->map reste NULL en cas d'échec
+int book_open(OpeningBook* book, const char* path);
+void book_close(OpeningBook* book);
+
+// Coups connus de la position (au plus PITS_PER_SIDE), triés du meilleur au moins bon
+int book_probe(const OpeningBook* book, const AwaleState* s, BookEntry moves[PITS_PER_SIDE]);
+
+// Meilleur coup légal du livre ; 1 si trouvé
+int book_best_move(const OpeningBook* book, const AwaleState* s, BookEntry* best);
+
+// Score d'un coup entre 0 et 1 (victoire = 1, nulle = 0.5, lissé par le nombre de parties)
+double book_score(const BookEntry* e);
+
+#endif // BOOK_H
@@ -0,0 +1,62 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+//---------- Interface of the <EndgameDB> (file egdb.h) ----------------
+// Base de finales : pour chaque position d'au plus max_seeds graines sur le
+// plateau, l'écart final (graines gagnées par le joueur au trait moins celles
+// de l'adversaire) en jeu parfait. Générée par src/tools/gen_egdb.c par
+// analyse rétrograde ; le fichier est projeté en mémoire (mmap) et les pages
+// ne sont lues qu'à la première consultation.
+//
+// L'écart suppose que la partie continue jusqu'au plateau vide, sans
+// s'arrêter à 25 : une fois ce score atteint le vainqueur ne peut plus
+// changer, le signe donne donc l'issue exacte. Une partie sans fin (cycle)
+// compte comme un partage égal des graines restantes.
+
+#ifndef EGDB_H
+#define EGDB_H
+#include <stddef.h>
+#include <stdint.h>
+
+#include "game.h"
+
+#define EGDB_MAGIC "AWDB"
+#define EGDB_VERSION 1
+#define EGDB_MAX_SEEDS 20
+
+// En-tête du fichier, suivi des tables (un octet signé par position) ;
+// les positions sont vues du joueur au trait (ses cases d'abord)
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint32_t max_seeds;
+    uint32_t reserved;
+    uint64_t offsets[EGDB_MAX_SEEDS + 1];  // Début de la table à n graines
+} EgdbHeader;
+
+typedef struct {
+    void* map;         // Fichier projeté (NULL = pas de base)
+    size_t size;
+    int max_seeds;
+    const int8_t* tables[EGDB_MAX_SEEDS + 1];
+} EndgameDB;
+
+// Index parfait : rang de la répartition de seeds graines dans les 12 cases
+uint64_t egdb_count(int seeds);
+uint64_t egdb_index(const char board[NUM_PITS], int seeds);
+int egdb_board_seeds(const AwaleState* s);
+
+// 0 si succès ; db->map reste NULL en cas d'échec
+int egdb_open(EndgameDB* db, const char* path);
+void egdb_close(EndgameDB* db);
+
+// 1 si la position est dans la base (*margin = écart final pour le joueur au trait)
+int egdb_probe(const EndgameDB* db, const AwaleState* s, int* margin);
+
+#endif // EGDB_H
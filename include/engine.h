@@ -0,0 +1,53 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+//---------- Interface of the <Engine> (file engine.h) ----------------
+// Recherche negamax alpha-bêta avec approfondissement itératif, utilisée par
+// les bots du serveur. Réentrante : aucune variable globale. Avec une table
+// de transposition, la recherche peut se répartir sur plusieurs threads.
+
+#ifndef ENGINE_H
+#define ENGINE_H
+#include "book.h"
+#include "egdb.h"
+#include "game.h"
+#include "tt.h"
+
+#define ENGINE_INFINITY 1000
+#define ENGINE_WIN 900      // Score d'une victoire (moins la distance en demi-coups)
+#define ENGINE_MAX_DEPTH 64
+#define ENGINE_DB_WIN 500   // Victoire prouvée par la base de finales (plus l'écart final)
+
+typedef struct {
+    int max_depth;             // Profondeur maximale (demi-coups)
+    int time_ms;               // Budget de temps (0 = pas de limite)
+    const volatile int* stop;  // Arrêt demandé de l'extérieur (peut être NULL)
+    TranspositionTable* tt;    // Table partagée (NULL = pas de table)
+    int threads;               // Threads de recherche (Lazy SMP, exige tt ; <= 1 = un seul)
+    const EndgameDB* egdb;     // Base de finales (NULL = pas de base)
+    const OpeningBook* book;   // Livre d'ouvertures, consulté avant toute recherche
+} EngineLimits;
+
+typedef struct {
+    int pit;                   // Meilleur coup (case 0-11), -1 si aucun coup légal
+    int score;                 // Évaluation du point de vue du joueur au trait
+    int depth;                 // Dernière profondeur entièrement explorée (0 = coup du livre)
+    unsigned long long nodes;  // Noeuds visités
+    int time_ms;               // Temps écoulé
+    TTStats tt_stats;          // Accès à la table pendant cette recherche
+} EngineResult;
+
+// Évaluation statique du point de vue du joueur au trait
+int engine_evaluate(const AwaleState* s);
+
+// Cherche le meilleur coup ; la profondeur 1 est toujours terminée,
+// les itérations suivantes s'arrêtent dès que le budget est dépassé
+int engine_search(const AwaleState* s, const EngineLimits* limits, EngineResult* result);
+
+#endif // ENGINE_H
@@ -10,25 +10,36 @@
 //---------- Interface of the <Game> (file Game.h) ----------------
 #ifndef GAME_H
 #define GAME_H
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-extern char board[12];
-extern char scores[2];
-extern char current_player;
-extern char game_over;
+#define NUM_PITS 12
+#define PITS_PER_SIDE 6
+#define TOTAL_SEEDS 48
+#define WINNING_SCORE 25
 
-void init_game();
-void display_board();
-char is_game_over(char continued);
-void collect_remaining_seeds(char continued);
-void declare_winner(char continued);
-char collect_seeds(char player, char last_pit_index);
-char play_turn(char player);
-char move(char player);
-void switch_player();
-char proposition_draw(char player);
+// État complet d'une position (type valeur, sans aucune variable globale)
+typedef struct {
+    char board[NUM_PITS];  // Graines dans chaque case (0-5: P1, 6-11: P2)
+    char scores[2];        // Graines capturées par chaque joueur
+    char current_player;   // Joueur au trait (0 ou 1)
+    uint64_t key;          // Clé de Zobrist, tenue à jour par awale_play et awale_collect_remaining
+} AwaleState;
+
+// Moteur de règles (fonctions pures sur un état passé en paramètre)
+void awale_init(AwaleState* s);
+int awale_legal_moves(const AwaleState* s);
+int awale_is_valid_move(const AwaleState* s, int pit);
+int awale_sow(AwaleState* s, int pit);                       // Plateau seul, clé inchangée
+int awale_capture(AwaleState* s, int player, int last_pit);  // Plateau seul, clé inchangée
+int awale_play(AwaleState* s, int pit);
+int awale_is_over(const AwaleState* s);
+void awale_collect_remaining(AwaleState* s);
+uint64_t awale_hash(const AwaleState* s);  // Recalcule la clé (position construite à la main)
+
+// Partie interactive en console
+void display_board(const AwaleState* s);
 void game_loop();
 
 #endif // GAME_H
-
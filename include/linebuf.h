@@ -0,0 +1,52 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+//---------- Interface of the <LineBuffer> (file linebuf.h) ----------------
+// Tampon circulaire de réception d'une connexion : un seul recv lit tout ce
+// qui est disponible, les lignes complètes sont ensuite extraites une à une.
+// Une ligne incomplète reste dans le tampon jusqu'au recv suivant. Les
+// trames du protocole v2 (proto.h) passent par le même tampon.
+
+#ifndef LINEBUF_H
+#define LINEBUF_H
+#include <stddef.h>
+#include <sys/types.h>
+
+#define LINEBUF_SIZE 8192  // Assez pour la plus grande réponse du serveur (REPLAY)
+
+typedef struct {
+    char data[LINEBUF_SIZE];
+    size_t head;  // Premier octet non lu
+    size_t len;   // Octets en attente
+} LineBuffer;
+
+void linebuf_init(LineBuffer* lb);
+
+// Un recv dans la place libre (flags : MSG_DONTWAIT...) ; comme recv,
+// retourne le nombre d'octets lus, 0 si la connexion est fermée, -1 sinon
+ssize_t linebuf_fill(LineBuffer* lb, int fd, int flags);
+
+// Copie des octets déjà reçus (io_uring) dans la place libre ; retourne le
+// nombre d'octets copiés, moins que n si le tampon est plein
+size_t linebuf_append(LineBuffer* lb, const char* data, size_t n);
+
+// Vrai si linebuf_next_line a une ligne à rendre
+int linebuf_has_line(const LineBuffer* lb);
+
+// Extrait la prochaine ligne, sans '\n', tronquée à cap - 1 caractères.
+// Un tampon plein sans '\n' est rendu tel quel. Retourne 0 si aucune ligne.
+int linebuf_next_line(LineBuffer* lb, char* out, size_t cap);
+
+// Copie les n premiers octets en attente sans les consommer (n <= len)
+void linebuf_peek(const LineBuffer* lb, char* out, size_t n);
+
+// Consomme les n premiers octets en attente (n <= len)
+void linebuf_skip(LineBuffer* lb, size_t n);
+
+#endif // LINEBUF_H
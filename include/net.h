@@ -12,10 +12,12 @@
 #ifndef NET_H
 #define NET_H
 #include "game.h"
+#include "linebuf.h"
+#include "outq.h"
+#include "timer.h"
 
 #define MAX_USERNAME_LEN 30
 #define MAX_CLIENTS 30
-#define MAX_SPECTATORS 20
 #define MAX_BIO_LINES 10
 #define MAX_BIO_LINE_LEN 80
 #define MAX_FRIENDS 20
@@ -38,6 +40,7 @@ typedef struct {
     ClientStatus status;
     int opponent_index;  // Index de l'adversaire dans le tableau des clients
     int challenged_by;   // Index du client qui a envoyé un défi (-1 si aucun)
+    unsigned challenged_session;  // Sa connexion : le défi ne vaut que pour elle
     int watching_game;   // Index de la partie regardée (-1 si aucune)
     char bio[MAX_BIO_LINES][MAX_BIO_LINE_LEN];  // Bio du joueur (10 lignes max)
     int bio_lines;       // Nombre de lignes de bio
@@ -50,8 +53,26 @@ typedef struct {
     int save_response;   // Réponse à la demande de sauvegarde: -1=pas de réponse, 0=non, 1=oui
     int game_to_save;    // Index de la partie à sauvegarder (-1 si aucune)
     int elo_score;       // Score ELO du joueur (100 par défaut)
+    int is_bot;          // 1 si ce slot est un bot du serveur (pas de socket)
+    int bot_level;       // Niveau du bot (bot-N), 0 pour un humain
+    LineBuffer input;    // Octets reçus, pas encore découpés en lignes
+    OutputQueue output;  // Octets que le socket n'a pas encore acceptés
+    int reactor;         // Shard (réacteur) qui a le client en charge : lui seul lit et écrit
+                         // son socket, traite ses commandes et touche à ses champs
+    unsigned session;    // Numéro de la connexion sur cet emplacement (courrier entre shards)
+    int flush_queued;    // Déjà dans la liste des files à envoyer de son réacteur
+    int proto;           // 1 : lignes de texte, 2 : trames binaires (proto.h)
+    int delta;           // Reçoit les positions en STATE_DELTA (jeton DELTA, v2 seulement)
+    unsigned state_game; // Partie (serial) et numéro de la dernière position mise en file,
+    unsigned state_seq;  // base du prochain STATE_DELTA
+    int recv_pending;    // Recv multishot io_uring pas encore terminé (emplacement non réutilisable)
+    Timer timer;         // Inscription, battement de cœur et inactivité (timers du serveur)
+    Timer challenge_timer;  // Défi reçu (challenged_by) sans réponse
+    Timer save_timer;    // ASKSAVE sans réponse
+    uint64_t connected_at;  // Heures en ms (timer_now_ms) : connexion,
+    uint64_t last_input;    // dernières données reçues (PONG compris),
+    uint64_t last_command;  // dernière commande autre que PONG,
+    uint64_t ping_sent;     // PING sans réponse (0 si aucun)
 } Client;
 
-int apply_move_from_pit(int player, int pit_index);
-
 #endif // NET_H
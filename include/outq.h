@@ -0,0 +1,57 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+//---------- Interface of the <OutputQueue> (file outq.h) ----------------
+// File d'envoi d'une connexion non bloquante : ce que send n'a pas pu écrire
+// est gardé et renvoyé quand le socket redevient inscriptible. La politique
+// en cas de congestion (limites, coalescence) est décidée par le serveur.
+
+#ifndef OUTQ_H
+#define OUTQ_H
+#include <stddef.h>
+#include <sys/types.h>
+
+#define OUTQ_STATE_LEN 128
+
+typedef struct {
+    char* data;
+    size_t head;       // Premier octet non envoyé
+    size_t len;        // Octets en attente
+    size_t cap;
+    char* sending;     // Tampon remis d'un bloc par outq_take (envoi asynchrone)
+    size_t sending_cap;
+    size_t sending_head;
+    size_t inflight;   // Octets remis, dont l'envoi n'est pas encore confirmé
+    char pending_state[OUTQ_STATE_LEN];  // Dernier STATE retenu pendant la congestion (ligne ou trame)
+    size_t pending_state_len;            // 0 si aucun
+    int closed;        // Connexion coupée pour lenteur : plus rien n'est mis en file
+    unsigned long long queued;   // Octets acceptés au total
+    unsigned long long dropped;  // Octets abandonnés (STATE remplacés, connexion coupée)
+} OutputQueue;
+
+void outq_init(OutputQueue* q);
+void outq_free(OutputQueue* q);
+
+// Ajoute n octets en fin de file ; -1 si la mémoire manque
+int outq_push(OutputQueue* q, const char* s, size_t n);
+
+// Envoie ce qui peut l'être sans bloquer ; retourne les octets encore en
+// attente, -1 si la connexion est en erreur (la file est alors vidée)
+ssize_t outq_flush(OutputQueue* q, int fd);
+
+// Envoi asynchrone (io_uring) : outq_take remet d'un bloc les octets en
+// attente et retourne leur nombre (0 si un envoi est déjà en cours). Ils
+// restent valides à l'adresse outq_sending jusqu'à ce que outq_sent ait
+// confirmé leur envoi ; la file continue pendant ce temps dans un second
+// tampon. outq_sent retourne ce qui reste à envoyer de la remise.
+size_t outq_take(OutputQueue* q);
+const char* outq_sending(const OutputQueue* q);
+size_t outq_sent(OutputQueue* q, size_t n);
+
+#endif // OUTQ_H
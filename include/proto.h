@@ -0,0 +1,132 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+//---------- Interface of the <Proto> (file proto.h) ----------------
+// Protocole binaire v2, optionnel. Le serveur l'annonce dans sa première
+// ligne ("REGISTER V2") ; un client qui répond "USERNAME <nom> V2" échange
+// des trames dans les deux sens dès la ligne suivante. Les autres clients
+// restent en lignes de texte.
+//
+// Trame : opcode (1 octet), longueur du contenu (2 octets, gros-boutiste),
+// contenu. L'opcode remplace le mot-clé de la ligne de texte et le contenu
+// en est le reste, sans le '\n' final : il peut contenir des sauts de ligne
+// (bio, historique, partie rejouée). STATE porte les 15 octets de la
+// position (12 cases, 2 scores, joueur au trait), MOVE un octet (la case).
+//
+// Avec le jeton DELTA en plus ("USERNAME <nom> V2 DELTA"), les positions
+// arrivent en STATE_DELTA : numéro de séquence (1 octet, modulo 256),
+// masque (2 octets, gros-boutiste : bits 0-11 les cases, 12 et 13 les
+// scores, 14 le joueur au trait, 15 position complète), puis un octet par
+// champ du masque, dans l'ordre des bits. Un delta ne s'applique qu'à la
+// position de numéro précédent ; sinon le client demande RESYNC et attend
+// une position complète.
+
+#ifndef PROTO_H
+#define PROTO_H
+#include <stddef.h>
+
+#include "game.h"
+#include "linebuf.h"
+
+#define PROTO_V2_TOKEN "V2"
+#define PROTO_DELTA_TOKEN "DELTA"
+#define PROTO_HEADER_LEN 3
+#define PROTO_STATE_LEN 15
+#define PROTO_DELTA_MAX_LEN (3 + PROTO_STATE_LEN)
+#define PROTO_DELTA_FULL 0x8000
+#define PROTO_MAX_PAYLOAD (LINEBUF_SIZE - PROTO_HEADER_LEN)  // Une trame tient dans un LineBuffer
+
+enum {
+    PROTO_TEXT = 0,             // Ligne sans mot-clé (saisie de la bio)
+    // Serveur -> client
+    PROTO_REGISTER,
+    PROTO_MSG,
+    PROTO_CHAT,                 // Aussi client -> serveur
+    PROTO_STATE,
+    PROTO_ROLE,
+    PROTO_END,
+    PROTO_ASKDRAW,
+    PROTO_ASKSAVE,
+    PROTO_HINT,                 // Aussi client -> serveur
+    PROTO_ANALYSIS,
+    PROTO_USERLIST,
+    PROTO_GAMESLIST,
+    PROTO_CHALLENGED_BY,
+    PROTO_BIO,                  // Aussi client -> serveur
+    PROTO_REPLAY,               // Aussi client -> serveur
+    PROTO_STATE_DELTA,
+    PROTO_PING,                 // Battement de cœur : le client répond PONG
+    // Client -> serveur
+    PROTO_USERNAME = 32,
+    PROTO_MOVE,
+    PROTO_DRAW,
+    PROTO_YES,
+    PROTO_NO,
+    PROTO_QUIT,
+    PROTO_LIST,
+    PROTO_GAMES,
+    PROTO_CHALLENGE,
+    PROTO_ACCEPT,
+    PROTO_REFUSE,
+    PROTO_WATCH,
+    PROTO_BOARD,
+    PROTO_STOPWATCH,
+    PROTO_WHOIS,
+    PROTO_ADDFRIEND,
+    PROTO_ACCEPTFRIEND,
+    PROTO_LISTFRIENDREQUESTS,
+    PROTO_REMOVEFRIEND,
+    PROTO_LISTFRIENDS,
+    PROTO_PRIVATE,
+    PROTO_SAVE,
+    PROTO_HISTORY,
+    PROTO_ANALYZE,
+    PROTO_RESYNC,
+    PROTO_PONG,
+    PROTO_NUM_OPCODES
+};
+
+// Trame STATE d'une position ; retourne sa taille (en-tête compris)
+size_t proto_encode_state(char* out, const AwaleState* s);
+
+// Position portée par le contenu d'une trame STATE (clé recalculée)
+void proto_decode_state(const char* payload, AwaleState* s);
+
+// Trame STATE_DELTA qui mène de from à to, de numéro seq ; position
+// complète si from est NULL. Retourne sa taille (en-tête compris).
+size_t proto_encode_delta(char* out, const AwaleState* from, const AwaleState* to, unsigned seq);
+
+// Applique le contenu d'une trame STATE_DELTA à la position s, de numéro
+// *seq (-1 si aucune). Retourne 1 si appliqué, 0 si le delta ne suit pas
+// *seq (trou : demander RESYNC), -1 si la trame est mal formée.
+int proto_apply_delta(const char* payload, size_t len, AwaleState* s, int* seq);
+
+// Traduit une ligne de texte (avec ou sans '\n' final) en trame ; le
+// contenu au-delà de cap est tronqué. Retourne la taille de la trame.
+size_t proto_encode_line(const char* line, size_t n, char* out, size_t cap);
+
+// Vrai si le contenu d'une trame tient sur une seule ligne de texte : ni
+// '\n', ni '\r', ni '\0' (sauf dans l'octet binaire de MOVE). Une trame qui
+// échoue ferait passer, une fois retraduite, une ligne forgée à un client
+// en texte.
+int proto_payload_is_line(int op, const char* payload, size_t len);
+
+// Ligne de texte équivalente à une trame ("MOT contenu"), tronquée à
+// cap - 1 caractères ; retourne sa longueur
+size_t proto_decode_line(int op, const char* payload, size_t len, char* out, size_t cap);
+
+// Vrai si proto_next_frame a une trame (ou une erreur) à rendre
+int proto_has_frame(const LineBuffer* lb);
+
+// Extrait la prochaine trame : opcode dans *op, contenu dans out (terminé
+// par '\0', longueur dans *len). Retourne 1 si une trame a été extraite,
+// 0 si elle est incomplète, -1 si son contenu dépasse cap - 1 octets.
+int proto_next_frame(LineBuffer* lb, int* op, char* out, size_t cap, size_t* len);
+
+#endif // PROTO_H
@@ -0,0 +1,65 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+//---------- Interface of the <TimerWheel> (file timer.h) ----------------
+// Roue de timers hiérarchique : 4 niveaux de 64 cases, le niveau 0 compte
+// en ticks, chaque niveau suivant en 64 fois plus long. Un timer est rangé
+// dans la case de son échéance (liste doublement chaînée) : l'armer ou
+// l'annuler coûte O(1) quel que soit le nombre de timers. Quand le niveau 0
+// fait un tour, la case suivante du niveau 1 est redistribuée, et ainsi de
+// suite. Les timers sont intégrés aux structures qu'ils surveillent, pas
+// alloués ; kind et idx disent à l'appelant à quoi correspond un timer échu.
+
+#ifndef TIMER_H
+#define TIMER_H
+#include <stdint.h>
+
+#define TIMER_LEVELS 4
+#define TIMER_SLOT_BITS 6
+#define TIMER_SLOTS (1 << TIMER_SLOT_BITS)
+
+typedef struct Timer {
+    struct Timer* next;
+    struct Timer** pprev;  // Lien qui pointe sur ce timer, NULL s'il n'est pas armé
+    uint64_t expires;      // Échéance, en ticks
+    int kind;              // Choisis par l'appelant
+    int idx;
+} Timer;
+
+typedef struct {
+    Timer* slots[TIMER_LEVELS][TIMER_SLOTS];
+    Timer* due;            // Timers échus, pas encore rendus par timer_next_expired
+    uint64_t tick;         // Prochain tick à traiter
+    uint64_t origin_ms;    // Heure du tick 0
+    unsigned tick_ms;
+    int armed;             // Timers armés, échus compris
+} TimerWheel;
+
+// Horloge des timers : millisecondes, monotone
+uint64_t timer_now_ms(void);
+
+void timer_wheel_init(TimerWheel* w, unsigned tick_ms, uint64_t now_ms);
+void timer_init(Timer* t, int kind, int idx);
+
+// Échéance dans delay_ms (arrondie au tick supérieur) ; un timer déjà armé
+// est déplacé. Au-delà de l'horizon de la roue, l'échéance est ramenée à
+// l'horizon.
+void timer_arm(TimerWheel* w, Timer* t, uint64_t delay_ms, uint64_t now_ms);
+void timer_cancel(TimerWheel* w, Timer* t);
+int timer_armed(const Timer* t);
+
+// Rend un timer échu à now_ms (désarmé) et NULL quand il n'y en a plus ;
+// à appeler en boucle
+Timer* timer_next_expired(TimerWheel* w, uint64_t now_ms);
+
+// Délai en ms avant le prochain tick qui a un timer à rendre ou une case à
+// redistribuer, -1 si aucun timer n'est armé (attente sans limite)
+int timer_timeout_ms(const TimerWheel* w, uint64_t now_ms);
+
+#endif // TIMER_H
@@ -0,0 +1,72 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+//---------- Interface of the <TT> (file tt.h) ----------------
+// Table de transposition de taille fixe, partagée sans verrou entre plusieurs
+// recherches : chaque entrée stocke clé ^ données, une entrée à moitié écrite
+// par un autre thread est donc simplement vue comme absente.
+
+#ifndef TT_H
+#define TT_H
+#include <stddef.h>
+#include <stdint.h>
+
+#define TT_BUCKET_SIZE 4  // Entrées par bucket (64 octets, une ligne de cache)
+
+typedef enum {
+    TT_NONE = 0,
+    TT_EXACT,   // Score exact
+    TT_LOWER,   // Score >= valeur (coupure bêta)
+    TT_UPPER    // Score <= valeur (aucun coup n'a dépassé alpha)
+} TTBound;
+
+typedef struct {
+    uint64_t check;  // Clé de Zobrist ^ data
+    uint64_t data;   // Score, profondeur, borne, coup, génération (0 = vide)
+} TTEntry;
+
+typedef struct {
+    unsigned long long probes;        // Consultations
+    unsigned long long hits;          // Position trouvée
+    unsigned long long collisions;    // Consultations ayant croisé une entrée occupée d'une autre clé
+    unsigned long long stores;        // Écritures
+    unsigned long long replacements;  // Écritures qui ont évincé une autre position
+} TTStats;
+
+typedef struct {
+    TTEntry* entries;
+    uint64_t mask;        // Nombre de buckets - 1 (puissance de 2)
+    uint8_t generation;   // Incrémentée à chaque recherche (les vieilles entrées partent en premier)
+    TTStats stats;        // Cumul de toutes les recherches (tt_add_stats)
+} TranspositionTable;
+
+typedef struct {
+    int score;
+    int depth;
+    TTBound bound;
+    int pit;              // Meilleur coup (case 0-11), -1 si inconnu
+} TTHit;
+
+// Alloue une table d'au plus megabytes Mo (arrondi à une puissance de 2) ; 0 si succès
+int tt_init(TranspositionTable* tt, size_t megabytes);
+void tt_free(TranspositionTable* tt);
+void tt_clear(TranspositionTable* tt);
+void tt_new_search(TranspositionTable* tt);
+size_t tt_size_bytes(const TranspositionTable* tt);
+
+int tt_probe(const TranspositionTable* tt, uint64_t key, TTHit* hit, TTStats* stats);
+void tt_store(TranspositionTable* tt, uint64_t key, int depth, int score, TTBound bound, int pit,
+              TTStats* stats);
+
+// Statistiques : chaque recherche compte localement puis ajoute son total
+void tt_add_stats(TranspositionTable* tt, const TTStats* stats);
+void tt_get_stats(const TranspositionTable* tt, TTStats* stats);
+int tt_fill_permille(const TranspositionTable* tt);  // Taux de remplissage (échantillon)
+
+#endif // TT_H
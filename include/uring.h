@@ -0,0 +1,77 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+//---------- Interface of the <Uring> (file uring.h) ----------------
+// Anneau io_uring minimal, par appels système directs (sans liburing) :
+// accept et recv multishot, send, poll multishot sur les pipes. Les recv
+// puisent dans un anneau de tampons fournis au noyau (buffer ring) ; un
+// tampon rendu par une complétion doit lui être recyclé après lecture.
+// Un anneau n'est utilisé que par un seul thread.
+
+#ifndef URING_H
+#define URING_H
+#include <linux/io_uring.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    int fd;
+    // File de soumission
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned sq_mask;
+    unsigned* sq_array;
+    struct io_uring_sqe* sqes;
+    unsigned sq_entries;
+    unsigned to_submit;        // SQE préparées, pas encore soumises
+    // File de complétion
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned cq_mask;
+    struct io_uring_cqe* cqes;
+    // Zones projetées (les deux anneaux partagent la même)
+    void* sq_ring;
+    size_t sq_ring_size;
+    void* cq_ring;
+    size_t sqes_size;
+    // Tampons de réception fournis au noyau (groupe URING_BUFFER_GROUP)
+    struct io_uring_buf_ring* buf_ring;
+    size_t buf_ring_size;
+    char* buffers;
+    unsigned buf_count;
+    unsigned buf_size;
+} Uring;
+
+// Crée l'anneau et ses tampons de réception ; -1 (errno) si le noyau ne
+// sait pas faire (io_uring absent ou interdit, buffer ring, recv multishot)
+int uring_init(Uring* u, unsigned entries, unsigned buf_count, unsigned buf_size);
+void uring_close(Uring* u);
+
+// Opérations : user_data est rendu tel quel dans la complétion
+void uring_accept_multishot(Uring* u, int fd, uint64_t user_data);
+void uring_recv_multishot(Uring* u, int fd, uint64_t user_data);
+void uring_send(Uring* u, int fd, const void* buf, size_t len, uint64_t user_data);
+void uring_poll_multishot(Uring* u, int fd, uint64_t user_data);
+// Annule l'opération en cours dont la user_data vaut target (un multishot
+// se termine par une complétion sans IORING_CQE_F_MORE)
+void uring_cancel(Uring* u, uint64_t target, uint64_t user_data);
+
+// Soumet les opérations préparées et attend au moins une complétion, au plus
+// timeout_ms (-1 : sans limite) ; -1 (errno) en cas d'erreur
+int uring_submit_and_wait(Uring* u, int timeout_ms);
+
+// Prochaine complétion, NULL s'il n'y en a plus ; uring_cqe_seen la libère
+struct io_uring_cqe* uring_peek_cqe(Uring* u);
+void uring_cqe_seen(Uring* u);
+
+// Tampon de réception désigné par une complétion (IORING_CQE_F_BUFFER)
+const char* uring_buffer(const Uring* u, const struct io_uring_cqe* cqe);
+void uring_recycle_buffer(Uring* u, const struct io_uring_cqe* cqe);
+
+#endif // URING_H
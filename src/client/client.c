@@ -18,6 +18,10 @@
 #include <termios.h>
 #include <fcntl.h>
 
+#include "../../include/game.h"
+#include "../../include/linebuf.h"
+#include "../../include/proto.h"
+
 // Codes de couleur ANSI (versions sombres)
 #define COLOR_RESET   "\033[0m"
 #define COLOR_RED     "\033[31m"
@@ -29,6 +33,18 @@
 #define COLOR_BROWN   "\033[38;5;94m"
 #define COLOR_BOLD    "\033[1m"
 
+// Octets reçus du serveur, pas encore découpés en lignes (ou en trames)
+static LineBuffer server_input;
+
+// 1 : lignes de texte ; 2 : trames binaires, si le serveur les propose
+static int proto_version = 1;
+
+// Positions en STATE_DELTA (v2 + DELTA) : dernière position reconstruite et
+// son numéro, -1 tant qu'aucune position complète n'est arrivée
+static AwaleState delta_view;
+static int delta_seq = -1;
+static int resync_pending = 0;
+
 // Buffer global pour la saisie utilisateur
 static char input_buffer[256] = "";
 static int input_pos = 0;
@@ -78,6 +94,8 @@ static void print_help(void) {
     printf("║" COLOR_RESET " " COLOR_YELLOW "En partie:" COLOR_RESET "                                " COLOR_MAGENTA "║\n");
     printf("║" COLOR_RESET " " COLOR_BLUE "/0 à /11" COLOR_RESET "             - Jouer une case     " COLOR_MAGENTA "║\n");
     printf("║" COLOR_RESET " " COLOR_BLUE "/d" COLOR_RESET "                   - Proposer égalité   " COLOR_MAGENTA "║\n");
+    printf("║" COLOR_RESET " " COLOR_BLUE "/hint" COLOR_RESET "                - Conseil de coup    " COLOR_MAGENTA "║\n");
+    printf("║" COLOR_RESET " " COLOR_BLUE "/analyze" COLOR_RESET "             - Analyser position  " COLOR_MAGENTA "║\n");
     printf("║" COLOR_RESET " " COLOR_BLUE "/q" COLOR_RESET "                   - Abandonner         " COLOR_MAGENTA "║\n");
     printf(COLOR_MAGENTA "╠═══════════════════════════════════════════╣\n");
     printf("║" COLOR_RESET " " COLOR_BLUE "@<nom> <msg>" COLOR_RESET "         - Message privé      " COLOR_MAGENTA "║\n");
@@ -109,29 +127,105 @@ static int connect_to(const char* ip, int port) {
     return fd;
 }
 
+/**
+ * Reçoit une ligne du serveur en bloquant ; un recv peut en apporter
+ * plusieurs, les suivantes restent dans server_input
+ */
 static int recv_line(int fd, char *buf, size_t cap) {
-    size_t n = 0;
-    char ch;
-    
-    while (n + 1 < cap) {
-        ssize_t r = recv(fd, &ch, 1, 0);
-        if (r <= 0) {
+    while (!linebuf_next_line(&server_input, buf, cap)) {
+        if (linebuf_fill(&server_input, fd, 0) <= 0) {
             return -1;
         }
-        
-        if (ch == '\n') {
-            buf[n] = 0;
-            return n;
+    }
+    return strlen(buf);
+}
+
+/**
+ * Envoie une commande (ligne terminée par '\n'), traduite en trame en v2
+ */
+static void send_command(int fd, const char* line) {
+    if (proto_version == 2) {
+        char frame[PROTO_HEADER_LEN + 512];
+        send(fd, frame, proto_encode_line(line, strlen(line), frame, sizeof(frame)), 0);
+    } else {
+        send(fd, line, strlen(line), 0);
+    }
+}
+
+static int has_message(void) {
+    return proto_version == 2 ? proto_has_frame(&server_input) : linebuf_has_line(&server_input);
+}
+
+/**
+ * Prochain message du serveur, sous forme de ligne dans buf. En v2, une
+ * trame STATE (ou STATE_DELTA) est décodée directement dans *state : buf est
+ * alors vide et le retour vaut 2. Retourne 0 si aucun message complet, -1 si
+ * trame invalide. Un delta qui ne suit pas la position connue est ignoré et
+ * une position complète est demandée (RESYNC).
+ */
+static int next_message(int fd, char* buf, size_t cap, AwaleState* state) {
+    if (proto_version != 2) {
+        return linebuf_next_line(&server_input, buf, cap);
+    }
+    static char payload[PROTO_MAX_PAYLOAD + 1];
+    int op;
+    size_t len;
+    int r = proto_next_frame(&server_input, &op, payload, sizeof(payload), &len);
+    if (r <= 0) {
+        return r;
+    }
+    if (op == PROTO_STATE && len == PROTO_STATE_LEN) {
+        proto_decode_state(payload, state);
+        buf[0] = '\0';
+        return 2;
+    }
+    if (op == PROTO_STATE_DELTA) {
+        int applied = proto_apply_delta(payload, len, &delta_view, &delta_seq);
+        if (applied < 0) {
+            return -1;
         }
-        
-        buf[n++] = ch;
+        if (applied == 0) {
+            if (!resync_pending) {
+                send_command(fd, "RESYNC\n");
+                resync_pending = 1;
+            }
+            return next_message(fd, buf, cap, state);
+        }
+        resync_pending = 0;
+        *state = delta_view;
+        buf[0] = '\0';
+        return 2;
     }
-    
-    buf[n] = 0;
-    return n;
+    proto_decode_line(op, payload, len, buf, cap);
+    return 1;
+}
+
+/**
+ * Ligne STATE du protocole texte : 12 cases, 2 scores, joueur au trait
+ */
+static int parse_state_line(const char* s, AwaleState* state) {
+    int b[12], s0, s1, cur;
+    if (sscanf(s, "%d %d %d %d %d %d %d %d %d %d %d %d %d %d %d",
+        &b[0], &b[1], &b[2], &b[3], &b[4], &b[5],
+        &b[6], &b[7], &b[8], &b[9], &b[10], &b[11],
+        &s0, &s1, &cur) != 15) {
+        return 0;
+    }
+    for (int k = 0; k < 12; k++) {
+        state->board[k] = (char)b[k];
+    }
+    state->scores[0] = (char)s0;
+    state->scores[1] = (char)s1;
+    state->current_player = (char)cur;
+    state->key = awale_hash(state);
+    return 1;
 }
 
-static void render_state(const int b[12], int s0, int s1, int cur) {
+static void render_state(const AwaleState* st) {
+    const char* b = st->board;
+    int s0 = st->scores[0];
+    int s1 = st->scores[1];
+    int cur = st->current_player;
     printf("\n" COLOR_BLUE "    P2 (%d pts)" COLOR_RESET "\n", s1);
     printf(COLOR_MAGENTA "-------------------------" COLOR_RESET "\n");
     
@@ -170,12 +264,15 @@ int main(int argc, char **argv) {
     }
     
     int fd = connect_to(argv[1], atoi(argv[2]));
-    char buf[256];
+    linebuf_init(&server_input);
+    char buf[LINEBUF_SIZE];
     int myrole = -1;
     int myturn = 0;
     int in_game = 0;
     int editing_bio = 0;  // Flag pour savoir si on est en mode édition de bio
     char username[50];
+    AwaleState view;  // Dernier état reçu du serveur (pour valider les coups localement)
+    awale_init(&view);
     
     // Demander le username à l'utilisateur
     printf(COLOR_BLUE "👤 Entrez votre nom d'utilisateur: " COLOR_RESET);
@@ -203,27 +300,49 @@ int main(int argc, char **argv) {
         
         int maxfd = fd > STDIN_FILENO ? fd : STDIN_FILENO;
         
-        if (select(maxfd + 1, &rfds, NULL, NULL, NULL) <= 0) {
+        // Des lignes déjà reçues attendent : on regarde seulement le clavier
+        int pending = has_message();
+        struct timeval no_wait = {0, 0};
+        if (select(maxfd + 1, &rfds, NULL, NULL, pending ? &no_wait : NULL) < 0) {
             continue;
         }
         
+        // Un recv remplit le tampon, une ligne est traitée par tour de boucle
+        if (FD_ISSET(fd, &rfds) && !pending && linebuf_fill(&server_input, fd, 0) <= 0) {
+            printf(COLOR_RED "✗ Déconnecté du serveur.\n" COLOR_RESET);
+            break;
+        }
+        
         // Message du serveur
-        if (FD_ISSET(fd, &rfds)) {
+        AwaleState received;
+        int got = next_message(fd, buf, sizeof(buf), &received);
+        if (got < 0) {
+            printf(COLOR_RED "✗ Message invalide du serveur.\n" COLOR_RESET);
+            break;
+        }
+        if (got > 0 && !strcmp(buf, "PING")) {
+            send_command(fd, "PONG\n");  // Battement de cœur, sans affichage
+            continue;
+        }
+        if (got > 0) {
             // Effacer la ligne courante si on est en train de taper
             if (input_pos > 0) {
                 clear_current_line();
             }
             
-            if (recv_line(fd, buf, sizeof(buf)) < 0) {
-                printf(COLOR_RED "✗ Déconnecté du serveur.\n" COLOR_RESET);
-                break;
-            }
-            
             // Gérer la demande d'enregistrement
             if (!strncmp(buf, "REGISTER", 8)) {
+                // Protocole v2 proposé : on l'annonce, les trames commencent
+                // juste après cette ligne ; les deltas avec, si proposés
+                int v2 = strstr(buf + 8, " " PROTO_V2_TOKEN) != NULL;
+                int delta = v2 && strstr(buf + 8, " " PROTO_DELTA_TOKEN) != NULL;
                 char msg[128];
-                snprintf(msg, sizeof(msg), "USERNAME %s\n", username);
-                send(fd, msg, strlen(msg), 0);
+                snprintf(msg, sizeof(msg), "USERNAME %s%s%s\n", username, v2 ? " " PROTO_V2_TOKEN : "",
+                         delta ? " " PROTO_DELTA_TOKEN : "");
+                send_command(fd, msg);
+                if (v2) {
+                    proto_version = 2;
+                }
             }
             // Liste des utilisateurs
             else if (!strncmp(buf, "USERLIST", 8)) {
@@ -290,16 +409,11 @@ int main(int argc, char **argv) {
                 in_game = 1;
                 printf(COLOR_BLUE "✓ Vous êtes P%d\n" COLOR_RESET, myrole + 1);
             }
-            else if (!strncmp(buf, "STATE ", 6)) {
-                int b[12], s0, s1, cur;
-                
-                if (sscanf(buf + 6, "%d %d %d %d %d %d %d %d %d %d %d %d %d %d %d",
-                    &b[0], &b[1], &b[2], &b[3], &b[4], &b[5],
-                    &b[6], &b[7], &b[8], &b[9], &b[10], &b[11],
-                    &s0, &s1, &cur) == 15) {
-                    
-                    render_state(b, s0, s1, cur);
-                    myturn = (myrole == cur);
+            else if (got == 2 || !strncmp(buf, "STATE ", 6)) {
+                if (got == 2 || parse_state_line(buf + 6, &received)) {
+                    view = received;
+                    render_state(&view);
+                    myturn = (myrole == view.current_player);
                     
                     if (myturn) {
                         printf(COLOR_GREEN "➤ À vous de jouer" COLOR_RESET " (/0-11, /d, /q): ");
@@ -314,9 +428,9 @@ int main(int argc, char **argv) {
                 char response[16];
                 if (fgets(response, sizeof(response), stdin)) {
                     if (response[0] == 'o' || response[0] == 'O') {
-                        send(fd, "YES\n", 4, 0);
+                        send_command(fd, "YES\n");
                     } else {
-                        send(fd, "NO\n", 3, 0);
+                        send_command(fd, "NO\n");
                     }
                 }
             }
@@ -327,9 +441,9 @@ int main(int argc, char **argv) {
                 char response[16];
                 if (fgets(response, sizeof(response), stdin)) {
                     if (response[0] == 'o' || response[0] == 'O') {
-                        send(fd, "YES\n", 4, 0);
+                        send_command(fd, "YES\n");
                     } else {
-                        send(fd, "NO\n", 3, 0);
+                        send_command(fd, "NO\n");
                     }
                 }
             }
@@ -382,6 +496,41 @@ int main(int argc, char **argv) {
                     }
                 }
             }
+            // Conseil : HINT <case> livre <parties> <victoires> <nulles>
+            //        ou HINT <case> recherche <profondeur> <score>
+            else if (!strncmp(buf, "HINT ", 5)) {
+                int pit, a, b, c = 0;
+                char source[16];
+                int n = sscanf(buf + 5, "%d %15s %d %d %d", &pit, source, &a, &b, &c);
+                if (n >= 4 && pit >= 0 && !strcmp(source, "livre")) {
+                    printf(COLOR_BLUE "💡 Conseil : /%d (livre : %d parties, %d%% gagnées, %d%% nulles)\n" COLOR_RESET,
+                           pit, a, a ? 100 * b / a : 0, a ? 100 * c / a : 0);
+                } else if (n >= 4 && pit >= 0) {
+                    printf(COLOR_BLUE "💡 Conseil : /%d (recherche à profondeur %d, évaluation %+d)\n" COLOR_RESET,
+                           pit, a, b);
+                } else {
+                    printf(COLOR_RED "✗ Aucun conseil disponible.\n" COLOR_RESET);
+                }
+                if (myturn) {
+                    printf(COLOR_GREEN "➤ À vous de jouer" COLOR_RESET " (/0-11, /d, /q): ");
+                    fflush(stdout);
+                }
+            }
+            // Analyse : ANALYSIS <case> <score> <profondeur> <noeuds> <ms>
+            else if (!strncmp(buf, "ANALYSIS ", 9)) {
+                int pit, score, depth, ms;
+                unsigned long long nodes;
+                if (sscanf(buf + 9, "%d %d %d %llu %d", &pit, &score, &depth, &nodes, &ms) == 5 && pit >= 0) {
+                    printf(COLOR_BLUE "🔍 Analyse : meilleur coup /%d, évaluation %+d pour le joueur au trait"
+                           " (profondeur %d, %llu noeuds, %d ms)\n" COLOR_RESET, pit, score, depth, nodes, ms);
+                } else {
+                    printf(COLOR_RED "✗ Aucune analyse disponible.\n" COLOR_RESET);
+                }
+                if (myturn) {
+                    printf(COLOR_GREEN "➤ À vous de jouer" COLOR_RESET " (/0-11, /d, /q): ");
+                    fflush(stdout);
+                }
+            }
             // Affichage d'une partie rejouée
             else if (!strncmp(buf, "REPLAY", 6)) {
                 // Afficher tout le contenu de la partie (tout est déjà dans buf après "REPLAY\n")
@@ -406,8 +555,9 @@ int main(int argc, char **argv) {
                 // Afficher la bio complète (multi-lignes)
                 printf("%s\n", buf + 4);  // Sauter "BIO\n"
                 
-                // Lire les lignes suivantes jusqu'à trouver "=========="
-                while (1) {
+                // En texte, lire les lignes suivantes jusqu'à trouver
+                // "==========" ; en v2, la trame contient toute la bio
+                while (proto_version == 1) {
                     if (recv_line(fd, buf, sizeof(buf)) < 0) {
                         break;
                     }
@@ -457,7 +607,7 @@ int main(int argc, char **argv) {
                 if (strlen(buf) == 0) {
                     // En mode édition de bio, envoyer la ligne vide pour terminer
                     if (editing_bio) {
-                        send(fd, "\n", 1, 0);
+                        send_command(fd, "\n");
                     }
                     // Sinon, ignorer et réafficher le prompt
                     else if (!in_game) {
@@ -503,68 +653,80 @@ int main(int argc, char **argv) {
                         show_prompt();
                     }
                 } else if (!strcmp(cmd, "q")) {
-                    send(fd, "QUIT\n", 5, 0);
+                    send_command(fd, "QUIT\n");
                     if (in_game && myturn) myturn = 0;
                 } else if (!strcmp(cmd, "d")) {
-                    send(fd, "DRAW\n", 5, 0);
+                    send_command(fd, "DRAW\n");
                     if (in_game && myturn) myturn = 0;
+                } else if (!strcmp(cmd, "analyze")) {
+                    if (in_game) {
+                        send_command(fd, "ANALYZE\n");
+                    } else {
+                        printf(COLOR_RED "✗ Vous n'êtes pas en partie.\n" COLOR_RESET);
+                    }
+                } else if (!strcmp(cmd, "hint")) {
+                    if (in_game && myturn) {
+                        send_command(fd, "HINT\n");
+                    } else {
+                        printf(COLOR_RED "✗ Conseil disponible seulement à votre tour.\n" COLOR_RESET);
+                    }
                 } else if (!strcmp(cmd, "list")) {
-                    send(fd, "LIST\n", 5, 0);
+                    send_command(fd, "LIST\n");
                 } else if (!strcmp(cmd, "games")) {
-                    send(fd, "GAMES\n", 6, 0);
+                    send_command(fd, "GAMES\n");
                 } else if (!strcmp(cmd, "stopwatch")) {
-                    send(fd, "STOPWATCH\n", 10, 0);
+                    send_command(fd, "STOPWATCH\n");
                 } else if (!strcmp(cmd, "board")) {
-                    send(fd, "BOARD\n", 6, 0);
+                    send_command(fd, "BOARD\n");
                 } else if (!strncmp(cmd, "watch ", 6)) {
                     char out[128];
                     snprintf(out, sizeof(out), "WATCH %s\n", cmd + 6);
-                    send(fd, out, strlen(out), 0);
+                    send_command(fd, out);
                 } else if (!strncmp(cmd, "challenge ", 10)) {
                     char out[128];
                     snprintf(out, sizeof(out), "CHALLENGE %s\n", cmd + 10);
-                    send(fd, out, strlen(out), 0);
+                    send_command(fd, out);
                 } else if (!strncmp(cmd, "accept ", 7)) {
                     char out[128];
                     snprintf(out, sizeof(out), "ACCEPT %s\n", cmd + 7);
-                    send(fd, out, strlen(out), 0);
+                    send_command(fd, out);
                 } else if (!strncmp(cmd, "refuse ", 7)) {
                     char out[128];
                     snprintf(out, sizeof(out), "REFUSE %s\n", cmd + 7);
-                    send(fd, out, strlen(out), 0);
+                    send_command(fd, out);
                 } else if (!strcmp(cmd, "bio")) {
                     // Envoyer simplement la commande BIO, le serveur gérera l'édition ligne par ligne
-                    send(fd, "BIO\n", 4, 0);
+                    send_command(fd, "BIO\n");
                 } else if (!strncmp(cmd, "whois ", 6)) {
                     char out[128];
                     snprintf(out, sizeof(out), "WHOIS %s\n", cmd + 6);
-                    send(fd, out, strlen(out), 0);
+                    send_command(fd, out);
                 } else if (!strncmp(cmd, "addfriend ", 10)) {
                     char out[128];
                     snprintf(out, sizeof(out), "ADDFRIEND %s\n", cmd + 10);
-                    send(fd, out, strlen(out), 0);
+                    send_command(fd, out);
                 } else if (!strncmp(cmd, "acceptfriend ", 13)) {
                     char out[128];
                     snprintf(out, sizeof(out), "ACCEPTFRIEND %s\n", cmd + 13);
-                    send(fd, out, strlen(out), 0);
+                    send_command(fd, out);
                 } else if (!strcmp(cmd, "friendrequests") || !strcmp(cmd, "listfriendrequests")) {
-                    send(fd, "LISTFRIENDREQUESTS\n", 19, 0);
+                    send_command(fd, "LISTFRIENDREQUESTS\n");
                 } else if (!strncmp(cmd, "removefriend ", 13)) {
                     char out[128];
                     snprintf(out, sizeof(out), "REMOVEFRIEND %s\n", cmd + 13);
-                    send(fd, out, strlen(out), 0);
+                    send_command(fd, out);
                 } else if (!strcmp(cmd, "friends") || !strcmp(cmd, "listfriends")) {
-                    send(fd, "LISTFRIENDS\n", 12, 0);
+                    send_command(fd, "LISTFRIENDS\n");
                 } else if (!strcmp(cmd, "private")) {
-                    send(fd, "PRIVATE\n", 8, 0);
+                    send_command(fd, "PRIVATE\n");
                 } else if (!strcmp(cmd, "save")) {
-                    send(fd, "SAVE\n", 5, 0);
+                    send_command(fd, "SAVE\n");
                 } else if (!strcmp(cmd, "history")) {
-                    send(fd, "HISTORY\n", 8, 0);
+                    send_command(fd, "HISTORY\n");
                 } else if (!strncmp(cmd, "replay ", 7)) {
                     char out[128];
                     snprintf(out, sizeof(out), "REPLAY %s\n", cmd + 7);
-                    send(fd, out, strlen(out), 0);
+                    send_command(fd, out);
                 } else {
                     // Vérifier si c'est un chiffre pour jouer (0-11)
                     char* endptr;
@@ -572,10 +734,24 @@ int main(int argc, char **argv) {
                     
                     if (*endptr == '\0' && pit >= 0 && pit <= 11) {
                         // C'est un numéro de pit valide
-                        if (in_game && myturn) {
+                        if (in_game && myturn && !awale_is_valid_move(&view, (int)pit)) {
+                            // Même règle que le serveur (camp, case vide, obligation de nourrir)
+                            printf(COLOR_RED "✗ Coup invalide" COLOR_RESET);
+                            if (awale_legal_moves(&view) != 0) {
+                                printf(" (coups possibles:");
+                                for (int k = 0; k < PITS_PER_SIDE; k++) {
+                                    if (awale_legal_moves(&view) & (1 << k)) {
+                                        printf(" /%d", myrole * PITS_PER_SIDE + k);
+                                    }
+                                }
+                                printf(")");
+                            }
+                            printf("\n" COLOR_GREEN "➤ À vous de jouer" COLOR_RESET " (/0-11, /d, /q): ");
+                            fflush(stdout);
+                        } else if (in_game && myturn) {
                             char out[300];
                             snprintf(out, sizeof(out), "MOVE %ld\n", pit);
-                            send(fd, out, strlen(out), 0);
+                            send_command(fd, out);
                             myturn = 0;
                         } else if (in_game && !myturn) {
                             printf(COLOR_RED "✗ Ce n'est pas votre tour.\n" COLOR_RESET);
@@ -595,7 +771,7 @@ int main(int argc, char **argv) {
                     // En mode édition de bio, envoyer le texte brut
                     char out[300];
                     snprintf(out, sizeof(out), "%s\n", buf);
-                    send(fd, out, strlen(out), 0);
+                    send_command(fd, out);
                 }
                 // Sinon, vérifier si c'est un message privé avec @username
                 else if (buf[0] == '@') {
@@ -605,7 +781,7 @@ int main(int argc, char **argv) {
                         *space = '\0';
                         char out[512];
                         snprintf(out, sizeof(out), "CHAT @%s %s\n", buf + 1, space + 1);
-                        send(fd, out, strlen(out), 0);
+                        send_command(fd, out);
                     } else {
                         printf(COLOR_RED "✗ Usage: @<username> <message>\n" COLOR_RESET);
                         if (!in_game) {
@@ -616,7 +792,7 @@ int main(int argc, char **argv) {
                     // Message de chat normal
                     char out[512];
                     snprintf(out, sizeof(out), "CHAT %s\n", buf);
-                    send(fd, out, strlen(out), 0);
+                    send_command(fd, out);
                 }
                 
                 // Réafficher le prompt après un message de chat
@@ -0,0 +1,214 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+#include "../../include/archive.h"
+
+#include <dirent.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define LINE_LEN 256
+
+static int fail(ArchiveGame* game, int line, const char* error) {
+    game->line = line;
+    game->error = error;
+    return -1;
+}
+
+/**
+ * Copie le texte après le préfixe, sans le saut de ligne final
+ */
+static int read_field(const char* line, const char* prefix, char* out, size_t len) {
+    size_t n = strlen(prefix);
+    if (strncmp(line, prefix, n) != 0) {
+        return 0;
+    }
+    snprintf(out, len, "%s", line + n);
+    out[strcspn(out, "\r\n")] = '\0';
+    return 1;
+}
+
+static int parse_number(const char** p, int* out) {
+    const char* c = *p;
+    int value = 0;
+    if (*c < '0' || *c > '9') {
+        return 0;
+    }
+    while (*c >= '0' && *c <= '9') {
+        value = value * 10 + (*c++ - '0');
+    }
+    *out = value;
+    *p = c;
+    return 1;
+}
+
+static int skip(const char** p, const char* text) {
+    size_t n = strlen(text);
+    if (strncmp(*p, text, n) != 0) {
+        return 0;
+    }
+    *p += n;
+    return 1;
+}
+
+/**
+ * Lit "Coup <n>: <nom> joue pit <p> (capture <c> graines)" ; c'est la
+ * grande majorité des lignes, d'où un analyseur à la main plutôt que sscanf
+ */
+static int parse_move(const char* line, int* number, char name[ARCHIVE_NAME_LEN], int* pit,
+                      int* captured) {
+    const char* p = line;
+    if (!skip(&p, "Coup ") || !parse_number(&p, number) || !skip(&p, ": ")) {
+        return 0;
+    }
+    size_t len = strcspn(p, " ");
+    if (len == 0 || len >= ARCHIVE_NAME_LEN) {
+        return 0;
+    }
+    memcpy(name, p, len);
+    name[len] = '\0';
+    p += len;
+    return skip(&p, " joue pit ") && parse_number(&p, pit) && skip(&p, " (capture ") &&
+           parse_number(&p, captured) && skip(&p, " graines)");
+}
+
+static int parse_result(ArchiveGame* game, const char* result) {
+    if (!strcmp(result, "Égalité")) {
+        return ARCHIVE_DRAW;
+    }
+    for (int p = 0; p < 2; p++) {
+        size_t n = strlen(game->players[p]);
+        if (!strncmp(result, game->players[p], n) && !strncmp(result + n, " gagne", 6)) {
+            return p;
+        }
+    }
+    return ARCHIVE_UNFINISHED;  // Partie interrompue
+}
+
+int archive_read_game(FILE* f, ArchiveGame* game) {
+    memset(game, 0, sizeof(*game));
+    game->winner = ARCHIVE_UNFINISHED;
+    awale_init(&game->final_state);
+
+    char line[LINE_LEN];
+    char result[LINE_LEN] = "";
+    int have_players = 0;
+    int declared_moves = -1;
+    int lineno = 0;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        lineno++;
+        int number;
+        int pit;
+        int captured;
+        char name[ARCHIVE_NAME_LEN];
+
+        if (read_field(line, "Joueur 1 (P1): ", game->players[0], ARCHIVE_NAME_LEN)) {
+            have_players |= 1;
+        } else if (read_field(line, "Joueur 2 (P2): ", game->players[1], ARCHIVE_NAME_LEN)) {
+            have_players |= 2;
+        } else if (read_field(line, "Résultat: ", result, sizeof(result))) {
+            continue;
+        } else if (!strncmp(line, "Score final: ", 13)) {
+            const char* a = strchr(line, '=');
+            const char* b = a != NULL ? strchr(a + 1, '=') : NULL;
+            if (b == NULL) {
+                return fail(game, lineno, "score final illisible");
+            }
+            game->final_scores[0] = atoi(a + 1);
+            game->final_scores[1] = atoi(b + 1);
+        } else if (sscanf(line, "=== HISTORIQUE DES COUPS (%d coups) ===", &declared_moves) == 1) {
+            continue;
+        } else if (parse_move(line, &number, name, &pit, &captured)) {
+            AwaleState* s = &game->final_state;
+            if (have_players != 3) {
+                return fail(game, lineno, "coup avant les noms des joueurs");
+            }
+            if (number != game->num_moves + 1 || game->num_moves == ARCHIVE_MAX_MOVES) {
+                return fail(game, lineno, "numéro de coup inattendu");
+            }
+            if (awale_is_over(s)) {
+                return fail(game, lineno, "coup après la fin de la partie");
+            }
+            if (strcmp(name, game->players[(int)s->current_player]) != 0) {
+                return fail(game, lineno, "ce n'est pas au tour de ce joueur");
+            }
+            int gained = awale_play(s, pit);
+            if (gained < 0) {
+                return fail(game, lineno, "coup illégal");
+            }
+            if (gained != captured) {
+                return fail(game, lineno, "capture différente de celle enregistrée");
+            }
+            game->pits[game->num_moves++] = pit;
+        }
+    }
+
+    if (have_players != 3) {
+        return fail(game, lineno, "noms des joueurs absents");
+    }
+    if (declared_moves != game->num_moves) {
+        return fail(game, lineno, "nombre de coups différent de l'en-tête");
+    }
+    game->winner = parse_result(game, result);
+    return 0;
+}
+
+const char* archive_check_result(const ArchiveGame* game) {
+    AwaleState s = game->final_state;
+    const int* recorded = game->final_scores;
+    if (awale_is_over(&s)) {
+        awale_collect_remaining(&s);
+    } else if (recorded[0] == s.scores[0] && recorded[1] == s.scores[1]) {
+        return NULL;  // Arrêt avant la fin : abandon, forfait ou égalité acceptée (DRAW)
+    } else if (recorded[0] < s.scores[0] || recorded[1] < s.scores[1] ||
+               recorded[0] + recorded[1] != TOTAL_SEEDS) {
+        return "score final différent de la simulation";
+    } else {
+        s.scores[0] = recorded[0];  // Partie arbitrée
+        s.scores[1] = recorded[1];
+    }
+
+    if (recorded[0] != s.scores[0] || recorded[1] != s.scores[1]) {
+        return "score final différent de la simulation";
+    }
+    int winner = s.scores[0] == s.scores[1] ? ARCHIVE_DRAW : s.scores[0] < s.scores[1];
+    if (game->winner != winner) {
+        return "résultat différent de la simulation";
+    }
+    return NULL;
+}
+
+int archive_scan(const char* dir, ArchiveVisitor visit, void* ctx) {
+    DIR* d = opendir(dir);
+    if (d == NULL) {
+        return -1;
+    }
+
+    ArchiveGame game;
+    int files = 0;
+    struct dirent* entry;
+    while ((entry = readdir(d)) != NULL) {
+        size_t len = strlen(entry->d_name);
+        if (len < 4 || strcmp(entry->d_name + len - 4, ".txt") != 0) {
+            continue;
+        }
+        char path[1024];
+        snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+        FILE* f = fopen(path, "r");
+        if (f == NULL) {
+            continue;
+        }
+        int ok = archive_read_game(f, &game) == 0;
+        fclose(f);
+        visit(path, &game, ok, ctx);
+        files++;
+    }
+    closedir(d);
+    return files;
+}
@@ -0,0 +1,244 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+#include "../../include/batch.h"
+
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+// Les noyaux vectoriels utilisent les extensions vectorielles de GCC/Clang :
+// un v8 contient une case pour 32 voies (AVX2) ou 16 voies (SSE2 et autres),
+// le lot étant alors traité en deux moitiés.
+// Compiler avec -DBATCH_SCALAR pour forcer la version scalaire.
+#if defined(__GNUC__) && !defined(BATCH_SCALAR)
+#define BATCH_VECTOR 1
+#if defined(__AVX2__)
+#define VEC_LANES 32
+#else
+#define VEC_LANES 16
+#endif
+typedef uint8_t v8 __attribute__((vector_size(VEC_LANES)));
+#endif
+
+/**
+ * Copie une position dans une voie du lot
+ */
+void batch_load(AwaleBatch* b, int lane, const AwaleState* s) {
+    for (int j = 0; j < NUM_PITS; j++) {
+        b->pits[j][lane] = (uint8_t)s->board[j];
+    }
+    b->scores[0][lane] = (uint8_t)s->scores[0];
+    b->scores[1][lane] = (uint8_t)s->scores[1];
+    b->player[lane] = (uint8_t)s->current_player;
+}
+
+/**
+ * Extrait la position d'une voie du lot
+ */
+void batch_store(const AwaleBatch* b, int lane, AwaleState* s) {
+    for (int j = 0; j < NUM_PITS; j++) {
+        s->board[j] = (char)b->pits[j][lane];
+    }
+    s->scores[0] = (char)b->scores[0][lane];
+    s->scores[1] = (char)b->scores[1][lane];
+    s->current_player = (char)b->player[lane];
+    s->key = awale_hash(s);
+}
+
+/**
+ * Version de référence : chaque voie est jouée avec le moteur scalaire
+ */
+void batch_play_scalar(AwaleBatch* b, const uint8_t pits[BATCH_LANES], uint8_t captured[BATCH_LANES]) {
+    for (int lane = 0; lane < BATCH_LANES; lane++) {
+        captured[lane] = 0;
+        if (pits[lane] >= NUM_PITS || b->pits[pits[lane]][lane] == 0) {
+            continue;
+        }
+        AwaleState s;
+        batch_store(b, lane, &s);
+        int gained = awale_play(&s, pits[lane]);
+        if (gained >= 0) {
+            captured[lane] = (uint8_t)gained;
+            batch_load(b, lane, &s);
+        }
+    }
+}
+
+#ifdef BATCH_VECTOR
+
+static inline v8 vload(const uint8_t* p) {
+    v8 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void vstore(uint8_t* p, v8 v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+/**
+ * Convertit un masque de comparaison (0x00/0xFF par voie) en un bit par voie
+ */
+static inline uint32_t lane_bits(v8 m) {
+#if defined(__AVX2__)
+    __m256i x;
+    memcpy(&x, &m, sizeof(x));
+    return (uint32_t)_mm256_movemask_epi8(x);
+#elif defined(__SSE2__)
+    __m128i x;
+    memcpy(&x, &m, sizeof(x));
+    return (uint32_t)_mm_movemask_epi8(x);
+#else
+    uint32_t bits = 0;
+    for (int lane = 0; lane < VEC_LANES; lane++) {
+        bits |= (uint32_t)(m[lane] >> 7) << lane;
+    }
+    return bits;
+#endif
+}
+
+/**
+ * Semis + capture sur VEC_LANES voies à partir de base, sans branchement par voie
+ */
+static inline void play_lanes(AwaleBatch* b, const uint8_t* pits, uint8_t* captured, int base) {
+    v8 v[NUM_PITS];
+    v8 p = vload(pits + base);
+
+    // Nombre de graines de la case jouée dans chaque voie
+    v8 seeds = {0};
+    for (int j = 0; j < NUM_PITS; j++) {
+        v[j] = vload(b->pits[j] + base);
+        seeds |= (v8)(p == (uint8_t)j) & v[j];
+    }
+    v8 active = (v8)(p < NUM_PITS) & (v8)(seeds != 0);
+
+    // Tours complets (11 cases par tour, au plus 48 graines) et reste
+    v8 laps = -(v8)(seeds >= 11) - (v8)(seeds >= 22) - (v8)(seeds >= 33) - (v8)(seeds >= 44);
+    v8 rem = seeds - laps * 11;
+
+    for (int j = 0; j < NUM_PITS; j++) {
+        // Distance (1..11) de la case j après la case jouée, 0 pour la case jouée
+        v8 d = (uint8_t)j - p + ((v8)(p > (uint8_t)j) & 12);
+        v8 other = (v8)(p != (uint8_t)j);
+        v8 inc = laps + ((v8)(d <= rem) & 1);
+        v[j] = (v[j] + (inc & other & active)) & (other | ~active);
+    }
+
+    // Dernière case semée (0xFF pour les voies inactives)
+    v8 last = p + rem + ((v8)(rem == 0) & 11);
+    last -= (v8)(last >= NUM_PITS) & NUM_PITS;
+    last |= ~active;
+
+    // Capture : on descend de la case 11 à 0, la chaîne démarre sur la dernière
+    // case semée et ne survit que dans le camp adverse sur des cases à 2 ou 3
+    v8 player = vload(b->player + base);
+    v8 is_p0 = (v8)(player == 0);
+    v8 chain = {0};
+    v8 cap = {0};
+    v8 left = {0};  // Graines adverses hors de la chaîne capturée
+    v8 before[NUM_PITS];
+    for (int j = NUM_PITS - 1; j >= 0; j--) {
+        v8 opponent_side = j >= PITS_PER_SIDE ? is_p0 : ~is_p0;
+        v8 takeable = (v8)(v[j] == 2) | (v8)(v[j] == 3);
+        chain = opponent_side & takeable & ((v8)(last == (uint8_t)j) | chain);
+        before[j] = v[j];
+        cap += chain & v[j];
+        left += opponent_side & ~chain & v[j];
+        v[j] &= ~chain;
+    }
+
+    // Grand chelem : si la capture viderait le camp adverse, elle est annulée
+    v8 grand_slam = (v8)(left == 0);
+    for (int j = 0; j < NUM_PITS; j++) {
+        v[j] = (before[j] & grand_slam) | (v[j] & ~grand_slam);
+    }
+    cap &= ~grand_slam;
+
+    for (int j = 0; j < NUM_PITS; j++) {
+        vstore(b->pits[j] + base, v[j]);
+    }
+    vstore(b->scores[0] + base, vload(b->scores[0] + base) + (cap & is_p0));
+    vstore(b->scores[1] + base, vload(b->scores[1] + base) + (cap & ~is_p0));
+    vstore(b->player + base, player ^ (active & 1));
+    vstore(captured + base, cap);
+}
+
+void batch_play(AwaleBatch* b, const uint8_t pits[BATCH_LANES], uint8_t captured[BATCH_LANES]) {
+    for (int base = 0; base < BATCH_LANES; base += VEC_LANES) {
+        play_lanes(b, pits, captured, base);
+    }
+}
+
+/**
+ * Coups légaux (même règle que awale_legal_moves, obligation de nourrir comprise)
+ */
+static inline v8 legal_lanes(const AwaleBatch* b, int base) {
+    v8 is_p0 = (v8)(vload(b->player + base) == 0);
+    v8 nonempty = {0};
+    v8 feeding = {0};
+    v8 opponent_seeds = {0};
+    for (int i = 0; i < PITS_PER_SIDE; i++) {
+        v8 low = vload(b->pits[i] + base);
+        v8 high = vload(b->pits[i + PITS_PER_SIDE] + base);
+        v8 own = (low & is_p0) | (high & ~is_p0);
+        opponent_seeds |= (high & is_p0) | (low & ~is_p0);
+        nonempty |= (v8)(own != 0) & (uint8_t)(1 << i);
+        feeding |= (v8)(own >= (uint8_t)(PITS_PER_SIDE - i)) & (uint8_t)(1 << i);
+    }
+    v8 fed = (v8)(opponent_seeds != 0);
+    return (nonempty & fed) | (feeding & ~fed);
+}
+
+void batch_move_masks(const AwaleBatch* b, uint8_t masks[BATCH_LANES]) {
+    for (int base = 0; base < BATCH_LANES; base += VEC_LANES) {
+        vstore(masks + base, legal_lanes(b, base));
+    }
+}
+
+uint32_t batch_terminal_mask(const AwaleBatch* b) {
+    uint32_t bits = 0;
+    for (int base = 0; base < BATCH_LANES; base += VEC_LANES) {
+        v8 over = (v8)(legal_lanes(b, base) == 0) |
+                  (v8)(vload(b->scores[0] + base) >= WINNING_SCORE) |
+                  (v8)(vload(b->scores[1] + base) >= WINNING_SCORE);
+        bits |= lane_bits(over) << base;
+    }
+    return bits;
+}
+
+#else // Repli scalaire
+
+void batch_play(AwaleBatch* b, const uint8_t pits[BATCH_LANES], uint8_t captured[BATCH_LANES]) {
+    batch_play_scalar(b, pits, captured);
+}
+
+void batch_move_masks(const AwaleBatch* b, uint8_t masks[BATCH_LANES]) {
+    for (int lane = 0; lane < BATCH_LANES; lane++) {
+        AwaleState s;
+        batch_store(b, lane, &s);
+        masks[lane] = (uint8_t)awale_legal_moves(&s);
+    }
+}
+
+uint32_t batch_terminal_mask(const AwaleBatch* b) {
+    uint32_t bits = 0;
+    for (int lane = 0; lane < BATCH_LANES; lane++) {
+        AwaleState s;
+        batch_store(b, lane, &s);
+        if (awale_is_over(&s)) {
+            bits |= 1u << lane;
+        }
+    }
+    return bits;
+}
+
+#endif // BATCH_VECTOR
@@ -0,0 +1,101 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+#include "../../include/book.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+int book_open(OpeningBook* book, const char* path) {
+    memset(book, 0, sizeof(*book));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(BookHeader)) {
+        close(fd);
+        return -1;
+    }
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+
+    const BookHeader* header = map;
+    if (memcmp(header->magic, BOOK_MAGIC, 4) != 0 || header->version != BOOK_VERSION ||
+        header->count > (st.st_size - sizeof(BookHeader)) / sizeof(BookEntry)) {
+        munmap(map, st.st_size);
+        return -1;
+    }
+
+    book->map = map;
+    book->size = st.st_size;
+    book->entries = (const BookEntry*)(header + 1);
+    book->count = header->count;
+    return 0;
+}
+
+void book_close(OpeningBook* book) {
+    if (book->map != NULL) {
+        munmap(book->map, book->size);
+    }
+    memset(book, 0, sizeof(*book));
+}
+
+double book_score(const BookEntry* e) {
+    // Une seule victoire ne doit pas battre 60 % sur cent parties
+    return (e->wins + 0.5 * e->draws + 1.0) / (e->games + 2.0);
+}
+
+int book_probe(const OpeningBook* book, const AwaleState* s, BookEntry moves[PITS_PER_SIDE]) {
+    if (book == NULL || book->map == NULL) {
+        return 0;
+    }
+
+    // Première entrée de clé >= s->key
+    uint64_t lo = 0;
+    uint64_t hi = book->count;
+    while (lo < hi) {
+        uint64_t mid = lo + (hi - lo) / 2;
+        if (book->entries[mid].key < s->key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+
+    int n = 0;
+    for (uint64_t i = lo; i < book->count && book->entries[i].key == s->key; i++) {
+        const BookEntry* e = &book->entries[i];
+        if (n == PITS_PER_SIDE || !awale_is_valid_move(s, e->pit)) {
+            continue;  // Collision de clé
+        }
+        int j = n++;
+        while (j > 0 && book_score(&moves[j - 1]) < book_score(e)) {
+            moves[j] = moves[j - 1];
+            j--;
+        }
+        moves[j] = *e;
+    }
+    return n;
+}
+
+int book_best_move(const OpeningBook* book, const AwaleState* s, BookEntry* best) {
+    BookEntry moves[PITS_PER_SIDE];
+    if (book_probe(book, s, moves) == 0) {
+        return 0;
+    }
+    *best = moves[0];
+    return 1;
+}
@@ -0,0 +1,118 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+#include "../../include/egdb.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static uint64_t binomial(int n, int k) {
+    if (k < 0 || n < k) {
+        return 0;
+    }
+    uint64_t c = 1;
+    for (int i = 1; i <= k; i++) {
+        c = c * (n - k + i) / i;
+    }
+    return c;
+}
+
+uint64_t egdb_count(int seeds) {
+    return binomial(seeds + NUM_PITS - 1, NUM_PITS - 1);
+}
+
+/**
+ * Rang lexicographique de la répartition : pour chaque case, on compte les
+ * répartitions qui y mettent moins de graines (somme télescopique des
+ * répartitions des cases suivantes). La dernière case est déterminée.
+ */
+uint64_t egdb_index(const char board[NUM_PITS], int seeds) {
+    uint64_t index = 0;
+    int remaining = seeds;
+    for (int i = 0; i < NUM_PITS - 1; i++) {
+        int after = NUM_PITS - 1 - i;
+        index += binomial(remaining + after, after) - binomial(remaining - board[i] + after, after);
+        remaining -= board[i];
+    }
+    return index;
+}
+
+int egdb_board_seeds(const AwaleState* s) {
+    int seeds = 0;
+    for (int i = 0; i < NUM_PITS; i++) {
+        seeds += s->board[i];
+    }
+    return seeds;
+}
+
+int egdb_open(EndgameDB* db, const char* path) {
+    memset(db, 0, sizeof(*db));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(EgdbHeader)) {
+        close(fd);
+        return -1;
+    }
+    // Pas de MAP_POPULATE : seules les pages consultées seront lues
+    void* map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+
+    const EgdbHeader* header = map;
+    int valid = memcmp(header->magic, EGDB_MAGIC, 4) == 0 && header->version == EGDB_VERSION &&
+                header->max_seeds <= EGDB_MAX_SEEDS;
+    for (int n = 0; valid && n <= (int)header->max_seeds; n++) {
+        valid = header->offsets[n] + egdb_count(n) <= (uint64_t)st.st_size;
+        db->tables[n] = (const int8_t*)map + header->offsets[n];
+    }
+    if (!valid) {
+        munmap(map, st.st_size);
+        memset(db, 0, sizeof(*db));
+        return -1;
+    }
+
+    db->map = map;
+    db->size = st.st_size;
+    db->max_seeds = header->max_seeds;
+    return 0;
+}
+
+void egdb_close(EndgameDB* db) {
+    if (db->map != NULL) {
+        munmap(db->map, db->size);
+    }
+    memset(db, 0, sizeof(*db));
+}
+
+int egdb_probe(const EndgameDB* db, const AwaleState* s, int* margin) {
+    if (db == NULL || db->map == NULL) {
+        return 0;
+    }
+    int seeds = egdb_board_seeds(s);
+    if (seeds > db->max_seeds) {
+        return 0;
+    }
+
+    // Vue du joueur au trait : ses cases d'abord
+    char board[NUM_PITS];
+    int first = s->current_player * PITS_PER_SIDE;
+    for (int i = 0; i < NUM_PITS; i++) {
+        board[i] = s->board[(first + i) % NUM_PITS];
+    }
+    *margin = db->tables[seeds][egdb_index(board, seeds)];
+    return 1;
+}
@@ -0,0 +1,365 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+#include "../../include/engine.h"
+
+#include <pthread.h>
+#include <string.h>
+#include <time.h>
+
+#define TIME_CHECK_MASK 1023  // Vérifier le temps tous les 1024 noeuds
+#define WIN_THRESHOLD (ENGINE_WIN - 2 * ENGINE_MAX_DEPTH)  // Au-delà : score de fin de partie
+#define MAX_THREADS 64
+
+// État d'une recherche en cours (une instance par appel à engine_search)
+typedef struct {
+    double deadline;           // Instant limite (0 = aucune)
+    const volatile int* stop;
+    const volatile int* halt;  // Fin de la recherche principale (threads auxiliaires)
+    int helper;                // Thread auxiliaire : interruptible dès la profondeur 1
+    int can_abort;             // Faux pendant la première itération
+    int aborted;
+    unsigned long long nodes;
+    TranspositionTable* tt;
+    TTStats tt_stats;
+    const EndgameDB* egdb;
+} Search;
+
+// Coup candidat, trié avant d'être exploré
+typedef struct {
+    int pit;
+    int key;                   // Ordre d'exploration (plus grand d'abord)
+    AwaleState child;
+} Candidate;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int should_stop(Search* search) {
+    if (!search->can_abort) {
+        return 0;
+    }
+    if ((search->stop != NULL && *search->stop) ||
+        (search->halt != NULL && *search->halt) ||
+        (search->deadline > 0 && now_sec() >= search->deadline)) {
+        search->aborted = 1;
+    }
+    return search->aborted;
+}
+
+int engine_evaluate(const AwaleState* s) {
+    int me = s->current_player;
+    return s->scores[me] - s->scores[1 - me];
+}
+
+/**
+ * Score d'une position terminée : victoire au plus tôt, défaite au plus tard
+ */
+static int terminal_score(const AwaleState* s, int ply) {
+    AwaleState end = *s;
+    if (end.scores[0] < WINNING_SCORE && end.scores[1] < WINNING_SCORE) {
+        awale_collect_remaining(&end);
+    }
+    int diff = engine_evaluate(&end);
+    if (diff > 0) {
+        return ENGINE_WIN - ply;
+    }
+    if (diff < 0) {
+        return -ENGINE_WIN + ply;
+    }
+    return 0;
+}
+
+/**
+ * Score d'une position de la base de finales : résultat exact, classé sous
+ * les fins de partie trouvées par la recherche et au-dessus de toute évaluation
+ */
+static int egdb_score(const AwaleState* s, int margin) {
+    int diff = engine_evaluate(s) + margin;
+    if (diff > 0) {
+        return ENGINE_DB_WIN + diff;
+    }
+    if (diff < 0) {
+        return -ENGINE_DB_WIN + diff;
+    }
+    return 0;
+}
+
+/**
+ * Les scores de fin de partie dépendent de la distance à la racine : la table
+ * les stocke relativement à la position elle-même
+ */
+static int score_to_tt(int score, int ply) {
+    if (score > WIN_THRESHOLD) {
+        return score + ply;
+    }
+    if (score < -WIN_THRESHOLD) {
+        return score - ply;
+    }
+    return score;
+}
+
+static int score_from_tt(int score, int ply) {
+    if (score > WIN_THRESHOLD) {
+        return score - ply;
+    }
+    if (score < -WIN_THRESHOLD) {
+        return score + ply;
+    }
+    return score;
+}
+
+/**
+ * Joue tous les coups légaux et les trie : le coup préféré (pv_pit) d'abord,
+ * puis les captures les plus grosses. Retourne le nombre de coups.
+ */
+static int generate(const AwaleState* s, int pv_pit, Candidate moves[PITS_PER_SIDE]) {
+    int legal = awale_legal_moves(s);
+    int first = s->current_player * PITS_PER_SIDE;
+    int n = 0;
+    while (legal) {
+        int i = __builtin_ctz(legal);
+        legal &= legal - 1;
+
+        Candidate c;
+        c.pit = first + i;
+        c.child = *s;
+        c.key = awale_play(&c.child, c.pit);
+        if (c.pit == pv_pit) {
+            c.key += 2 * TOTAL_SEEDS;
+        }
+
+        // Tri par insertion (au plus 6 coups)
+        int j = n++;
+        while (j > 0 && moves[j - 1].key < c.key) {
+            moves[j] = moves[j - 1];
+            j--;
+        }
+        moves[j] = c;
+    }
+    return n;
+}
+
+static int negamax(Search* search, const AwaleState* s, int depth, int alpha, int beta, int ply) {
+    search->nodes++;
+    if ((search->nodes & TIME_CHECK_MASK) == 0 && should_stop(search)) {
+        return 0;
+    }
+
+    if (awale_is_over(s)) {
+        return terminal_score(s, ply);
+    }
+    int margin;
+    if (egdb_probe(search->egdb, s, &margin)) {
+        return egdb_score(s, margin);
+    }
+    if (depth == 0) {
+        return engine_evaluate(s);
+    }
+
+    // Table de transposition : coupure immédiate si l'entrée est assez
+    // profonde, sinon son meilleur coup est essayé en premier
+    int alpha_orig = alpha;
+    int tt_pit = -1;
+    if (search->tt != NULL) {
+        TTHit hit;
+        if (tt_probe(search->tt, s->key, &hit, &search->tt_stats)) {
+            tt_pit = hit.pit;
+            if (hit.depth >= depth) {
+                int score = score_from_tt(hit.score, ply);
+                if (hit.bound == TT_EXACT ||
+                    (hit.bound == TT_LOWER && score >= beta) ||
+                    (hit.bound == TT_UPPER && score <= alpha)) {
+                    return score;
+                }
+            }
+        }
+    }
+
+    Candidate moves[PITS_PER_SIDE];
+    int n = generate(s, tt_pit, moves);
+    int best = -ENGINE_INFINITY;
+    int best_pit = -1;
+    for (int k = 0; k < n; k++) {
+        int score = -negamax(search, &moves[k].child, depth - 1, -beta, -alpha, ply + 1);
+        if (search->aborted) {
+            return 0;
+        }
+        if (score > best) {
+            best = score;
+            best_pit = moves[k].pit;
+        }
+        if (best > alpha) {
+            alpha = best;
+        }
+        if (alpha >= beta) {
+            break;  // Coupure bêta
+        }
+    }
+
+    if (search->tt != NULL) {
+        TTBound bound = best <= alpha_orig ? TT_UPPER : best >= beta ? TT_LOWER : TT_EXACT;
+        tt_store(search->tt, s->key, depth, score_to_tt(best, ply), bound, best_pit, &search->tt_stats);
+    }
+    return best;
+}
+
+/**
+ * Approfondissement itératif depuis first_depth : chaque itération commence
+ * par le meilleur coup de la précédente, une itération interrompue est ignorée
+ */
+static void iterate(Search* search, const AwaleState* s, int first_depth, int max_depth,
+                    EngineResult* result) {
+    Candidate moves[PITS_PER_SIDE];
+    int n = generate(s, -1, moves);
+    if (n > 0) {
+        result->pit = moves[0].pit;
+    }
+    TTHit hit;
+    if (search->tt != NULL && tt_probe(search->tt, s->key, &hit, NULL) && awale_is_valid_move(s, hit.pit)) {
+        result->pit = hit.pit;  // Coup trouvé par une recherche précédente
+    }
+    int margin;
+    if (egdb_probe(search->egdb, s, &margin)) {
+        max_depth = 1;  // Tous les fils sont dans la base : un demi-coup suffit
+    }
+
+    for (int depth = first_depth; depth <= max_depth && n > 0; depth++) {
+        search->can_abort = search->helper || depth > 1;
+        n = generate(s, result->pit, moves);
+
+        int alpha = -ENGINE_INFINITY;
+        int best_pit = moves[0].pit;
+        for (int k = 0; k < n; k++) {
+            int score = -negamax(search, &moves[k].child, depth - 1, -ENGINE_INFINITY, -alpha, 1);
+            if (search->aborted) {
+                break;
+            }
+            if (score > alpha) {
+                alpha = score;
+                best_pit = moves[k].pit;
+            }
+        }
+        if (search->aborted) {
+            break;
+        }
+
+        result->pit = best_pit;
+        result->score = alpha;
+        result->depth = depth;
+        if (search->tt != NULL) {
+            tt_store(search->tt, s->key, depth, score_to_tt(alpha, 0), TT_EXACT, best_pit, &search->tt_stats);
+        }
+
+        // Fin de partie forcée trouvée : inutile de chercher plus loin
+        if (alpha >= ENGINE_WIN - depth || alpha <= -ENGINE_WIN + depth) {
+            break;
+        }
+    }
+}
+
+// Thread auxiliaire du Lazy SMP : même recherche, ne communique que par la table
+typedef struct {
+    pthread_t thread;
+    Search search;
+    const AwaleState* root;
+    int first_depth;
+    int max_depth;
+    EngineResult result;
+} Helper;
+
+static void* helper_main(void* arg) {
+    Helper* h = arg;
+    iterate(&h->search, h->root, h->first_depth, h->max_depth, &h->result);
+    return NULL;
+}
+
+int engine_search(const AwaleState* s, const EngineLimits* limits, EngineResult* result) {
+    double start = now_sec();
+    Search search = {0};
+    search.deadline = limits->time_ms > 0 ? start + limits->time_ms / 1000.0 : 0;
+    search.stop = limits->stop;
+    search.tt = limits->tt;
+    search.egdb = limits->egdb;
+    if (search.tt != NULL) {
+        tt_new_search(search.tt);
+    }
+
+    int max_depth = limits->max_depth;
+    if (max_depth < 1 || max_depth > ENGINE_MAX_DEPTH) {
+        max_depth = ENGINE_MAX_DEPTH;
+    }
+
+    result->pit = -1;
+    result->score = 0;
+    result->depth = 0;
+    result->nodes = 0;
+    result->tt_stats = (TTStats){0};
+
+    BookEntry entry;
+    if (book_best_move(limits->book, s, &entry)) {
+        result->pit = entry.pit;
+        result->time_ms = (int)((now_sec() - start) * 1000);
+        return result->pit;
+    }
+
+    // Lazy SMP : les threads auxiliaires explorent le même arbre, décalés
+    // d'une profondeur un sur deux, et remplissent la table partagée que le
+    // thread principal exploite. Sans table ils ne serviraient à rien.
+    int threads = search.tt != NULL ? limits->threads : 1;
+    if (threads > MAX_THREADS) {
+        threads = MAX_THREADS;
+    }
+    volatile int halt = 0;
+    Helper helpers[MAX_THREADS];
+    int started = 0;
+    for (int i = 1; i < threads; i++) {
+        Helper* h = &helpers[started];
+        memset(h, 0, sizeof(*h));
+        h->search.stop = limits->stop;
+        h->search.halt = &halt;
+        h->search.deadline = search.deadline;
+        h->search.tt = search.tt;
+        h->search.egdb = search.egdb;
+        h->search.helper = 1;
+        h->root = s;
+        h->first_depth = 1 + (i & 1);
+        h->max_depth = max_depth;
+        if (pthread_create(&h->thread, NULL, helper_main, h) == 0) {
+            started++;
+        }
+    }
+
+    iterate(&search, s, 1, max_depth, result);
+
+    halt = 1;
+    result->nodes = search.nodes;
+    result->tt_stats = search.tt_stats;
+    for (int i = 0; i < started; i++) {
+        pthread_join(helpers[i].thread, NULL);
+        result->nodes += helpers[i].search.nodes;
+        if (search.tt != NULL) {
+            tt_add_stats(search.tt, &helpers[i].search.tt_stats);
+        }
+        result->tt_stats.probes += helpers[i].search.tt_stats.probes;
+        result->tt_stats.hits += helpers[i].search.tt_stats.hits;
+        result->tt_stats.collisions += helpers[i].search.tt_stats.collisions;
+        result->tt_stats.stores += helpers[i].search.tt_stats.stores;
+        result->tt_stats.replacements += helpers[i].search.tt_stats.replacements;
+    }
+
+    result->time_ms = (int)((now_sec() - start) * 1000);
+    if (search.tt != NULL) {
+        tt_add_stats(search.tt, &search.tt_stats);
+    }
+    return result->pit;
+}
@@ -9,13 +9,12 @@
 
 #include "../../include/game.h"
 
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
-char board[12];
-char scores[2];
-char current_player;
-char game_over = 0;
+#include "sow_tables.h"
 
 enum {PROPOSITION_DRAW = -1};
 enum {DRAW = 0, CONTINUE = 1};
@@ -29,229 +28,336 @@ int main(void)
 #endif
 
 /**
- * Initialise le plateau de jeu
+ * Initialise une position de départ (4 graines par case, P1 au trait)
  */
-void init_game()
+void awale_init(AwaleState* s)
 {
-    for (int i = 0; i < 12; i++)
+    for (int i = 0; i < NUM_PITS; i++)
     {
-        board[i] = 4;
+        s->board[i] = 4;
     }
-    scores[0] = 0;
-    scores[1] = 0;
-    current_player = 0;
-    game_over = 0;
-    display_board();
+    s->scores[0] = 0;
+    s->scores[1] = 0;
+    s->current_player = 0;
+    s->key = awale_hash(s);
 }
 
 /**
- * Affiche le plateau de jeu
+ * Calcule la clé de Zobrist complète d'une position
+ * (les fonctions du moteur la mettent ensuite à jour de façon incrémentale)
  */
-void display_board()
+uint64_t awale_hash(const AwaleState* s)
 {
-    printf("\n");
-    printf("    P2 (%d pts)\n", scores[1]);
-    printf("-------------------------\n");
-    for (int i = 11; i >= 6; i--)
-    {
-        printf("%2d  ", i);
-    }
-    printf("\n");
-    printf("+---+---+---+---+---+---+\n");
-    printf("|");
-    for (int i = 11; i >= 6; i--)
+    uint64_t key = ZOBRIST_SCORE[0][(int)s->scores[0]] ^ ZOBRIST_SCORE[1][(int)s->scores[1]];
+    for (int i = 0; i < NUM_PITS; i++)
     {
-        printf("%2d |", board[i]);
+        key ^= ZOBRIST_PIT[i][(int)s->board[i]];
     }
-    printf("\n");
-    printf("+---+---+---+---+---+---+\n");
-    printf("|");
-    for (int i = 0; i <= 5; i++)
+    if (s->current_player)
     {
-        printf("%2d |", board[i]);
+        key ^= ZOBRIST_SIDE;
     }
-    printf("\n");
-    printf("+---+---+---+---+---+---+\n");
-    printf(" ");
-    for (int i = 0; i <= 5; i++)
+    return key;
+}
+
+/**
+ * Calcule les coups légaux du joueur au trait sous forme de masque 6 bits
+ * (bit i = i-ème case de son camp). Une case doit être non vide et, si le camp
+ * adverse est vide, le coup doit lui donner au moins une graine (obligation
+ * de nourrir). Un masque nul signifie que le joueur ne peut pas jouer.
+ */
+int awale_legal_moves(const AwaleState* s)
+{
+    const char* own = s->board + s->current_player * PITS_PER_SIDE;
+    const char* opponent = s->board + (1 - s->current_player) * PITS_PER_SIDE;
+
+    int nonempty = 0;
+    int feeding = 0;
+    int opponent_seeds = 0;
+    for (int i = 0; i < PITS_PER_SIDE; i++)
     {
-        printf("%2d  ", i);
+        nonempty |= (own[i] > 0) << i;
+        // Depuis la i-ème case, il faut au moins 6 - i graines pour atteindre l'adversaire
+        feeding |= (own[i] >= PITS_PER_SIDE - i) << i;
+        opponent_seeds |= opponent[i];
     }
-    printf("\n");
-
-    printf("--------------------------\n");
-    printf("    P1 (%d pts)\n", scores[0]);
-    printf("\n");
+    return opponent_seeds ? nonempty : feeding;
 }
 
 /**
- * Joue un tour pour un joueur
+ * Vérifie que le joueur au trait peut jouer la case donnée
  */
-char play_turn(char player)
+int awale_is_valid_move(const AwaleState* s, int pit)
 {
-    char last_pit_index = move(player);
-    if (last_pit_index == PROPOSITION_DRAW)
+    int first = s->current_player * PITS_PER_SIDE;
+    if (pit < first || pit >= first + PITS_PER_SIDE)
     {
-        return DRAW;
+        return 0;
     }
-    char new_score = collect_seeds(player, last_pit_index);
-    scores[player] += new_score;
-    display_board();
-
-    return CONTINUE;
+    return (awale_legal_moves(s) >> (pit - first)) & 1;
 }
 
 /**
- * Collecte les graines selon les règles de capture
+ * Distribue les graines d'une case (en sautant la case de départ)
+ * Retourne l'index de la dernière case semée
+ *
+ * Noyau à temps constant : l'incrément de chaque case (tours complets + reste)
+ * est lu dans SOW_DELTA, généré à la compilation par src/tools/gen_sow_tables.c
  */
-char collect_seeds(char player, char last_pit_index)
+int awale_sow(AwaleState* s, int pit)
 {
-    if (((player == 0) && (last_pit_index >= 6 && last_pit_index <= 11) ||
-         (player == 1) && (last_pit_index >= 0 && last_pit_index < 6))
+    int seeds = s->board[pit];
+    s->board[pit] = 0;
 
-        && (board[last_pit_index] == 2 || board[last_pit_index] == 3))
-    {
-        char collected_seeds = board[last_pit_index];
-        board[last_pit_index] = 0;
-        return collected_seeds + collect_seeds(player, (last_pit_index - 1 + 12) % 12);
-    }
-    return 0;
+    // Les 12 cases sont ajoutées en deux additions 64 + 32 bits : une case ne
+    // dépasse jamais 48 graines, donc aucune retenue ne passe d'un octet à l'autre
+    uint64_t lo, delta_lo;
+    uint32_t hi, delta_hi;
+    memcpy(&lo, s->board, 8);
+    memcpy(&hi, s->board + 8, 4);
+    memcpy(&delta_lo, SOW_DELTA[pit][seeds], 8);
+    memcpy(&delta_hi, SOW_DELTA[pit][seeds] + 8, 4);
+    lo += delta_lo;
+    hi += delta_hi;
+    memcpy(s->board, &lo, 8);
+    memcpy(s->board + 8, &hi, 4);
+
+    return SOW_LAST[pit][seeds];
 }
 
 /**
- * Effectue un mouvement pour un joueur
+ * Collecte les graines selon les règles de capture
+ * Retire du plateau les graines capturées et retourne leur nombre
+ * Grand chelem : un coup qui prendrait toutes les graines adverses ne capture rien
  */
-char move(char player)
+int awale_capture(AwaleState* s, int player, int last_pit)
 {
-    char is_valid = 0;
-    int pit_index = -1;
-    while (!is_valid)
+    // On remonte depuis la dernière case tant qu'on reste dans le camp adverse
+    int first = (1 - player) * PITS_PER_SIDE;
+    int lowest = last_pit + 1;
+    int collected_seeds = 0;
+
+    for (int i = last_pit; i >= first && i < first + PITS_PER_SIDE; i--)
     {
-        printf("Player %d's turn. Choose a pit (0-5 for P1, 6-11 for P2): ", player + 1);
-        printf(" (or enter 255 to propose a draw) ");
-        scanf("%d", &pit_index);
-        if (pit_index == 255)
-        {
-            char response = 0;
-            response = proposition_draw(player);
-            if (response)
-            {
-                game_over = 1;
-                return PROPOSITION_DRAW;
-            }
-            continue;
-        }
-        if ((player == 0 && (pit_index < 0 || pit_index > 5)) ||
-            (player == 1 && (pit_index < 6 || pit_index > 11)) ||
-            board[pit_index] == 0)
-        {
-            printf("Invalid move. Try again.\n");
-            is_valid = 0;
-        }
-        else
+        if (s->board[i] != 2 && s->board[i] != 3)
         {
-            is_valid = 1;
+            break;
         }
+        collected_seeds += s->board[i];
+        lowest = i;
+    }
+    if (collected_seeds == 0)
+    {
+        return 0;
     }
 
-    int seeds = board[pit_index];
-    board[pit_index] = 0;
-    int index = pit_index;
-
-    while (seeds > 0)
+    // Grand chelem : vérifier qu'il reste des graines hors de la chaîne capturée
+    int remaining = 0;
+    for (int i = first; i < first + PITS_PER_SIDE; i++)
     {
-        index = (index + 1) % 12;
-        if (index != pit_index)
+        if (i < lowest || i > last_pit)
         {
-            board[index]++;
-            seeds--;
+            remaining += s->board[i];
         }
     }
-    return index;
+    if (remaining == 0)
+    {
+        return 0;
+    }
+
+    for (int i = lowest; i <= last_pit; i++)
+    {
+        s->board[i] = 0;
+    }
+    return collected_seeds;
 }
 
 /**
- * Change le joueur actuel
+ * Variation de la clé entre deux plateaux qui ne diffèrent que sur les cases
+ * touchées par un semis de seeds graines depuis pit (captures comprises :
+ * une case capturée a toujours reçu une graine)
  */
-void switch_player()
+static uint64_t sow_key_delta(const char* before, const char* after, int pit, int seeds)
 {
-    current_player = 1 - current_player;
+    int touched = seeds < NUM_PITS ? seeds + 1 : NUM_PITS;
+    uint64_t delta = 0;
+    for (int k = 0, j = pit; k < touched; k++)
+    {
+        delta ^= ZOBRIST_PIT[j][(int)before[j]] ^ ZOBRIST_PIT[j][(int)after[j]];
+        j = j == NUM_PITS - 1 ? 0 : j + 1;
+    }
+    return delta;
 }
 
 /**
- * Vérifie si la partie est terminée
+ * Joue un coup complet pour le joueur au trait : semis, capture, changement de joueur
+ * Retourne le nombre de graines capturées, ou -1 si le coup est invalide
+ *
+ * La clé est mise à jour ici, une fois le coup joué : awale_sow et
+ * awale_capture ne touchent que le plateau
  */
-char is_game_over(char continued)
+int awale_play(AwaleState* s, int pit)
 {
-    if (continued == DRAW)
+    if (!awale_is_valid_move(s, pit))
     {
-        return 1;
+        return -1;
     }
-    
-    int side1_empty = 1;
-    int side2_empty = 1;
-    
-    for (int i = 0; i < 6; i++)
+    char before[NUM_PITS];
+    memcpy(before, s->board, NUM_PITS);
+    int player = s->current_player;
+    int seeds = s->board[pit];
+    int last_pit = awale_sow(s, pit);
+    int gained = awale_capture(s, player, last_pit);
+    s->key ^= sow_key_delta(before, s->board, pit, seeds);
+    if (gained)
     {
-        if (board[i] > 0)
-        {
-            side1_empty = 0;
-            break;
-        }
+        s->key ^= ZOBRIST_SCORE[player][(int)s->scores[player]];
+        s->scores[player] += gained;
+        s->key ^= ZOBRIST_SCORE[player][(int)s->scores[player]];
     }
+    s->current_player = 1 - player;
+    s->key ^= ZOBRIST_SIDE;
+    return gained;
+}
 
-    for (int i = 6; i < 12; i++)
+/**
+ * Vérifie si la partie est terminée : score gagnant atteint, ou joueur au trait
+ * sans coup légal (camp vide, ou impossible de nourrir l'adversaire)
+ */
+int awale_is_over(const AwaleState* s)
+{
+    return s->scores[0] >= WINNING_SCORE || s->scores[1] >= WINNING_SCORE ||
+           awale_legal_moves(s) == 0;
+}
+
+/**
+ * Chaque joueur récupère les graines restantes dans son camp
+ * (si l'adversaire ne peut plus être nourri, toutes les graines sont dans le camp du joueur au trait)
+ */
+void awale_collect_remaining(AwaleState* s)
+{
+    for (int i = 0; i < NUM_PITS; i++)
     {
-        if (board[i] > 0)
-        {
-            side2_empty = 0;
-            break;
-        }
+        s->scores[i < PITS_PER_SIDE ? 0 : 1] += s->board[i];
+        s->board[i] = 0;
     }
+    s->key = awale_hash(s);
+}
 
-    if (side1_empty || side2_empty || scores[0] >= 25 || scores[1] >= 25)
+/**
+ * Affiche le plateau de jeu
+ */
+void display_board(const AwaleState* s)
+{
+    printf("\n");
+    printf("    P2 (%d pts)\n", s->scores[1]);
+    printf("-------------------------\n");
+    for (int i = 11; i >= 6; i--)
+    {
+        printf("%2d  ", i);
+    }
+    printf("\n");
+    printf("+---+---+---+---+---+---+\n");
+    printf("|");
+    for (int i = 11; i >= 6; i--)
     {
-        game_over = 1;
+        printf("%2d |", s->board[i]);
     }
+    printf("\n");
+    printf("+---+---+---+---+---+---+\n");
+    printf("|");
+    for (int i = 0; i <= 5; i++)
+    {
+        printf("%2d |", s->board[i]);
+    }
+    printf("\n");
+    printf("+---+---+---+---+---+---+\n");
+    printf(" ");
+    for (int i = 0; i <= 5; i++)
+    {
+        printf("%2d  ", i);
+    }
+    printf("\n");
 
-    return game_over;
+    printf("--------------------------\n");
+    printf("    P1 (%d pts)\n", s->scores[0]);
+    printf("\n");
 }
 
 /**
- * Collecte les graines restantes à la fin de la partie
+ * Propose un match nul à l'adversaire
  */
-void collect_remaining_seeds(char continued)
+static char proposition_draw(char player)
 {
-    if (continued == DRAW)
+    char response;
+    printf("Player %d proposes a draw to Player %d. Do you accept? (1 for Yes, 0 for No): ", player + 1, 2 - player);
+    scanf(" %c", &response);
+    return response == '1';
+}
+
+/**
+ * Demande un coup valide au joueur au trait
+ * Retourne la case choisie, ou PROPOSITION_DRAW si l'égalité est acceptée
+ */
+static int move(const AwaleState* s)
+{
+    int pit_index = -1;
+    while (1)
     {
-        return;
+        printf("Player %d's turn. Choose a pit (0-5 for P1, 6-11 for P2): ", s->current_player + 1);
+        printf(" (or enter 255 to propose a draw) ");
+        scanf("%d", &pit_index);
+        if (pit_index == 255)
+        {
+            if (proposition_draw(s->current_player))
+            {
+                return PROPOSITION_DRAW;
+            }
+            continue;
+        }
+        if (awale_is_valid_move(s, pit_index))
+        {
+            return pit_index;
+        }
+        printf("Invalid move. Try again.\n");
     }
-    for (int i = 0; i < 12; i++)
+}
+
+/**
+ * Joue un tour pour le joueur au trait
+ */
+static char play_turn(AwaleState* s)
+{
+    int pit_index = move(s);
+    if (pit_index == PROPOSITION_DRAW)
     {
-        scores[i < 6 ? 0 : 1] += board[i];
-        board[i] = 0;
+        return DRAW;
     }
+    awale_play(s, pit_index);
+    display_board(s);
+
+    return CONTINUE;
 }
 
 /**
  * Affiche le résultat final de la partie
  */
-void declare_winner(char continued)
+static void declare_winner(const AwaleState* s, char continued)
 {
     printf("Final Scores:\n");
-    printf("Player 1: %d\n", scores[0]);
-    printf("Player 2: %d\n", scores[1]);
+    printf("Player 1: %d\n", s->scores[0]);
+    printf("Player 2: %d\n", s->scores[1]);
 
     if (continued == DRAW)
     {
         printf("The game ended in a draw by agreement.\n");
         return;
     }
-    if (scores[0] > scores[1])
+    if (s->scores[0] > s->scores[1])
     {
         printf("Player 1 wins!\n");
     }
-    else if (scores[1] > scores[0])
+    else if (s->scores[1] > s->scores[0])
     {
         printf("Player 2 wins!\n");
     }
@@ -261,29 +367,23 @@ void declare_winner(char continued)
     }
 }
 
-/**
- * Propose un match nul à l'adversaire
- */
-char proposition_draw(char player)
-{
-    char response;
-    printf("Player %d proposes a draw to Player %d. Do you accept? (1 for Yes, 0 for No): ", player + 1, 2 - player);
-    scanf(" %c", &response);
-    return response == '1';
-}
-
 /**
  * Boucle principale du jeu
  */
 void game_loop()
 {
-    init_game();
+    AwaleState s;
+    awale_init(&s);
+    display_board(&s);
+
     int continued = CONTINUE;
-    while (!is_game_over(continued))
+    while (continued == CONTINUE && !awale_is_over(&s))
+    {
+        continued = play_turn(&s);
+    }
+    if (continued == CONTINUE)
     {
-        continued = play_turn(current_player);
-        switch_player();
+        awale_collect_remaining(&s);
     }
-    collect_remaining_seeds(continued);
-    declare_winner(continued);
+    declare_winner(&s, continued);
 }
@@ -0,0 +1,109 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+#include "../../include/linebuf.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+void linebuf_init(LineBuffer* lb) {
+    lb->head = 0;
+    lb->len = 0;
+}
+
+ssize_t linebuf_fill(LineBuffer* lb, int fd, int flags) {
+    size_t free_space = LINEBUF_SIZE - lb->len;
+    if (free_space == 0) {
+        errno = ENOBUFS;
+        return -1;
+    }
+
+    // La place libre commence après les données et peut faire le tour du
+    // tampon : deux segments remplis par le même appel
+    size_t tail = (lb->head + lb->len) % LINEBUF_SIZE;
+    size_t first = LINEBUF_SIZE - tail < free_space ? LINEBUF_SIZE - tail : free_space;
+    struct iovec iov[2] = {
+        {lb->data + tail, first},
+        {lb->data, free_space - first},
+    };
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = free_space > first ? 2 : 1;
+
+    ssize_t r = recvmsg(fd, &msg, flags);
+    if (r > 0) {
+        lb->len += (size_t)r;
+    }
+    return r;
+}
+
+size_t linebuf_append(LineBuffer* lb, const char* data, size_t n) {
+    size_t free_space = LINEBUF_SIZE - lb->len;
+    if (n > free_space) {
+        n = free_space;
+    }
+    size_t tail = (lb->head + lb->len) % LINEBUF_SIZE;
+    size_t first = LINEBUF_SIZE - tail < n ? LINEBUF_SIZE - tail : n;
+    memcpy(lb->data + tail, data, first);
+    memcpy(lb->data, data + first, n - first);
+    lb->len += n;
+    return n;
+}
+
+/**
+ * Position du premier '\n' après head (décalage), -1 si absent
+ */
+static long find_newline(const LineBuffer* lb) {
+    size_t first = LINEBUF_SIZE - lb->head < lb->len ? LINEBUF_SIZE - lb->head : lb->len;
+    const char* p = memchr(lb->data + lb->head, '\n', first);
+    if (p != NULL) {
+        return p - (lb->data + lb->head);
+    }
+    p = memchr(lb->data, '\n', lb->len - first);
+    return p != NULL ? (long)first + (p - lb->data) : -1;
+}
+
+int linebuf_has_line(const LineBuffer* lb) {
+    return lb->len == LINEBUF_SIZE || find_newline(lb) >= 0;
+}
+
+int linebuf_next_line(LineBuffer* lb, char* out, size_t cap) {
+    long newline = find_newline(lb);
+    size_t length;
+    size_t consumed;
+    if (newline >= 0) {
+        length = (size_t)newline;
+        consumed = length + 1;
+    } else if (lb->len == LINEBUF_SIZE) {
+        length = LINEBUF_SIZE;
+        consumed = LINEBUF_SIZE;
+    } else {
+        return 0;
+    }
+
+    size_t n = length < cap - 1 ? length : cap - 1;
+    linebuf_peek(lb, out, n);
+    out[n] = '\0';
+    linebuf_skip(lb, consumed);
+    return 1;
+}
+
+void linebuf_peek(const LineBuffer* lb, char* out, size_t n) {
+    size_t first = LINEBUF_SIZE - lb->head < n ? LINEBUF_SIZE - lb->head : n;
+    memcpy(out, lb->data + lb->head, first);
+    memcpy(out + first, lb->data, n - first);
+}
+
+void linebuf_skip(LineBuffer* lb, size_t n) {
+    lb->len -= n;
+    lb->head = lb->len > 0 ? (lb->head + n) % LINEBUF_SIZE : 0;
+}
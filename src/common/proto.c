@@ -0,0 +1,272 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+#include "../../include/proto.h"
+
+#include <stdio.h>
+#include <string.h>
+
+// Mot-clé texte de chaque opcode (NULL : opcode libre)
+static const char* const keywords[PROTO_NUM_OPCODES] = {
+    [PROTO_REGISTER] = "REGISTER",
+    [PROTO_MSG] = "MSG",
+    [PROTO_CHAT] = "CHAT",
+    [PROTO_STATE] = "STATE",
+    [PROTO_ROLE] = "ROLE",
+    [PROTO_END] = "END",
+    [PROTO_ASKDRAW] = "ASKDRAW",
+    [PROTO_ASKSAVE] = "ASKSAVE",
+    [PROTO_HINT] = "HINT",
+    [PROTO_ANALYSIS] = "ANALYSIS",
+    [PROTO_USERLIST] = "USERLIST",
+    [PROTO_GAMESLIST] = "GAMESLIST",
+    [PROTO_CHALLENGED_BY] = "CHALLENGED_BY",
+    [PROTO_BIO] = "BIO",
+    [PROTO_REPLAY] = "REPLAY",
+    [PROTO_STATE_DELTA] = "STATE_DELTA",
+    [PROTO_PING] = "PING",
+    [PROTO_USERNAME] = "USERNAME",
+    [PROTO_MOVE] = "MOVE",
+    [PROTO_DRAW] = "DRAW",
+    [PROTO_YES] = "YES",
+    [PROTO_NO] = "NO",
+    [PROTO_QUIT] = "QUIT",
+    [PROTO_LIST] = "LIST",
+    [PROTO_GAMES] = "GAMES",
+    [PROTO_CHALLENGE] = "CHALLENGE",
+    [PROTO_ACCEPT] = "ACCEPT",
+    [PROTO_REFUSE] = "REFUSE",
+    [PROTO_WATCH] = "WATCH",
+    [PROTO_BOARD] = "BOARD",
+    [PROTO_STOPWATCH] = "STOPWATCH",
+    [PROTO_WHOIS] = "WHOIS",
+    [PROTO_ADDFRIEND] = "ADDFRIEND",
+    [PROTO_ACCEPTFRIEND] = "ACCEPTFRIEND",
+    [PROTO_LISTFRIENDREQUESTS] = "LISTFRIENDREQUESTS",
+    [PROTO_REMOVEFRIEND] = "REMOVEFRIEND",
+    [PROTO_LISTFRIENDS] = "LISTFRIENDS",
+    [PROTO_PRIVATE] = "PRIVATE",
+    [PROTO_SAVE] = "SAVE",
+    [PROTO_HISTORY] = "HISTORY",
+    [PROTO_ANALYZE] = "ANALYZE",
+    [PROTO_RESYNC] = "RESYNC",
+    [PROTO_PONG] = "PONG",
+};
+
+static void write_header(char* out, int op, size_t len) {
+    out[0] = (char)op;
+    out[1] = (char)(len >> 8);
+    out[2] = (char)(len & 0xff);
+}
+
+size_t proto_encode_state(char* out, const AwaleState* s) {
+    write_header(out, PROTO_STATE, PROTO_STATE_LEN);
+    memcpy(out + PROTO_HEADER_LEN, s->board, NUM_PITS);
+    out[PROTO_HEADER_LEN + NUM_PITS] = s->scores[0];
+    out[PROTO_HEADER_LEN + NUM_PITS + 1] = s->scores[1];
+    out[PROTO_HEADER_LEN + NUM_PITS + 2] = s->current_player;
+    return PROTO_HEADER_LEN + PROTO_STATE_LEN;
+}
+
+void proto_decode_state(const char* payload, AwaleState* s) {
+    memcpy(s->board, payload, NUM_PITS);
+    s->scores[0] = payload[NUM_PITS];
+    s->scores[1] = payload[NUM_PITS + 1];
+    s->current_player = payload[NUM_PITS + 2];
+    s->key = awale_hash(s);
+}
+
+/**
+ * Champ i d'une position dans l'ordre du masque STATE_DELTA : les cases,
+ * les deux scores, le joueur au trait (même ordre que la trame STATE)
+ */
+static char get_field(const AwaleState* s, int i) {
+    if (i < NUM_PITS) {
+        return s->board[i];
+    }
+    return i < NUM_PITS + 2 ? s->scores[i - NUM_PITS] : s->current_player;
+}
+
+static void set_field(AwaleState* s, int i, char v) {
+    if (i < NUM_PITS) {
+        s->board[i] = v;
+    } else if (i < NUM_PITS + 2) {
+        s->scores[i - NUM_PITS] = v;
+    } else {
+        s->current_player = v;
+    }
+}
+
+size_t proto_encode_delta(char* out, const AwaleState* from, const AwaleState* to, unsigned seq) {
+    unsigned mask = from == NULL ? PROTO_DELTA_FULL : 0;
+    size_t len = 3;
+    for (int i = 0; i < PROTO_STATE_LEN; i++) {
+        char v = get_field(to, i);
+        if (from == NULL || get_field(from, i) != v) {
+            mask |= 1u << i;
+            out[PROTO_HEADER_LEN + len++] = v;
+        }
+    }
+    write_header(out, PROTO_STATE_DELTA, len);
+    out[PROTO_HEADER_LEN] = (char)(seq & 0xff);
+    out[PROTO_HEADER_LEN + 1] = (char)(mask >> 8);
+    out[PROTO_HEADER_LEN + 2] = (char)(mask & 0xff);
+    return PROTO_HEADER_LEN + len;
+}
+
+int proto_apply_delta(const char* payload, size_t len, AwaleState* s, int* seq) {
+    if (len < 3) {
+        return -1;
+    }
+    int next = (unsigned char)payload[0];
+    unsigned mask = ((unsigned)(unsigned char)payload[1] << 8) | (unsigned char)payload[2];
+    size_t fields = (size_t)__builtin_popcount(mask & ~PROTO_DELTA_FULL);
+    if (len != 3 + fields || ((mask & PROTO_DELTA_FULL) && fields != PROTO_STATE_LEN)) {
+        return -1;
+    }
+    if (!(mask & PROTO_DELTA_FULL) && (*seq < 0 || ((*seq + 1) & 0xff) != next)) {
+        return 0;
+    }
+    const char* v = payload + 3;
+    for (int i = 0; i < PROTO_STATE_LEN; i++) {
+        if (mask & (1u << i)) {
+            set_field(s, i, *v++);
+        }
+    }
+    s->key = awale_hash(s);
+    *seq = next;
+    return 1;
+}
+
+/**
+ * Opcode du mot-clé qui commence la ligne (PROTO_TEXT si aucun) ; le mot-clé
+ * se termine à l'espace, au saut de ligne ou à la fin de la ligne
+ */
+static int find_opcode(const char* line, size_t n, size_t* keyword_len) {
+    size_t k = 0;
+    while (k < n && line[k] != ' ' && line[k] != '\n') {
+        k++;
+    }
+    for (int op = 1; op < PROTO_NUM_OPCODES; op++) {
+        if (keywords[op] != NULL && strlen(keywords[op]) == k && !memcmp(line, keywords[op], k)) {
+            *keyword_len = k;
+            return op;
+        }
+    }
+    *keyword_len = 0;
+    return PROTO_TEXT;
+}
+
+size_t proto_encode_line(const char* line, size_t n, char* out, size_t cap) {
+    if (n > 0 && line[n - 1] == '\n') {
+        n--;
+    }
+    size_t keyword_len;
+    int op = find_opcode(line, n, &keyword_len);
+    const char* payload = line;
+    size_t len = n;
+    if (op != PROTO_TEXT) {
+        // Le séparateur (espace ou saut de ligne) ne fait pas partie du contenu
+        size_t skip = keyword_len < n ? keyword_len + 1 : keyword_len;
+        payload += skip;
+        len -= skip;
+    }
+
+    if (op == PROTO_MOVE) {
+        char pit[4];
+        int value;
+        char extra;
+        if (len < sizeof(pit) && cap >= PROTO_HEADER_LEN + 1) {
+            memcpy(pit, payload, len);
+            pit[len] = '\0';
+            if (sscanf(pit, "%d%c", &value, &extra) == 1 && value >= 0 && value < NUM_PITS) {
+                write_header(out, PROTO_MOVE, 1);
+                out[PROTO_HEADER_LEN] = (char)value;
+                return PROTO_HEADER_LEN + 1;
+            }
+        }
+        // Coup mal formé : transmis tel quel, le serveur le refusera
+        op = PROTO_TEXT;
+        payload = line;
+        len = n;
+    }
+
+    if (len > PROTO_MAX_PAYLOAD) {
+        len = PROTO_MAX_PAYLOAD;
+    }
+    if (len > cap - PROTO_HEADER_LEN) {
+        len = cap - PROTO_HEADER_LEN;
+    }
+    write_header(out, op, len);
+    memcpy(out + PROTO_HEADER_LEN, payload, len);
+    return PROTO_HEADER_LEN + len;
+}
+
+int proto_payload_is_line(int op, const char* payload, size_t len) {
+    if (op == PROTO_MOVE && len == 1) {
+        return 1;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (payload[i] == '\n' || payload[i] == '\r' || payload[i] == '\0') {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+size_t proto_decode_line(int op, const char* payload, size_t len, char* out, size_t cap) {
+    int n;
+    if (op == PROTO_MOVE && len == 1) {
+        n = snprintf(out, cap, "MOVE %d", (unsigned char)payload[0]);
+    } else if (op > PROTO_TEXT && op < PROTO_NUM_OPCODES && keywords[op] != NULL) {
+        n = snprintf(out, cap, len > 0 ? "%s %.*s" : "%s", keywords[op], (int)len, payload);
+    } else {
+        n = snprintf(out, cap, "%.*s", (int)len, payload);
+    }
+    return (size_t)n < cap ? (size_t)n : cap - 1;
+}
+
+/**
+ * Longueur du contenu annoncée par l'en-tête de la trame en tête du tampon
+ */
+static size_t payload_length(const LineBuffer* lb) {
+    char header[PROTO_HEADER_LEN];
+    linebuf_peek(lb, header, PROTO_HEADER_LEN);
+    return ((size_t)(unsigned char)header[1] << 8) | (unsigned char)header[2];
+}
+
+int proto_has_frame(const LineBuffer* lb) {
+    if (lb->len < PROTO_HEADER_LEN) {
+        return 0;
+    }
+    size_t len = payload_length(lb);
+    return len > PROTO_MAX_PAYLOAD || lb->len >= PROTO_HEADER_LEN + len;
+}
+
+int proto_next_frame(LineBuffer* lb, int* op, char* out, size_t cap, size_t* len) {
+    if (lb->len < PROTO_HEADER_LEN) {
+        return 0;
+    }
+    size_t n = payload_length(lb);
+    if (n > PROTO_MAX_PAYLOAD || n > cap - 1) {
+        return -1;
+    }
+    if (lb->len < PROTO_HEADER_LEN + n) {
+        return 0;
+    }
+    char header[PROTO_HEADER_LEN];
+    linebuf_peek(lb, header, PROTO_HEADER_LEN);
+    linebuf_skip(lb, PROTO_HEADER_LEN);
+    linebuf_peek(lb, out, n);
+    linebuf_skip(lb, n);
+    out[n] = '\0';
+    *op = (unsigned char)header[0];
+    *len = n;
+    return 1;
+}
@@ -0,0 +1,197 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+#include "../../include/tt.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+// Champs de TTEntry.data
+#define SCORE_SHIFT 0    // 16 bits, décalé de 32768
+#define DEPTH_SHIFT 16   // 8 bits
+#define BOUND_SHIFT 24   // 2 bits (jamais TT_NONE pour une entrée valide)
+#define PIT_SHIFT 26     // 4 bits, case + 1 (0 = aucun coup)
+#define GEN_SHIFT 32     // 8 bits
+
+#define FILL_SAMPLE 1024  // Buckets examinés par tt_fill_permille
+
+static inline uint64_t load(const uint64_t* p) {
+    return __atomic_load_n(p, __ATOMIC_RELAXED);
+}
+
+static inline void store(uint64_t* p, uint64_t v) {
+    __atomic_store_n(p, v, __ATOMIC_RELAXED);
+}
+
+static inline int entry_depth(uint64_t data) {
+    return (int)((data >> DEPTH_SHIFT) & 0xFF);
+}
+
+static inline uint8_t entry_generation(uint64_t data) {
+    return (uint8_t)(data >> GEN_SHIFT);
+}
+
+int tt_init(TranspositionTable* tt, size_t megabytes) {
+    size_t bucket_bytes = TT_BUCKET_SIZE * sizeof(TTEntry);
+    size_t buckets = 1;
+    while (buckets * 2 * bucket_bytes <= megabytes * 1024 * 1024) {
+        buckets *= 2;
+    }
+
+    memset(tt, 0, sizeof(*tt));
+    tt->entries = aligned_alloc(64, buckets * bucket_bytes);
+    if (tt->entries == NULL) {
+        return -1;
+    }
+    tt->mask = buckets - 1;
+    tt_clear(tt);
+    return 0;
+}
+
+void tt_free(TranspositionTable* tt) {
+    free(tt->entries);
+    tt->entries = NULL;
+}
+
+void tt_clear(TranspositionTable* tt) {
+    memset(tt->entries, 0, tt_size_bytes(tt));
+    memset(&tt->stats, 0, sizeof(tt->stats));
+    tt->generation = 0;
+}
+
+void tt_new_search(TranspositionTable* tt) {
+    __atomic_add_fetch(&tt->generation, 1, __ATOMIC_RELAXED);
+}
+
+size_t tt_size_bytes(const TranspositionTable* tt) {
+    return (size_t)(tt->mask + 1) * TT_BUCKET_SIZE * sizeof(TTEntry);
+}
+
+/**
+ * Cherche la position dans son bucket. Une entrée occupée dont la
+ * vérification échoue (autre position du même bucket, ou entrée à moitié
+ * écrite) compte comme collision, au plus une fois par consultation.
+ */
+int tt_probe(const TranspositionTable* tt, uint64_t key, TTHit* hit, TTStats* stats) {
+    const TTEntry* bucket = tt->entries + (key & tt->mask) * TT_BUCKET_SIZE;
+    int collided = 0;
+    if (stats != NULL) {
+        stats->probes++;
+    }
+    for (int i = 0; i < TT_BUCKET_SIZE; i++) {
+        uint64_t data = load(&bucket[i].data);
+        if (data == 0) {
+            continue;
+        }
+        if ((load(&bucket[i].check) ^ data) != key) {
+            collided = 1;
+            continue;
+        }
+        if (stats != NULL) {
+            stats->hits++;
+            stats->collisions += collided;
+        }
+        hit->score = (int)((data >> SCORE_SHIFT) & 0xFFFF) - 32768;
+        hit->depth = entry_depth(data);
+        hit->bound = (TTBound)((data >> BOUND_SHIFT) & 0x3);
+        hit->pit = (int)((data >> PIT_SHIFT) & 0xF) - 1;
+        return 1;
+    }
+    if (stats != NULL) {
+        stats->collisions += collided;
+    }
+    return 0;
+}
+
+/**
+ * Remplacement par profondeur : la même position est toujours mise à jour,
+ * sinon une entrée vide, sinon la moins profonde (entrées d'une ancienne
+ * recherche d'abord)
+ */
+void tt_store(TranspositionTable* tt, uint64_t key, int depth, int score, TTBound bound, int pit,
+              TTStats* stats) {
+    TTEntry* bucket = tt->entries + (key & tt->mask) * TT_BUCKET_SIZE;
+    uint8_t generation = __atomic_load_n(&tt->generation, __ATOMIC_RELAXED);
+
+    TTEntry* victim = NULL;
+    int victim_rank = 1 << 30;
+    int replaced = 0;
+    for (int i = 0; i < TT_BUCKET_SIZE; i++) {
+        uint64_t data = load(&bucket[i].data);
+        if (data == 0) {
+            if (victim_rank > -1) {
+                victim = &bucket[i];
+                victim_rank = -1;
+                replaced = 0;
+            }
+            continue;
+        }
+        if ((load(&bucket[i].check) ^ data) == key) {
+            // Même position : garder le coup connu si la nouvelle entrée n'en a pas
+            if (pit < 0) {
+                pit = (int)((data >> PIT_SHIFT) & 0xF) - 1;
+            }
+            victim = &bucket[i];
+            replaced = 0;
+            break;
+        }
+        int rank = entry_depth(data) + (entry_generation(data) == generation ? 256 : 0);
+        if (rank < victim_rank) {
+            victim = &bucket[i];
+            victim_rank = rank;
+            replaced = 1;
+        }
+    }
+
+    if (score < -32768) {
+        score = -32768;
+    } else if (score > 32767) {
+        score = 32767;
+    }
+    if (depth > 0xFF) {
+        depth = 0xFF;
+    }
+    uint64_t data = ((uint64_t)(uint16_t)(score + 32768) << SCORE_SHIFT) |
+                    ((uint64_t)depth << DEPTH_SHIFT) |
+                    ((uint64_t)bound << BOUND_SHIFT) |
+                    ((uint64_t)(pit + 1) << PIT_SHIFT) |
+                    ((uint64_t)generation << GEN_SHIFT);
+    store(&victim->check, key ^ data);
+    store(&victim->data, data);
+
+    if (stats != NULL) {
+        stats->stores++;
+        stats->replacements += replaced;
+    }
+}
+
+void tt_add_stats(TranspositionTable* tt, const TTStats* stats) {
+    __atomic_add_fetch(&tt->stats.probes, stats->probes, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&tt->stats.hits, stats->hits, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&tt->stats.collisions, stats->collisions, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&tt->stats.stores, stats->stores, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&tt->stats.replacements, stats->replacements, __ATOMIC_RELAXED);
+}
+
+void tt_get_stats(const TranspositionTable* tt, TTStats* stats) {
+    stats->probes = __atomic_load_n(&tt->stats.probes, __ATOMIC_RELAXED);
+    stats->hits = __atomic_load_n(&tt->stats.hits, __ATOMIC_RELAXED);
+    stats->collisions = __atomic_load_n(&tt->stats.collisions, __ATOMIC_RELAXED);
+    stats->stores = __atomic_load_n(&tt->stats.stores, __ATOMIC_RELAXED);
+    stats->replacements = __atomic_load_n(&tt->stats.replacements, __ATOMIC_RELAXED);
+}
+
+int tt_fill_permille(const TranspositionTable* tt) {
+    uint64_t buckets = tt->mask + 1 < FILL_SAMPLE ? tt->mask + 1 : FILL_SAMPLE;
+    uint64_t used = 0;
+    for (uint64_t i = 0; i < buckets * TT_BUCKET_SIZE; i++) {
+        used += load(&tt->entries[i].data) != 0;
+    }
+    return (int)(used * 1000 / (buckets * TT_BUCKET_SIZE));
+}
@@ -0,0 +1,657 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+// Relais de spectateurs : s'abonne une seule fois à une partie du serveur
+// (un WATCH en protocole v2) et la rediffuse à ses propres spectateurs. Le
+// serveur ne voit qu'un client par relais, quel que soit le public ; pour
+// une finale, plusieurs relais sur la même machine se partagent l'audience.
+//
+// Les positions reçues pendant un tick sont fusionnées : à chaque tick, les
+// messages du serveur (MSG, CHAT, END) puis la dernière position partent
+// vers tous les spectateurs. Chaque forme (lignes de texte, trames v2, trames
+// v2 avec STATE_DELTA) est construite une fois par tick ; un spectateur dont
+// la file est vide reçoit directement ce tampon commun, seul ce que son
+// socket n'a pas accepté est copié dans sa file.
+//
+// Les spectateurs s'enregistrent comme auprès du serveur (REGISTER V2 DELTA
+// puis USERNAME <nom> [V2] [DELTA]). Le relais est en lecture seule : leurs
+// commandes sont ignorées, ils partent en fermant la connexion. Le relais
+// s'arrête à la fin de la partie.
+//
+// Usage : relay [-l port_écoute] [-t tick_ms] [-p port_serveur] [hôte] partie
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../../include/outq.h"
+#include "../../include/proto.h"
+
+#define DEFAULT_LISTEN_PORT 4322
+#define DEFAULT_SERVER_PORT 4321
+#define DEFAULT_TICK_MS 50
+#define MAX_EVENTS 256
+#define HELLO_LEN 128                        // Ligne USERNAME d'un spectateur
+#define SPECTATOR_OUTPUT_LIMIT (256 * 1024)  // Au-delà, le spectateur est déconnecté
+#define DRAIN_MS 1000                        // Délai laissé aux files à la fin de la partie
+
+typedef struct Spectator {
+    int fd;
+    int slot;                   // Place dans spectators[]
+    int registered;             // USERNAME reçu
+    int proto;                  // 1 : lignes de texte, 2 : trames
+    int delta;                  // Positions en STATE_DELTA
+    int writable;               // EPOLLOUT demandé (file non vide)
+    int dead;                   // Retiré, libéré après le lot d'événements en cours
+    char hello[HELLO_LEN];
+    size_t hello_len;
+    OutputQueue output;
+    struct Spectator* next_dead;
+} Spectator;
+
+// Tampon d'octets extensible : messages et formes d'un tick
+typedef struct {
+    char* data;
+    size_t len;
+    size_t cap;
+} Buffer;
+
+static int epfd;
+static int listen_fd;
+static int origin_fd;
+static LineBuffer origin_input;
+
+static Spectator** spectators;
+static int num_spectators;
+static int max_spectators;
+static Spectator* dead_spectators;  // Retirés pendant le lot d'événements en cours
+
+static AwaleState state;        // Dernière position reçue du serveur
+static int state_dirty;         // Reçue depuis le dernier tick
+static AwaleState sent_state;   // Dernière position diffusée, base des deltas
+static unsigned sent_seq;
+static char welcome[256];       // "MSG Vous regardez la partie entre ..." du serveur
+static Buffer batch_text;       // Messages du tick en cours, en lignes
+static Buffer batch_frames;     // Les mêmes, en trames
+static Buffer out_text;
+static Buffer out_frames;
+static Buffer out_delta;
+
+static unsigned long long states_in;
+static unsigned long long ticks;
+static unsigned long long bytes_out;
+static unsigned long long slow_drops;
+static int peak_audience;
+
+static double now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void buf_append(Buffer* b, const char* s, size_t n) {
+    if (b->len + n > b->cap) {
+        size_t cap = b->cap ? b->cap : 4096;
+        while (cap < b->len + n) {
+            cap *= 2;
+        }
+        char* data = realloc(b->data, cap);
+        if (data == NULL) {
+            return;
+        }
+        b->data = data;
+        b->cap = cap;
+    }
+    memcpy(b->data + b->len, s, n);
+    b->len += n;
+}
+
+static void send_all(int fd, const char* s, size_t n) {
+    while (n > 0) {
+        ssize_t w = send(fd, s, n, MSG_NOSIGNAL);
+        if (w < 0 && errno == EINTR) {
+            continue;
+        }
+        if (w <= 0) {
+            return;
+        }
+        s += w;
+        n -= (size_t)w;
+    }
+}
+
+/**
+ * Envoie une ligne au serveur, en trame (la connexion est en v2)
+ */
+static void send_origin(const char* line) {
+    char frame[PROTO_HEADER_LEN + 64];
+    send_all(origin_fd, frame, proto_encode_line(line, strlen(line), frame, sizeof(frame)));
+}
+
+static int format_state(char* out, size_t cap, const AwaleState* s) {
+    return snprintf(out, cap, "STATE %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d\n",
+                    s->board[0], s->board[1], s->board[2], s->board[3], s->board[4], s->board[5],
+                    s->board[6], s->board[7], s->board[8], s->board[9], s->board[10], s->board[11],
+                    s->scores[0], s->scores[1], s->current_player);
+}
+
+/**
+ * Retire un spectateur de la diffusion. Un événement du même lot epoll peut
+ * encore le désigner (un tick lancé par une trame du serveur retire un
+ * spectateur trop lent) : il n'est libéré qu'après le lot, par
+ * free_dead_spectators.
+ */
+static void remove_spectator(Spectator* sp) {
+    epoll_ctl(epfd, EPOLL_CTL_DEL, sp->fd, NULL);
+    close(sp->fd);
+    outq_free(&sp->output);
+    Spectator* last = spectators[--num_spectators];
+    spectators[sp->slot] = last;
+    last->slot = sp->slot;
+    sp->dead = 1;
+    sp->next_dead = dead_spectators;
+    dead_spectators = sp;
+}
+
+static void free_dead_spectators(void) {
+    while (dead_spectators != NULL) {
+        Spectator* sp = dead_spectators;
+        dead_spectators = sp->next_dead;
+        free(sp);
+    }
+}
+
+static void watch_output(Spectator* sp, int writable) {
+    if (sp->writable != writable) {
+        struct epoll_event ev = {.events = EPOLLIN | (writable ? EPOLLOUT : 0), .data.ptr = sp};
+        epoll_ctl(epfd, EPOLL_CTL_MOD, sp->fd, &ev);
+        sp->writable = writable;
+    }
+}
+
+/**
+ * Envoie n octets à un spectateur : directement depuis data si sa file est
+ * vide, le reste (ou tout, sinon) est copié dans sa file. Retourne -1 si le
+ * spectateur a été retiré (erreur, ou trop lent).
+ */
+static int spectator_send(Spectator* sp, const char* data, size_t n) {
+    size_t sent = 0;
+    if (sp->output.len == 0) {
+        while (sent < n) {
+            ssize_t w = send(sp->fd, data + sent, n - sent, MSG_DONTWAIT | MSG_NOSIGNAL);
+            if (w < 0 && errno == EINTR) {
+                continue;
+            }
+            if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                break;
+            }
+            if (w <= 0) {
+                remove_spectator(sp);
+                return -1;
+            }
+            sent += (size_t)w;
+        }
+        bytes_out += sent;
+        if (sent == n) {
+            return 0;
+        }
+    }
+    if (sp->output.len + n - sent > SPECTATOR_OUTPUT_LIMIT ||
+        outq_push(&sp->output, data + sent, n - sent) < 0) {
+        slow_drops++;
+        remove_spectator(sp);
+        return -1;
+    }
+    watch_output(sp, 1);
+    return 0;
+}
+
+/**
+ * Diffuse les messages du tick puis la dernière position, chaque forme
+ * construite une fois pour tous les spectateurs
+ */
+static void tick(void) {
+    if (batch_text.len == 0 && !state_dirty) {
+        return;
+    }
+    out_text.len = 0;
+    out_frames.len = 0;
+    out_delta.len = 0;
+    buf_append(&out_text, batch_text.data, batch_text.len);
+    buf_append(&out_frames, batch_frames.data, batch_frames.len);
+    buf_append(&out_delta, batch_frames.data, batch_frames.len);
+    batch_text.len = 0;
+    batch_frames.len = 0;
+    if (state_dirty) {
+        char line[OUTQ_STATE_LEN];
+        char frame[PROTO_HEADER_LEN + PROTO_DELTA_MAX_LEN];
+        buf_append(&out_text, line, (size_t)format_state(line, sizeof(line), &state));
+        buf_append(&out_frames, frame, proto_encode_state(frame, &state));
+        buf_append(&out_delta, frame, proto_encode_delta(frame, &sent_state, &state, ++sent_seq));
+        sent_state = state;
+        state_dirty = 0;
+    }
+
+    // À rebours : un spectateur retiré est remplacé par le dernier, déjà servi
+    for (int k = num_spectators - 1; k >= 0; k--) {
+        Spectator* sp = spectators[k];
+        if (!sp->registered) {
+            continue;
+        }
+        const Buffer* b = sp->delta ? &out_delta : sp->proto == 2 ? &out_frames : &out_text;
+        spectator_send(sp, b->data, b->len);
+    }
+    ticks++;
+}
+
+/**
+ * Ligne USERNAME d'un nouveau spectateur : il reçoit le message d'accueil
+ * du serveur et la dernière position diffusée (complète)
+ */
+static int register_spectator(Spectator* sp, char* line) {
+    if (strncmp(line, "USERNAME ", 9) != 0) {
+        return -1;
+    }
+    char* token;
+    while ((token = strrchr(line + 9, ' ')) != NULL) {
+        if (!strcmp(token + 1, PROTO_V2_TOKEN)) {
+            sp->proto = 2;
+        } else if (!strcmp(token + 1, PROTO_DELTA_TOKEN)) {
+            sp->delta = 1;
+        } else {
+            break;
+        }
+        *token = '\0';
+    }
+    if (line[9] == '\0') {
+        return -1;
+    }
+    if (sp->proto != 2) {
+        sp->delta = 0;
+    }
+    sp->registered = 1;
+
+    char out[PROTO_HEADER_LEN + sizeof(welcome) + PROTO_HEADER_LEN + PROTO_DELTA_MAX_LEN];
+    size_t n;
+    if (sp->proto == 2) {
+        n = proto_encode_line(welcome, strlen(welcome), out, sizeof(out));
+        if (sp->delta) {
+            n += proto_encode_delta(out + n, NULL, &sent_state, sent_seq);
+        } else {
+            n += proto_encode_state(out + n, &sent_state);
+        }
+    } else {
+        n = (size_t)snprintf(out, sizeof(out), "%s", welcome);
+        n += (size_t)format_state(out + n, sizeof(out) - n, &sent_state);
+    }
+    return spectator_send(sp, out, n);
+}
+
+static void accept_spectators(void) {
+    for (;;) {
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0) {
+            return;  // EAGAIN : plus de connexion en attente
+        }
+        Spectator* sp = calloc(1, sizeof(Spectator));
+        if (sp == NULL) {
+            close(fd);
+            continue;
+        }
+        if (num_spectators == max_spectators) {
+            int cap = max_spectators ? 2 * max_spectators : 1024;
+            Spectator** list = realloc(spectators, cap * sizeof(Spectator*));
+            if (list == NULL) {
+                free(sp);
+                close(fd);
+                continue;
+            }
+            spectators = list;
+            max_spectators = cap;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        sp->fd = fd;
+        sp->proto = 1;
+        outq_init(&sp->output);
+        sp->slot = num_spectators;
+        spectators[num_spectators++] = sp;
+        if (num_spectators > peak_audience) {
+            peak_audience = num_spectators;
+        }
+        struct epoll_event ev = {.events = EPOLLIN, .data.ptr = sp};
+        epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+        const char* hello = "REGISTER " PROTO_V2_TOKEN " " PROTO_DELTA_TOKEN "\n";
+        spectator_send(sp, hello, strlen(hello));
+    }
+}
+
+/**
+ * Lecture sur le socket d'un spectateur : la ligne USERNAME, puis plus rien
+ * d'utile (lecture seule) sinon la fermeture
+ */
+static void read_spectator(Spectator* sp) {
+    char scratch[512];
+    char* dst = sp->registered ? scratch : sp->hello + sp->hello_len;
+    size_t room = sp->registered ? sizeof(scratch) : HELLO_LEN - 1 - sp->hello_len;
+    ssize_t r = recv(sp->fd, dst, room, MSG_DONTWAIT);
+    if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+        return;
+    }
+    if (r <= 0) {
+        remove_spectator(sp);
+        return;
+    }
+    if (sp->registered) {
+        return;
+    }
+    sp->hello_len += (size_t)r;
+    sp->hello[sp->hello_len] = '\0';
+    char* newline = strchr(sp->hello, '\n');
+    if (newline == NULL) {
+        if (sp->hello_len == HELLO_LEN - 1) {
+            remove_spectator(sp);
+        }
+        return;
+    }
+    *newline = '\0';
+    if (newline > sp->hello && newline[-1] == '\r') {
+        newline[-1] = '\0';
+    }
+    if (register_spectator(sp, sp->hello) < 0 && sp->registered == 0) {
+        remove_spectator(sp);
+    }
+}
+
+/**
+ * Trame du serveur : une position remplace la précédente du tick, un
+ * message est ajouté au tick. Retourne 1 à la fin de la partie.
+ */
+static int handle_origin_frame(int op, const char* payload, size_t len) {
+    if (op == PROTO_STATE && len == PROTO_STATE_LEN) {
+        proto_decode_state(payload, &state);
+        state_dirty = 1;
+        states_in++;
+        return 0;
+    }
+    static char line[PROTO_MAX_PAYLOAD + 64];
+    static char frame[PROTO_HEADER_LEN + PROTO_MAX_PAYLOAD];
+    size_t n = proto_decode_line(op, payload, len, line, sizeof(line) - 1);
+    line[n++] = '\n';
+    if (op == PROTO_PING) {
+        send_origin("PONG\n");  // Le serveur vérifie que le relais est vivant
+        return 0;
+    }
+    if (op == PROTO_CHAT && !proto_payload_is_line(op, payload, len)) {
+        return 0;  // Texte d'un joueur : ses lignes en trop seraient forgées pour les spectateurs texte
+    }
+    if (!strncmp(line, "CHAT [Privé", 11)) {
+        return 0;  // Adressé au relais lui-même
+    }
+    int over = !strncmp(line, "END ", 4) ||
+               !strncmp(line, "MSG La partie que vous regardiez est terminée", 46);
+    if (over) {
+        tick();  // La dernière position passe avant l'annonce de la fin
+    }
+    buf_append(&batch_text, line, n);
+    buf_append(&batch_frames, frame, proto_encode_line(line, n, frame, sizeof(frame)));
+    return over;
+}
+
+/**
+ * Traite les trames reçues du serveur ; retourne 1 si la partie est finie
+ * ou la connexion perdue
+ */
+static int read_origin(void) {
+    ssize_t r = linebuf_fill(&origin_input, origin_fd, MSG_DONTWAIT);
+    if (r == 0 || (r < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+        fprintf(stderr, "Connexion au serveur perdue\n");
+        return 1;
+    }
+    static char payload[PROTO_MAX_PAYLOAD + 1];
+    int op;
+    size_t len;
+    int status;
+    while ((status = proto_next_frame(&origin_input, &op, payload, sizeof(payload), &len)) > 0) {
+        if (handle_origin_frame(op, payload, len)) {
+            return 1;
+        }
+    }
+    return status < 0;
+}
+
+/**
+ * Connexion au serveur en v2 et WATCH de la partie ; au retour, state et
+ * sent_state tiennent la position courante. Retourne -1 en cas d'échec.
+ */
+static int subscribe(const char* host, int port, int game_id) {
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_port = htons(port)};
+    if (inet_pton(AF_INET, host, &addr.sin_addr) != 1) {
+        fprintf(stderr, "Adresse invalide : %s\n", host);
+        return -1;
+    }
+    origin_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (origin_fd < 0 || connect(origin_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("connect");
+        return -1;
+    }
+    int one = 1;
+    setsockopt(origin_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    linebuf_init(&origin_input);
+
+    // Accueil en texte, puis trames dès l'envoi de USERNAME ... V2
+    char line[PROTO_MAX_PAYLOAD + 64];
+    while (!linebuf_next_line(&origin_input, line, sizeof(line))) {
+        if (linebuf_fill(&origin_input, origin_fd, 0) <= 0) {
+            fprintf(stderr, "Serveur muet\n");
+            return -1;
+        }
+    }
+    if (strncmp(line, "REGISTER", 8) != 0 || strstr(line, " " PROTO_V2_TOKEN) == NULL) {
+        fprintf(stderr, "Le serveur ne propose pas le protocole v2\n");
+        return -1;
+    }
+    char hello[64];
+    snprintf(hello, sizeof(hello), "USERNAME relay_%d " PROTO_V2_TOKEN "\n", (int)getpid());
+    send_all(origin_fd, hello, strlen(hello));
+
+    static char payload[PROTO_MAX_PAYLOAD + 1];
+    int watching = 0;
+    for (;;) {
+        int op;
+        size_t len;
+        int status = proto_next_frame(&origin_input, &op, payload, sizeof(payload), &len);
+        if (status < 0) {
+            fprintf(stderr, "Trame invalide du serveur\n");
+            return -1;
+        }
+        if (status == 0) {
+            if (linebuf_fill(&origin_input, origin_fd, 0) <= 0) {
+                fprintf(stderr, "Connexion refusée par le serveur\n");
+                return -1;
+            }
+            continue;
+        }
+        if (op == PROTO_STATE && len == PROTO_STATE_LEN) {
+            if (welcome[0] != '\0') {
+                proto_decode_state(payload, &state);
+                sent_state = state;
+                return 0;
+            }
+            continue;
+        }
+        proto_decode_line(op, payload, len, line, sizeof(line));
+        if (!watching && (!strncmp(line, "MSG Bienvenue", 13) || !strncmp(line, "MSG Bon retour", 14))) {
+            char watch[32];
+            snprintf(watch, sizeof(watch), "WATCH %d\n", game_id);
+            send_origin(watch);
+            watching = 1;
+        } else if (watching && !strncmp(line, "MSG Vous regardez", 17)) {
+            // Tronquée, la ligne perdrait son saut de ligne chez les spectateurs
+            if (snprintf(welcome, sizeof(welcome), "%s\n", line) >= (int)sizeof(welcome)) {
+                fprintf(stderr, "Réponse du serveur trop longue : %.40s...\n", line);
+                return -1;
+            }
+        } else if (watching && !strncmp(line, "MSG ", 4)) {
+            fprintf(stderr, "Abonnement refusé : %s\n", line + 4);
+            return -1;
+        }
+    }
+}
+
+static int listen_on(int port) {
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (listen_fd < 0) {
+        perror("socket");
+        return -1;
+    }
+    int one = 1;
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_port = htons(port),
+                               .sin_addr.s_addr = INADDR_ANY};
+    if (bind(listen_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(listen_fd, SOMAXCONN) < 0) {
+        perror("bind");
+        return -1;
+    }
+    fcntl(listen_fd, F_SETFL, O_NONBLOCK);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    int listen_port = DEFAULT_LISTEN_PORT;
+    int server_port = DEFAULT_SERVER_PORT;
+    int tick_ms = DEFAULT_TICK_MS;
+    const char* host = "127.0.0.1";
+    int game_id = -1;
+    int positional = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+            listen_port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            server_port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc && atoi(argv[i + 1]) >= 1) {
+            tick_ms = atoi(argv[++i]);
+        } else if (argv[i][0] != '-' && positional < 2) {
+            // Le dernier argument est la partie, l'hôte éventuel le précède
+            if (positional == 1) {
+                host = argv[i - 1];
+            }
+            game_id = atoi(argv[i]);
+            positional++;
+        } else {
+            positional = 0;
+            break;
+        }
+    }
+    if (positional == 0) {
+        fprintf(stderr, "Usage : %s [-l port_écoute] [-t tick_ms] [-p port_serveur] [hôte] partie\n", argv[0]);
+        return 2;
+    }
+
+    if (subscribe(host, server_port, game_id) < 0 || listen_on(listen_port) < 0) {
+        return 1;
+    }
+    epfd = epoll_create1(0);
+    struct epoll_event ev = {.events = EPOLLIN, .data.ptr = &listen_fd};
+    epoll_ctl(epfd, EPOLL_CTL_ADD, listen_fd, &ev);
+    ev.data.ptr = &origin_fd;
+    epoll_ctl(epfd, EPOLL_CTL_ADD, origin_fd, &ev);
+    printf("Relais de la partie %d sur le port %d (tick %d ms)\n", game_id, listen_port, tick_ms);
+    fflush(stdout);
+
+    // Trames déjà lues avec l'accueil
+    int over = 0;
+    static char payload[PROTO_MAX_PAYLOAD + 1];
+    int op;
+    size_t len;
+    while (!over && proto_next_frame(&origin_input, &op, payload, sizeof(payload), &len) > 0) {
+        over = handle_origin_frame(op, payload, len);
+    }
+
+    struct epoll_event events[MAX_EVENTS];
+    double next_tick = now_ms() + tick_ms;
+    double deadline = 0;  // Fin de partie : dernier délai pour vider les files
+    for (;;) {
+        if (over && deadline == 0) {
+            tick();
+            deadline = now_ms() + DRAIN_MS;
+        }
+        double now = now_ms();
+        if (deadline > 0) {
+            int pending = 0;
+            for (int k = 0; k < num_spectators; k++) {
+                pending |= spectators[k]->output.len > 0;
+            }
+            if (!pending || now >= deadline) {
+                break;
+            }
+        }
+        int timeout = deadline > 0 ? (int)(deadline - now) : next_tick > now ? (int)(next_tick - now) + 1 : 0;
+        int n = epoll_wait(epfd, events, MAX_EVENTS, timeout);
+        for (int k = 0; k < n; k++) {
+            void* tag = events[k].data.ptr;
+            if (tag == &listen_fd) {
+                if (!over) {
+                    accept_spectators();
+                }
+            } else if (tag == &origin_fd) {
+                if (!over && read_origin()) {
+                    over = 1;
+                    epoll_ctl(epfd, EPOLL_CTL_DEL, origin_fd, NULL);
+                }
+            } else {
+                Spectator* sp = tag;
+                if (sp->dead) {
+                    continue;
+                }
+                if (events[k].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    read_spectator(sp);
+                    continue;  // sp peut avoir été retiré
+                }
+                if (events[k].events & EPOLLOUT) {
+                    ssize_t left = outq_flush(&sp->output, sp->fd);
+                    if (left < 0) {
+                        remove_spectator(sp);
+                    } else if (left == 0) {
+                        watch_output(sp, 0);
+                    }
+                }
+            }
+        }
+        free_dead_spectators();
+        if (!over && now_ms() >= next_tick) {
+            tick();
+            next_tick += tick_ms;
+            if (next_tick < now_ms()) {
+                next_tick = now_ms() + tick_ms;
+            }
+        }
+    }
+
+    printf("Relais de la partie %d : %d spectateurs au plus, %llu positions reçues, "
+           "%llu ticks diffusés, %llu octets envoyés, %llu spectateurs trop lents\n",
+           game_id, peak_audience, states_in, ticks, bytes_out, slow_drops);
+    while (num_spectators > 0) {
+        remove_spectator(spectators[num_spectators - 1]);
+    }
+    free_dead_spectators();
+    close(origin_fd);
+    close(listen_fd);
+    return 0;
+}
@@ -0,0 +1,206 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+#include "../../include/analysis.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define QUEUE_SIZE 64
+
+// Limites de recherche par type de demande
+static const int KIND_DEPTH[ANALYSIS_KINDS] = {12, 24};
+static const int KIND_TIME_MS[ANALYSIS_KINDS] = {200, 1000};
+
+struct AnalysisCacheEntry {
+    uint64_t key;
+    AnalysisKind kind;
+    AnalysisResult result;
+    int next_in_bucket;
+    int prev;              // Liste LRU
+    int next;
+};
+
+// File des tâches en attente, partagée entre la boucle et les threads
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    AnalysisJob* jobs[QUEUE_SIZE];
+    int head;
+    int count;
+} queue = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, {0}, 0, 0};
+
+static int notify;
+static AnalysisConfig shared;
+
+static void* worker_main(void* arg) {
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&queue.lock);
+        while (queue.count == 0) {
+            pthread_cond_wait(&queue.ready, &queue.lock);
+        }
+        AnalysisJob* job = queue.jobs[queue.head];
+        queue.head = (queue.head + 1) % QUEUE_SIZE;
+        queue.count--;
+        pthread_mutex_unlock(&queue.lock);
+
+        EngineLimits limits = {KIND_DEPTH[job->kind], KIND_TIME_MS[job->kind], NULL,
+                               shared.tt, 1, shared.egdb, NULL};
+        EngineResult result;
+        engine_search(&job->state, &limits, &result);
+        job->result.pit = result.pit;
+        job->result.score = result.score;
+        job->result.depth = result.depth;
+        job->result.nodes = result.nodes;
+        job->result.time_ms = result.time_ms;
+
+        // Un pointeur fait moins de PIPE_BUF octets : l'écriture est atomique
+        if (write(notify, &job, sizeof(job)) != sizeof(job)) {
+            free(job);
+        }
+    }
+    return NULL;
+}
+
+int analysis_start(int workers, int notify_fd, const AnalysisConfig* config) {
+    notify = notify_fd;
+    shared = *config;
+    int started = 0;
+    for (int i = 0; i < workers; i++) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, worker_main, NULL) == 0) {
+            pthread_detach(thread);
+            started++;
+        }
+    }
+    return started > 0 ? 0 : -1;
+}
+
+int analysis_submit(AnalysisJob* job) {
+    pthread_mutex_lock(&queue.lock);
+    if (queue.count == QUEUE_SIZE) {
+        pthread_mutex_unlock(&queue.lock);
+        return -1;
+    }
+    queue.jobs[(queue.head + queue.count) % QUEUE_SIZE] = job;
+    queue.count++;
+    pthread_cond_signal(&queue.ready);
+    pthread_mutex_unlock(&queue.lock);
+    return 0;
+}
+
+int analysis_cache_init(AnalysisCache* cache, int capacity) {
+    memset(cache, 0, sizeof(*cache));
+    cache->num_buckets = 1;
+    while (cache->num_buckets < capacity) {
+        cache->num_buckets *= 2;
+    }
+    cache->entries = calloc(capacity, sizeof(AnalysisCacheEntry));
+    cache->buckets = malloc(cache->num_buckets * sizeof(int));
+    if (cache->entries == NULL || cache->buckets == NULL) {
+        free(cache->entries);
+        free(cache->buckets);
+        return -1;
+    }
+    for (int i = 0; i < cache->num_buckets; i++) {
+        cache->buckets[i] = -1;
+    }
+    cache->capacity = capacity;
+    cache->head = -1;
+    cache->tail = -1;
+    return 0;
+}
+
+static int bucket_of(const AnalysisCache* cache, uint64_t key, AnalysisKind kind) {
+    return (int)((key ^ (uint64_t)kind * 0x9E3779B97F4A7C15ull) & (cache->num_buckets - 1));
+}
+
+static void unlink_entry(AnalysisCache* cache, int i) {
+    AnalysisCacheEntry* e = &cache->entries[i];
+    if (e->prev >= 0) {
+        cache->entries[e->prev].next = e->next;
+    } else {
+        cache->head = e->next;
+    }
+    if (e->next >= 0) {
+        cache->entries[e->next].prev = e->prev;
+    } else {
+        cache->tail = e->prev;
+    }
+}
+
+static void push_front(AnalysisCache* cache, int i) {
+    AnalysisCacheEntry* e = &cache->entries[i];
+    e->prev = -1;
+    e->next = cache->head;
+    if (cache->head >= 0) {
+        cache->entries[cache->head].prev = i;
+    }
+    cache->head = i;
+    if (cache->tail < 0) {
+        cache->tail = i;
+    }
+}
+
+static int find(const AnalysisCache* cache, uint64_t key, AnalysisKind kind) {
+    for (int i = cache->buckets[bucket_of(cache, key, kind)]; i >= 0;
+         i = cache->entries[i].next_in_bucket) {
+        if (cache->entries[i].key == key && cache->entries[i].kind == kind) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int analysis_cache_get(AnalysisCache* cache, uint64_t key, AnalysisKind kind, AnalysisResult* result) {
+    int i = find(cache, key, kind);
+    if (i < 0) {
+        cache->misses++;
+        return 0;
+    }
+    unlink_entry(cache, i);
+    push_front(cache, i);
+    *result = cache->entries[i].result;
+    cache->hits++;
+    return 1;
+}
+
+void analysis_cache_put(AnalysisCache* cache, uint64_t key, AnalysisKind kind, const AnalysisResult* result) {
+    int i = find(cache, key, kind);
+    int present = i >= 0;
+    if (present) {
+        unlink_entry(cache, i);
+    } else if (cache->used < cache->capacity) {
+        i = cache->used++;
+    } else {
+        // Évincer la moins récemment utilisée et la retirer de sa chaîne
+        i = cache->tail;
+        unlink_entry(cache, i);
+        AnalysisCacheEntry* old = &cache->entries[i];
+        int* link = &cache->buckets[bucket_of(cache, old->key, old->kind)];
+        while (*link != i) {
+            link = &cache->entries[*link].next_in_bucket;
+        }
+        *link = old->next_in_bucket;
+    }
+
+    AnalysisCacheEntry* e = &cache->entries[i];
+    if (!present) {
+        int b = bucket_of(cache, key, kind);
+        e->next_in_bucket = cache->buckets[b];
+        cache->buckets[b] = i;
+    }
+    e->key = key;
+    e->kind = kind;
+    e->result = *result;
+    push_front(cache, i);
+}
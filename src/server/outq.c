@@ -0,0 +1,108 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+#include "../../include/outq.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#define OUTQ_MIN_CAP 1024
+
+void outq_init(OutputQueue* q) {
+    memset(q, 0, sizeof(*q));
+}
+
+void outq_free(OutputQueue* q) {
+    free(q->data);
+    free(q->sending);
+    outq_init(q);
+}
+
+int outq_push(OutputQueue* q, const char* s, size_t n) {
+    if (q->head + q->len + n > q->cap) {
+        // Les octets déjà envoyés sont récupérés avant d'agrandir
+        if (q->head > 0) {
+            memmove(q->data, q->data + q->head, q->len);
+            q->head = 0;
+        }
+        if (q->len + n > q->cap) {
+            size_t cap = q->cap ? q->cap : OUTQ_MIN_CAP;
+            while (cap < q->len + n) {
+                cap *= 2;
+            }
+            char* data = realloc(q->data, cap);
+            if (data == NULL) {
+                return -1;
+            }
+            q->data = data;
+            q->cap = cap;
+        }
+    }
+    memcpy(q->data + q->head + q->len, s, n);
+    q->len += n;
+    q->queued += n;
+    return 0;
+}
+
+ssize_t outq_flush(OutputQueue* q, int fd) {
+    while (q->len > 0) {
+        ssize_t w = send(fd, q->data + q->head, q->len, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (w < 0 && errno == EINTR) {
+            continue;
+        }
+        if (w < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        if (w < 0) {
+            q->dropped += q->len;
+            q->len = 0;
+            q->head = 0;
+            return -1;
+        }
+        q->head += (size_t)w;
+        q->len -= (size_t)w;
+    }
+    if (q->len == 0) {
+        q->head = 0;
+    }
+    return (ssize_t)q->len;
+}
+
+size_t outq_take(OutputQueue* q) {
+    if (q->inflight > 0 || q->len == 0) {
+        return 0;
+    }
+    // Les deux tampons échangent leurs rôles : pas d'allocation en régime établi
+    char* spare = q->sending;
+    size_t spare_cap = q->sending_cap;
+    q->sending = q->data;
+    q->sending_cap = q->cap;
+    q->sending_head = q->head;
+    q->inflight = q->len;
+    q->data = spare;
+    q->cap = spare_cap;
+    q->head = 0;
+    q->len = 0;
+    return q->inflight;
+}
+
+const char* outq_sending(const OutputQueue* q) {
+    return q->sending + q->sending_head;
+}
+
+size_t outq_sent(OutputQueue* q, size_t n) {
+    if (n > q->inflight) {
+        n = q->inflight;
+    }
+    q->sending_head += n;
+    q->inflight -= n;
+    return q->inflight;
+}
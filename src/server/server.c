@@ -8,20 +8,62 @@
 *************************************************************************/
 
 #include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <netinet/in.h>
-#include <sys/select.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
 #include <unistd.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <time.h>
+#ifdef USE_SELECT
+#include <sys/select.h>
+#else
+#include <sys/epoll.h>
+#endif
 
+#include "../../include/analysis.h"
+#include "../../include/egdb.h"
+#include "../../include/engine.h"
 #include "../../include/game.h"
 #include "../../include/net.h"
+#include "../../include/proto.h"
+#ifndef USE_SELECT
+#include "../../include/uring.h"
+#endif
 
 #define PORT 4321
 #define MAX_MOVES 200
 
+// Bots : utilisateurs réservés bot-1 à bot-9 (profondeur 2 x niveau)
+#define BOT_PREFIX "bot-"
+#define BOT_MAX_LEVEL 9
+#define BOT_MOVE_TIME_MS 1000  // Budget de réflexion par coup
+#define BOT_TT_MB 64           // Table de transposition partagée par tous les bots
+#define EGDB_PATH "bin/awale.egdb"  // Base de finales (make egdb), facultative
+#define BOOK_PATH "bin/awale.book"  // Livre d'ouvertures (make book), facultatif
+#define ANALYSIS_WORKERS 2     // Threads du service d'analyse (HINT, ANALYZE)
+#define ANALYSIS_CACHE_SIZE 4096  // Résultats gardés (LRU)
+#define MAX_EVENTS 64          // Événements epoll traités par réveil
+#define MAX_REACTORS 16        // Threads réseau au plus (option -r)
+#define GAMES_PER_SHARD (MAX_CLIENTS / 2)  // Parties qu'un réacteur peut héberger
+#define MAX_GAMES (MAX_REACTORS * GAMES_PER_SHARD)
+#define URING_ENTRIES 256      // Anneau io_uring d'un réacteur (option -u)
+#define URING_BUFFERS 64       // Tampons de réception fournis au noyau (puissance de 2)
+#define URING_BUFFER_SIZE 4096
+#define OUTPUT_HIGH_WATER_KB 64  // File d'envoi au-delà de laquelle un client est lent (option -w)
+#define OUTPUT_LIMIT_FACTOR 4    // File maximale, en multiples du seuil : au-delà, déconnexion
+#define DRAW_TIMEOUT_S 30      // Délai de réponse à une proposition d'égalité
+#define CHALLENGE_TIMEOUT_S 60 // Délai de réponse à un défi
+#define SAVE_TIMEOUT_S 60      // Délai de réponse à ASKSAVE (vaut NO)
+#define REGISTER_TIMEOUT_S 30  // Délai pour envoyer USERNAME après la connexion
+#define IDLE_TIMEOUT_S 1800    // Salon sans aucune commande : déconnexion
+#define HEARTBEAT_S 30         // Silence après lequel le serveur envoie PING (option -k)
+#define PONG_TIMEOUT_S 10      // Sans réponse au PING : connexion morte, déconnexion
+#define TIMER_TICK_MS 100      // Résolution de la roue de timers
+
 // Structure pour un coup joué
 typedef struct {
     int player;      // 0 ou 1
@@ -32,11 +74,10 @@ typedef struct {
 // Structure pour une partie en cours
 typedef struct {
     int client_indices[2];  // Indices des deux joueurs
-    int spectator_indices[MAX_SPECTATORS];  // Indices des spectateurs
+    int* spectator_indices;  // Indices des spectateurs, agrandi à la demande (au plus MAX_CLIENTS)
     int num_spectators;
-    char board[12];
-    char scores[2];
-    char current_player;
+    int max_spectators;      // Taille allouée de spectator_indices
+    AwaleState state;  // Plateau, scores et joueur au trait
     char active;
     int private_mode;  // 1 si mode privé activé (un des joueurs l'a activé)
     char player_names[2][MAX_USERNAME_LEN];  // Noms des joueurs
@@ -46,12 +87,142 @@ typedef struct {
     int ending;  // 1 si la partie est en train de se terminer (attente de sauvegarde)
     char end_result[128];  // Résultat de la partie (pour la sauvegarde)
     int responses_received;  // Nombre de réponses reçues pour la sauvegarde
+    int save_requested;      // Un joueur a répondu YES (il a pu changer de shard depuis)
+    unsigned serial;  // Numéro unique de la partie (invalide les recherches d'une partie terminée)
+    AwaleState sent_state;  // Dernière position diffusée, base des STATE_DELTA
+    unsigned state_seq;     // Numéro de sent_state (un par diffusion)
+    int draw_offer_by;  // Joueur (0 ou 1) qui propose l'égalité, -1 si aucune proposition
+    Timer draw_timer;   // Fin du délai de réponse à la proposition
 } Game;
 
+// Recherche d'un bot, exécutée hors de la boucle select par un thread
+// qui renvoie la tâche terminée par bot_pipe
+typedef struct {
+    int game_idx;
+    unsigned serial;  // Partie pour laquelle le coup a été cherché
+    AwaleState state;
+    int level;
+    int pit;          // Résultat
+} BotJob;
+
+// Courrier entre shards : une opération sur un client ou une partie dont un
+// autre shard a la charge, exécutée par ce shard dans sa boucle comme les
+// commandes de ses propres clients
+enum {
+    MAIL_ADOPT,              // to arrive d'un autre shard ; text : commande à rejouer
+    MAIL_DELIVER,            // text à envoyer à to
+    MAIL_CHALLENGE,          // from défie to ; text : nom de from
+    MAIL_PRIVATE_CHAT,       // Ligne CHAT (text) de from pour to
+    MAIL_CHAT_ALL,           // Ligne CHAT (text) pour tout le salon, sauf from
+    MAIL_CANCEL_CHALLENGES,  // from s'est déconnecté, ses défis tombent ; text : son nom
+    MAIL_WHOIS,              // Bio de to, à renvoyer à from
+    MAIL_FRIEND_REQUEST,     // from demande to en ami ; text : nom de from
+    MAIL_FRIEND_ACCEPTED,    // from a accepté la demande de to ; text : nom de from
+    MAIL_GATHER,             // Part d'une réponse à LIST ou GAMES (data : Gather)
+    MAIL_BOT,                // Coup cherché pour un bot (data : BotJob)
+    MAIL_ANALYSIS            // Analyse terminée pour to (data : AnalysisJob)
+};
+
+typedef struct Mail {
+    struct Mail* next;
+    int kind;
+    int to;                  // Client visé, -1 si le courrier ne vise pas un client
+    unsigned session;        // Sa connexion, 0 pour n'importe laquelle
+    int from;                // Client à l'origine (réponses), -1 si aucun
+    unsigned from_session;
+    void* data;
+    char text[];
+} Mail;
+
+// Réacteur, ou shard : un thread réseau avec son epoll, son socket d'écoute
+// (SO_REUSEPORT, le noyau répartit les connexions), ses clients, ses parties
+// (GAMES_PER_SHARD emplacements à partir de id * GAMES_PER_SHARD) et sa roue
+// de timers. Seul son thread touche à ce qu'il a en charge, sans verrou.
+// Une partie ne réunit que des clients de son shard : celui qui accepte le
+// défi d'un client d'un autre shard, ou veut regarder une partie d'un autre
+// shard, y est d'abord transféré (MAIL_ADOPT), puis sa commande y est
+// rejouée. Le reste (défis, CHAT privé ou global, LIST, GAMES, amis...)
+// passe par la boîte aux lettres du shard visé, réveillé par son pipe à la
+// fin du tour de l'émetteur.
+typedef struct {
+    int id;
+    pthread_t thread;
+    int listen_fd;
+    int epoll_fd;               // Inutilisé avec le backend select
+    int wake_pipe[2];
+    pthread_mutex_t lock;       // Protège la boîte aux lettres
+    Mail* mailbox;              // Courrier reçu, dans l'ordre d'arrivée
+    Mail** mailbox_tail;
+    unsigned wakes;             // Shards à réveiller à la fin du tour (bits)
+    int retry_accept;           // Un emplacement s'est libéré ailleurs : relancer accept (atomique)
+    char owns[MAX_CLIENTS];     // Clients dont il a la charge
+    Mail* moving[MAX_CLIENTS];  // Transferts io_uring en attente (fin du recv et de l'envoi)
+    int to_flush[MAX_CLIENTS];  // Clients dont la file attend d'être envoyée
+    int num_to_flush;
+    int num_closed;             // Emplacements fermés pas encore libérés
+    TimerWheel timers;          // Échéances de ses clients et de ses parties
+#ifndef USE_SELECT
+    Uring* ring;                // Anneau io_uring (option -u), NULL avec epoll
+#endif
+} Reactor;
+
+// Annuaire des emplacements de clients, partagé par les shards sous
+// directory_lock : de quoi trouver un client par son nom et le shard qui
+// l'a en charge, pour lui adresser du courrier
+typedef struct {
+    char username[MAX_USERNAME_LEN];  // Compte inscrit sur l'emplacement, vide sinon
+    int shard;                        // -1 : emplacement libéré, pour n'importe quel shard
+    unsigned session;                 // Connexion en cours, ou la dernière
+    int online;                       // Socket ouvert
+} DirectoryEntry;
+
+// Ligne d'une réponse à LIST ou GAMES
+typedef struct {
+    char names[2][MAX_USERNAME_LEN];  // Client (LIST) ou joueurs de la partie (GAMES)
+    int value;                         // ELO (LIST) ou numéro de la partie (GAMES)
+} GatherEntry;
+
+// Réponse à LIST ou GAMES : chaque shard y ajoute ses clients ou ses
+// parties, le dernier à le faire l'envoie au demandeur
+typedef struct {
+    int games;                  // 1 : GAMES, 0 : LIST
+    int requester;
+    unsigned session;
+    pthread_mutex_t lock;
+    int remaining;              // Shards qui n'ont pas encore répondu
+    int count;
+    GatherEntry entries[MAX_GAMES];  // MAX_GAMES > MAX_CLIENTS
+} Gather;
+
+// Nature d'un timer de la roue ; idx est l'index du client ou de la partie
+enum { TIMER_CLIENT, TIMER_CHALLENGE, TIMER_SAVE, TIMER_DRAW };
+
+// Source d'une complétion io_uring : type dans les 32 bits hauts de
+// user_data, index du client dans les 32 bits bas
+enum { URING_ACCEPT = 1, URING_WAKE, URING_BOT, URING_ANALYSIS, URING_RECV, URING_SEND, URING_CANCEL };
+#define URING_DATA(kind, idx) (((uint64_t)(kind) << 32) | (uint32_t)(idx))
+
 // Variables globales
 Client clients[MAX_CLIENTS];
-Game games[MAX_CLIENTS / 2];
-int num_clients = 0;
+Game games[MAX_GAMES];
+int num_clients = 0;  // Emplacements déjà servis (directory_lock)
+static DirectoryEntry directory[MAX_CLIENTS];
+static pthread_mutex_t directory_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned stalled_accepts = 0;  // Réacteurs qui attendent un emplacement pour accepter (bits, directory_lock)
+static unsigned next_game_serial = 0;
+static int bot_pipe[2] = {-1, -1};
+static TranspositionTable bot_tt;
+static int bot_threads = 1;  // Threads par recherche (option -t)
+static EndgameDB egdb;       // Base de finales (arbitrage et bots), vide si absente
+static OpeningBook book;     // Livre d'ouvertures (bots et HINT), vide si absent
+static int analysis_pipe[2] = {-1, -1};
+static AnalysisCache analysis_cache;
+static pthread_mutex_t analysis_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+static size_t output_high_water = OUTPUT_HIGH_WATER_KB * 1024;
+static Reactor reactors[MAX_REACTORS];
+static int heartbeat_s = HEARTBEAT_S;         // Option -k, 0 : pas de PING
+static int num_reactors = 1;                  // Option -r
+static __thread Reactor* current_reactor;     // Réacteur du thread courant
 
 /**
  * Valider un nom d'utilisateur
@@ -66,6 +237,10 @@ static int is_valid_username(const char* username) {
         return 0;  // Trop long
     }
     
+    if (!strncmp(username, BOT_PREFIX, strlen(BOT_PREFIX))) {
+        return 0;  // Réservé aux bots
+    }
+    
     // Vérifier que tous les caractères sont alphanumériques, _ ou -
     for (const char* p = username; *p; p++) {
         if (!((*p >= 'a' && *p <= 'z') || 
@@ -80,46 +255,548 @@ static int is_valid_username(const char* username) {
 }
 
 /**
- * Reçoit une ligne depuis un socket
+ * Inscrit un descripteur auprès d'epoll, en edge-triggered : data identifie
+ * la source de l'événement (sans effet avec le backend select). EPOLLOUT
+ * signale qu'un socket plein redevient inscriptible.
+ */
+static int watch_fd(Reactor* r, int fd, void* data) {
+#ifdef USE_SELECT
+    (void)r;
+    (void)fd;
+    (void)data;
+    return 0;
+#else
+    struct epoll_event ev;
+    ev.events = EPOLLIN | EPOLLOUT | EPOLLET;
+    ev.data.ptr = data;
+    return epoll_ctl(r->epoll_fd, EPOLL_CTL_ADD, fd, &ev);
+#endif
+}
+
+/**
+ * Passe un descripteur en non bloquant
+ */
+static int set_nonblocking(int fd) {
+    int flags = fcntl(fd, F_GETFL);
+    return flags < 0 ? -1 : fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+/**
+ * Vrai si le shard du thread courant a le client en charge
+ */
+static int owned(int idx) {
+    return current_reactor->owns[idx];
+}
+
+/**
+ * Trouve l'index d'un client du shard courant par son socket
+ */
+static int find_client_by_socket(int fd) {
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (owned(i) && clients[i].socket_fd == fd) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * Envoie ce qui attend dans la file d'un client ; une fois la file repassée
+ * sous le seuil, le dernier STATE retenu pendant la congestion suit.
+ * Appelée par le réacteur du client.
+ */
+static void flush_queue(Client* c) {
+    if (c->socket_fd <= 0) {
+        return;
+    }
+#ifndef USE_SELECT
+    Reactor* r = &reactors[c->reactor];
+    if (r->ring != NULL) {
+        // Un seul envoi en cours par client : sa complétion lance le suivant.
+        // Pendant un transfert, la file attend le nouveau shard.
+        if (r->moving[c - clients] == NULL && outq_take(&c->output) > 0) {
+            uring_send(r->ring, c->socket_fd, outq_sending(&c->output), c->output.inflight,
+                       URING_DATA(URING_SEND, c - clients));
+        }
+        return;
+    }
+#endif
+    ssize_t left = outq_flush(&c->output, c->socket_fd);
+    if (left >= 0 && (size_t)left < output_high_water && c->output.pending_state_len > 0) {
+        outq_push(&c->output, c->output.pending_state, c->output.pending_state_len);
+        c->output.pending_state_len = 0;
+        outq_flush(&c->output, c->socket_fd);
+    }
+}
+
+static void flush_client(int idx) {
+    flush_queue(&clients[idx]);
+}
+
+static void wake_reactor(Reactor* r) {
+    char c = 0;
+    if (write(r->wake_pipe[1], &c, 1) < 0) {
+        // Pipe plein : un réveil est déjà en attente
+    }
+}
+
+/**
+ * Demande au réacteur du client (le shard courant : seul lui écrit à ses
+ * clients) d'envoyer sa file à la fin du tour
+ */
+static void schedule_flush(int idx) {
+    Reactor* r = &reactors[clients[idx].reactor];
+    if (!clients[idx].flush_queued) {
+        clients[idx].flush_queued = 1;
+        r->to_flush[r->num_to_flush++] = idx;
+    }
+}
+
+/**
+ * Retire un client de la liste des files à envoyer (il quitte le shard)
+ */
+static void unschedule_flush(Reactor* r, int idx) {
+    for (int k = 0; clients[idx].flush_queued && k < r->num_to_flush; k++) {
+        if (r->to_flush[k] == idx) {
+            r->to_flush[k] = r->to_flush[--r->num_to_flush];
+            clients[idx].flush_queued = 0;
+        }
+    }
+}
+
+/**
+ * Fin d'un tour de boucle du réacteur : réveille les shards à qui il a
+ * écrit (réveillés plus tôt, ils traiteraient le premier courrier pendant
+ * que ce tour produit encore les suivants), puis envoie les files de ses
+ * clients, chacune en un seul send
  */
-static int recv_line(int fd, char *buf, size_t cap) {
-    size_t n = 0;
-    char ch;
+static void flush_scheduled(Reactor* r) {
+    for (int k = 0; r->wakes != 0; k++) {
+        if (r->wakes & (1u << k)) {
+            r->wakes &= ~(1u << k);
+            wake_reactor(&reactors[k]);
+        }
+    }
     
-    while (n + 1 < cap) {
-        ssize_t r = recv(fd, &ch, 1, 0);
-        if (r <= 0) {
-            return -1;
+    for (int k = 0; k < r->num_to_flush; k++) {
+        clients[r->to_flush[k]].flush_queued = 0;
+        flush_client(r->to_flush[k]);
+    }
+    r->num_to_flush = 0;
+}
+
+static void handle_mail(Mail* m);
+
+/**
+ * Prépare un courrier pour le client to ; text est copié
+ */
+static Mail* new_mail(int kind, int to, unsigned session, const char* text) {
+    size_t n = strlen(text) + 1;
+    Mail* m = malloc(sizeof(*m) + n);
+    if (m == NULL) {
+        return NULL;
+    }
+    m->next = NULL;
+    m->kind = kind;
+    m->to = to;
+    m->session = session;
+    m->from = -1;
+    m->from_session = 0;
+    m->data = NULL;
+    memcpy(m->text, text, n);
+    return m;
+}
+
+static void free_mail(Mail* m) {
+    if (m->kind == MAIL_BOT || m->kind == MAIL_ANALYSIS) {
+        free(m->data);
+    }
+    free(m);
+}
+
+/**
+ * Dépose un courrier dans la boîte du shard r, réveillé à la fin du tour
+ */
+static void post_mail(Reactor* r, Mail* m) {
+    m->next = NULL;
+    pthread_mutex_lock(&r->lock);
+    *r->mailbox_tail = m;
+    r->mailbox_tail = &m->next;
+    pthread_mutex_unlock(&r->lock);
+    current_reactor->wakes |= 1u << r->id;
+}
+
+/**
+ * Achemine un courrier vers le shard qui a son destinataire en charge :
+ * traité tout de suite si c'est le shard courant, perdu si le client s'est
+ * déconnecté ou, session donnée, si l'emplacement a changé de connexion.
+ * L'annuaire reste verrouillé pendant le dépôt : un transfert (MAIL_ADOPT)
+ * arrive toujours avant le courrier qui le suit.
+ */
+static void route_mail(Mail* m) {
+    if (m == NULL) {
+        return;
+    }
+    if (owned(m->to)) {
+        handle_mail(m);
+        return;
+    }
+    pthread_mutex_lock(&directory_lock);
+    DirectoryEntry* e = &directory[m->to];
+    if (e->online && e->shard != current_reactor->id && (m->session == 0 || e->session == m->session)) {
+        post_mail(&reactors[e->shard], m);
+        m = NULL;
+    }
+    pthread_mutex_unlock(&directory_lock);
+    if (m != NULL) {
+        free_mail(m);
+    }
+}
+
+/**
+ * Envoie une ligne à un client de n'importe quel shard
+ */
+static void deliver(int to, unsigned session, const char* text) {
+    route_mail(new_mail(MAIL_DELIVER, to, session, text));
+}
+
+/**
+ * Envoie au client to un courrier de la part du client from du shard courant
+ */
+static void send_mail(int kind, int to, unsigned session, int from, const char* text) {
+    Mail* m = new_mail(kind, to, session, text);
+    if (m != NULL) {
+        m->from = from;
+        m->from_session = clients[from].session;
+        route_mail(m);
+    }
+}
+
+/**
+ * Envoie un courrier sans destinataire à chaque shard (le courant le
+ * traite tout de suite) ; data est partagé entre les copies
+ */
+static void broadcast_mail(int kind, int from, const char* text, void* data) {
+    for (int k = 0; k < num_reactors; k++) {
+        Mail* m = new_mail(kind, -1, 0, text);
+        if (m == NULL) {
+            continue;
         }
-        
-        if (ch == '\n') {
-            buf[n] = 0;
-            return (int)n;
+        m->from = from;
+        m->from_session = clients[from].session;
+        m->data = data;
+        if (k == current_reactor->id) {
+            handle_mail(m);
+        } else {
+            post_mail(&reactors[k], m);
         }
-        
-        buf[n++] = ch;
+    }
+}
+
+/**
+ * Trouve un client connecté par son username dans l'annuaire ; son entrée
+ * (shard, session) est copiée dans *entry. Retourne son index, -1 si aucun.
+ */
+static int lookup_user(const char* username, DirectoryEntry* entry) {
+    int idx = -1;
+    pthread_mutex_lock(&directory_lock);
+    for (int i = 0; i < num_clients; i++) {
+        if (directory[i].online && strcmp(directory[i].username, username) == 0) {
+            idx = i;
+            *entry = directory[i];
+            break;
+        }
+    }
+    pthread_mutex_unlock(&directory_lock);
+    return idx;
+}
+
+/**
+ * Copie le username d'un client de n'importe quel shard
+ */
+static void get_username(int idx, char* name) {
+    pthread_mutex_lock(&directory_lock);
+    strcpy(name, directory[idx].username);
+    pthread_mutex_unlock(&directory_lock);
+}
+
+// Nature d'une ligne mise en file, pour la politique de congestion
+enum { OUT_OTHER, OUT_STATE, OUT_MESSAGE };
+
+/**
+ * Met une ligne (ou sa trame v2) dans la file d'un client. Au-delà de output_high_water, les STATE d'un client lent
+ * sont fusionnés : seul le dernier est gardé, et les MSG et CHAT
+ * (OUT_MESSAGE) peuvent le doubler. Si la file dépasse OUTPUT_LIMIT_FACTOR
+ * fois ce seuil, le client est déconnecté.
+ * Retourne 1 si la file était vide et doit être envoyée.
+ */
+static int enqueue_line(int idx, const char* s, size_t n, int kind) {
+    OutputQueue* q = &clients[idx].output;
+    if (q->closed) {
+        q->dropped += n;
+        return 0;
+    }
+    
+    size_t backlog = q->len + q->inflight;
+    if (backlog >= output_high_water && kind == OUT_STATE && n <= OUTQ_STATE_LEN) {
+        q->dropped += q->pending_state_len;
+        memcpy(q->pending_state, s, n);
+        q->pending_state_len = n;
+        return 0;
+    }
+    if (backlog + n > OUTPUT_LIMIT_FACTOR * output_high_water) {
+        // La lecture verra la connexion fermée et fera la déconnexion habituelle
+        q->dropped += n;
+        q->closed = 1;
+        shutdown(clients[idx].socket_fd, SHUT_RDWR);
+        printf("Client %s trop lent : %zu octets en attente, déconnexion\n",
+               clients[idx].username[0] ? clients[idx].username : "(sans nom)", backlog);
+        return 0;
     }
     
-    buf[n] = 0;
-    return (int)n;
+    // Un STATE retenu passe avant toute autre ligne (END, ROLE...), pour
+    // que le client l'applique avant elle
+    int was_empty = q->len == 0;
+    if (q->pending_state_len > 0 && kind != OUT_MESSAGE) {
+        outq_push(q, q->pending_state, q->pending_state_len);
+        q->pending_state_len = 0;
+    }
+    if (outq_push(q, s, n) < 0) {
+        q->dropped += n;
+        return 0;
+    }
+    // Si la file n'était pas vide, le socket est plein : EPOLLOUT la videra
+    return was_empty;
+}
+
+static void enqueue_and_schedule(int idx, const char* s, size_t n, int kind) {
+    if (enqueue_line(idx, s, n, kind)) {
+        schedule_flush(idx);
+    }
+}
+
+/**
+ * Ligne à envoyer à un ou plusieurs clients : sa nature et sa longueur sont
+ * calculées une fois, sa trame v2 construite au premier client v2. Chaque
+ * destinataire ne coûte plus que la copie dans sa file.
+ */
+typedef struct {
+    const char* line;
+    size_t len;
+    int kind;
+    char frame[PROTO_HEADER_LEN + PROTO_MAX_PAYLOAD];
+    size_t frame_len;  // 0 tant que la trame n'est pas construite
+} Message;
+
+static void message_init(Message* m, const char* line) {
+    m->line = line;
+    m->len = strlen(line);
+    m->kind = OUT_OTHER;
+    if (!strncmp(line, "STATE ", 6)) {
+        m->kind = OUT_STATE;
+    } else if (!strncmp(line, "MSG ", 4) || !strncmp(line, "CHAT ", 5)) {
+        m->kind = OUT_MESSAGE;
+    }
+    m->frame_len = 0;
+}
+
+/**
+ * Met un message dans la file du client idx ; celle d'un client d'un autre
+ * shard n'est touchée que par lui, le message lui est remis par courrier.
+ * Les sockets des clients sont non bloquants : la ligne attend dans la file
+ * du client, envoyée par son réacteur à la fin du tour de boucle. Un client
+ * v2 la reçoit en une seule trame, sauts de ligne compris.
+ */
+static void send_message(Message* m, int idx) {
+    if (idx >= 0 && !owned(idx)) {
+        deliver(idx, 0, m->line);  // Ancien joueur passé à un autre shard
+        return;
+    }
+    if (idx < 0 || clients[idx].socket_fd <= 0) {
+        return;  // Bot ou client déconnecté
+    }
+    if (clients[idx].proto == 2) {
+        if (m->frame_len == 0) {
+            m->frame_len = proto_encode_line(m->line, m->len, m->frame, sizeof(m->frame));
+        }
+        enqueue_and_schedule(idx, m->frame, m->frame_len, m->kind);
+    } else {
+        enqueue_and_schedule(idx, m->line, m->len, m->kind);
+    }
+}
+
+// Destinataires de broadcast_message dans une partie
+enum { TO_PLAYERS = 1, TO_SPECTATORS = 2 };
+
+/**
+ * Envoie un message aux joueurs et/ou aux spectateurs d'une partie, sauf au
+ * client except (-1 : personne). Les listes d'indices de la partie servent
+ * directement, sans recherche de socket par destinataire.
+ */
+static void broadcast_message(Game* g, Message* m, int to, int except) {
+    if (to & TO_PLAYERS) {
+        for (int i = 0; i < 2; i++) {
+            if (g->client_indices[i] != except) {
+                send_message(m, g->client_indices[i]);
+            }
+        }
+    }
+    if (to & TO_SPECTATORS) {
+        for (int i = 0; i < g->num_spectators; i++) {
+            if (g->spectator_indices[i] != except) {
+                send_message(m, g->spectator_indices[i]);
+            }
+        }
+    }
+}
+
+static void broadcast_line(Game* g, const char* line, int to, int except) {
+    Message m;
+    message_init(&m, line);
+    broadcast_message(g, &m, to, except);
 }
 
 /**
- * Envoie une ligne vers un socket
+ * Envoie une ligne vers le socket d'un client du shard courant (un client
+ * d'un autre shard la reçoit par deliver)
  */
 static void send_line(int fd, const char* s) {
-    send(fd, s, strlen(s), 0);
+    if (fd < 0) {
+        return;  // Bot ou client déconnecté
+    }
+    int idx = find_client_by_socket(fd);
+    if (idx < 0) {
+        return;
+    }
+    Message m;
+    message_init(&m, s);
+    send_message(&m, idx);
+}
+
+/**
+ * Position à diffuser : chaque forme (ligne STATE, trame v2, delta, position
+ * complète des clients DELTA) n'est construite qu'une fois, au premier
+ * client qui l'utilise
+ */
+typedef struct {
+    const AwaleState* state;
+    const AwaleState* previous;  // Position de numéro seq - 1, NULL si pas de delta possible
+    unsigned game;               // serial de la partie
+    unsigned seq;
+    char line[OUTQ_STATE_LEN];
+    size_t line_len;
+    char frame[PROTO_HEADER_LEN + PROTO_STATE_LEN];
+    size_t frame_len;
+    char delta[PROTO_HEADER_LEN + PROTO_DELTA_MAX_LEN];
+    size_t delta_len;
+    char full[PROTO_HEADER_LEN + PROTO_DELTA_MAX_LEN];
+    size_t full_len;
+} StateUpdate;
+
+/**
+ * Position pour un client DELTA : le delta seulement s'il a reçu la
+ * position précédente de cette partie. En congestion les STATE en file sont
+ * fusionnés, ce qui ferait un trou : on met alors une position complète.
+ */
+static void send_state_delta(StateUpdate* u, int idx) {
+    Client* c = &clients[idx];
+    int in_sync = u->previous != NULL && c->state_game == u->game && c->state_seq + 1 == u->seq;
+    int congested = c->output.len + c->output.inflight >= output_high_water;
+    const char* s;
+    size_t n;
+    if (in_sync && !congested) {
+        if (u->delta_len == 0) {
+            u->delta_len = proto_encode_delta(u->delta, u->previous, u->state, u->seq);
+        }
+        s = u->delta;
+        n = u->delta_len;
+    } else {
+        if (u->full_len == 0) {
+            u->full_len = proto_encode_delta(u->full, NULL, u->state, u->seq);
+        }
+        s = u->full;
+        n = u->full_len;
+    }
+    c->state_game = u->game;
+    c->state_seq = u->seq;
+    if (enqueue_line(idx, s, n, OUT_STATE)) {
+        schedule_flush(idx);
+    }
+}
+
+static void send_state(StateUpdate* u, int idx) {
+    if (idx < 0 || !owned(idx) || clients[idx].socket_fd <= 0) {
+        return;
+    }
+    if (clients[idx].delta) {
+        send_state_delta(u, idx);
+        return;
+    }
+    if (clients[idx].proto == 2) {
+        if (u->frame_len == 0) {
+            u->frame_len = proto_encode_state(u->frame, u->state);
+        }
+        enqueue_and_schedule(idx, u->frame, u->frame_len, OUT_STATE);
+        return;
+    }
+    if (u->line_len == 0) {
+        const AwaleState* st = u->state;
+        u->line_len = (size_t)snprintf(u->line, sizeof(u->line),
+            "STATE %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d\n",
+            st->board[0], st->board[1], st->board[2], st->board[3], st->board[4], st->board[5],
+            st->board[6], st->board[7], st->board[8], st->board[9], st->board[10], st->board[11],
+            st->scores[0], st->scores[1], st->current_player);
+    }
+    enqueue_and_schedule(idx, u->line, u->line_len, OUT_STATE);
+}
+
+/**
+ * Ferme le socket d'un client (les octets encore en file sont perdus) ; un
+ * transfert vers un autre shard en attente est abandonné
+ */
+static void close_client_socket(int idx) {
+    OutputQueue* q = &clients[idx].output;
+    int fd = clients[idx].socket_fd;
+    timer_cancel(&current_reactor->timers, &clients[idx].timer);
+    timer_cancel(&current_reactor->timers, &clients[idx].challenge_timer);
+    timer_cancel(&current_reactor->timers, &clients[idx].save_timer);
+    free(current_reactor->moving[idx]);
+    current_reactor->moving[idx] = NULL;
+    int async = 0;
+#ifndef USE_SELECT
+    async = reactors[clients[idx].reactor].ring != NULL;
+#endif
+    if (async) {
+        // Dernier envoi direct si aucun n'est en cours ; shutdown termine le
+        // recv multishot, qui garderait sinon le socket ouvert
+        if (q->inflight == 0) {
+            outq_flush(q, fd);
+        }
+        shutdown(fd, SHUT_RDWR);
+    } else {
+        flush_queue(&clients[idx]);
+    }
+    q->dropped += q->len;
+    if (q->dropped > 0) {
+        printf("Sortie vers %s : %llu octets mis en file, %llu abandonnés\n",
+               clients[idx].username[0] ? clients[idx].username : "(sans nom)", q->queued, q->dropped);
+    }
+    close(fd);
+    clients[idx].socket_fd = -1;
+    if (q->inflight == 0) {
+        outq_free(q);  // Sinon à la complétion de l'envoi en cours
+    }
+    pthread_mutex_lock(&directory_lock);
+    directory[idx].online = 0;
+    pthread_mutex_unlock(&directory_lock);
+    current_reactor->num_closed++;  // Emplacement libéré quand il n'attendra plus rien
 }
 
 /**
  * Initialise une nouvelle partie
  */
 static void init_game_state(Game* g) {
-    for (int i = 0; i < 12; i++) {
-        g->board[i] = 4;
-    }
-    g->scores[0] = 0;
-    g->scores[1] = 0;
+    awale_init(&g->state);
     g->active = 1;
     g->num_spectators = 0;
     g->private_mode = 0;  // Mode privé désactivé par défaut
@@ -127,8 +804,42 @@ static void init_game_state(Game* g) {
     g->start_time = time(NULL);  // Heure de début
     g->ending = 0;  // Pas en train de se terminer
     g->responses_received = 0;  // Aucune réponse reçue
-    for (int i = 0; i < MAX_SPECTATORS; i++) {
-        g->spectator_indices[i] = -1;
+    g->save_requested = 0;
+    g->serial = __atomic_add_fetch(&next_game_serial, 1, __ATOMIC_RELAXED);
+    g->sent_state = g->state;
+    g->state_seq = 0;
+    g->draw_offer_by = -1;  // Aucune proposition d'égalité
+    timer_cancel(&current_reactor->timers, &g->draw_timer);
+}
+
+/**
+ * Ajoute un spectateur à une partie ; le tableau double quand il est plein
+ * (le tableau d'une partie terminée est gardé pour la suivante).
+ * Retourne -1 si la mémoire manque.
+ */
+static int add_spectator(Game* g, int idx) {
+    if (g->num_spectators == g->max_spectators) {
+        int cap = g->max_spectators ? 2 * g->max_spectators : 8;
+        int* indices = realloc(g->spectator_indices, cap * sizeof(int));
+        if (indices == NULL) {
+            return -1;
+        }
+        g->spectator_indices = indices;
+        g->max_spectators = cap;
+    }
+    g->spectator_indices[g->num_spectators++] = idx;
+    return 0;
+}
+
+/**
+ * Retire un spectateur ; le dernier prend sa place (l'ordre ne compte pas)
+ */
+static void remove_spectator(Game* g, int idx) {
+    for (int j = 0; j < g->num_spectators; j++) {
+        if (g->spectator_indices[j] == idx) {
+            g->spectator_indices[j] = g->spectator_indices[--g->num_spectators];
+            return;
+        }
     }
 }
 
@@ -141,10 +852,11 @@ static void save_game(Game* g, const char* result) {
     
     // Créer un nom de fichier unique avec timestamp
     char filename[256];
-    struct tm* timeinfo = localtime(&g->start_time);
+    struct tm timeinfo;  // Versions réentrantes : chaque shard sauvegarde ses parties
+    localtime_r(&g->start_time, &timeinfo);
     snprintf(filename, sizeof(filename), "saved_games/game_%04d%02d%02d_%02d%02d%02d_%s_vs_%s.txt",
-             timeinfo->tm_year + 1900, timeinfo->tm_mon + 1, timeinfo->tm_mday,
-             timeinfo->tm_hour, timeinfo->tm_min, timeinfo->tm_sec,
+             timeinfo.tm_year + 1900, timeinfo.tm_mon + 1, timeinfo.tm_mday,
+             timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec,
              g->player_names[0], g->player_names[1]);
     
     FILE* f = fopen(filename, "w");
@@ -154,13 +866,14 @@ static void save_game(Game* g, const char* result) {
     }
     
     fprintf(f, "=== PARTIE AWALE ===\n");
-    fprintf(f, "Date: %s", ctime(&g->start_time));
+    char date[32];
+    fprintf(f, "Date: %s", ctime_r(&g->start_time, date));
     fprintf(f, "Joueur 1 (P1): %s\n", g->player_names[0]);
     fprintf(f, "Joueur 2 (P2): %s\n", g->player_names[1]);
     fprintf(f, "Résultat: %s\n", result);
     fprintf(f, "Score final: %s=%d, %s=%d\n", 
-            g->player_names[0], g->scores[0], 
-            g->player_names[1], g->scores[1]);
+            g->player_names[0], g->state.scores[0], 
+            g->player_names[1], g->state.scores[1]);
     fprintf(f, "\n=== HISTORIQUE DES COUPS (%d coups) ===\n", g->num_moves);
     
     for (int i = 0; i < g->num_moves; i++) {
@@ -175,39 +888,6 @@ static void save_game(Game* g, const char* result) {
     printf("Partie sauvegardée dans: %s\n", filename);
 }
 
-/**
- * Trouve l'index d'un client par son socket
- */
-static int find_client_by_socket(int fd) {
-    for (int i = 0; i < num_clients; i++) {
-        if (clients[i].socket_fd == fd) {
-            return i;
-        }
-    }
-    return -1;
-}
-
-/**
- * Trouve l'index d'un client par son username
- */
-static int find_client_by_username(const char* username) {
-    for (int i = 0; i < num_clients; i++) {
-        if (clients[i].socket_fd > 0 && strcmp(clients[i].username, username) == 0) {
-            return i;
-        }
-    }
-    return -1;
-}
-
-static int find_client_by_username_any(const char* username) {
-    for (int i = 0; i < num_clients; i++) {
-        if (clients[i].username[0] != '\0' && strcmp(clients[i].username, username) == 0) {
-            return i;
-        }
-    }
-    return -1;
-}
-
 /**
  * Vérifie si un joueur est dans la liste d'amis d'un autre
  */
@@ -356,51 +1036,115 @@ static void update_elo(Game* g, int winner) {
 }
 
 /**
- * Envoie la liste des utilisateurs en ligne à un client, triés par ELO décroissant
+ * Premier emplacement de partie du shard courant
  */
-static void send_online_users(int client_idx) {
-    // Créer un tableau des indices de clients disponibles
-    int available[MAX_CLIENTS];
-    int count = 0;
-    
-    for (int i = 0; i < num_clients; i++) {
-        if (i != client_idx && 
-            clients[i].socket_fd > 0 && 
-            clients[i].status != CLIENT_IN_GAME) {
-            available[count++] = i;
-        }
+static int first_game(void) {
+    return current_reactor->id * GAMES_PER_SHARD;
+}
+
+/**
+ * LIST (games = 0) ou GAMES (games = 1) : chaque shard ajoute ses clients
+ * disponibles ou ses parties à la réponse, le dernier l'envoie
+ */
+static void request_gather(int client_idx, int games) {
+    Gather* g = malloc(sizeof(*g));
+    if (!g) {
+        return;
     }
-    
-    // Trier par ELO décroissant (bubble sort simple)
-    for (int i = 0; i < count - 1; i++) {
-        for (int j = 0; j < count - i - 1; j++) {
-            if (clients[available[j]].elo_score < clients[available[j + 1]].elo_score) {
-                int tmp = available[j];
-                available[j] = available[j + 1];
-                available[j + 1] = tmp;
-            }
-        }
+    g->games = games;
+    g->requester = client_idx;
+    g->session = clients[client_idx].session;
+    pthread_mutex_init(&g->lock, NULL);
+    g->remaining = num_reactors;
+    g->count = 0;
+    broadcast_mail(MAIL_GATHER, client_idx, "", g);
+}
+
+/**
+ * Envoie la réponse complète au demandeur : les utilisateurs triés par ELO
+ * décroissant, ou les parties dans l'ordre de leur numéro
+ */
+static void send_gather(Gather* g) {
+    // Tri par insertion (ELO décroissant, numéro de partie croissant)
+    for (int i = 1; i < g->count; i++) {
+        for (int j = i; j > 0; j--) {
+            int a = g->entries[j - 1].value;
+            int b = g->entries[j].value;
+            if (g->games ? a < b : a >= b) {
+                break;
+            }
+            GatherEntry tmp = g->entries[j - 1];
+            g->entries[j - 1] = g->entries[j];
+            g->entries[j] = tmp;
+        }
     }
     
-    // Construire le message avec username et score ELO
-    char msg[1024] = "USERLIST";
-    for (int i = 0; i < count; i++) {
+    char msg[1024];
+    size_t len = (size_t)snprintf(msg, sizeof(msg), g->games ? "GAMESLIST" : "USERLIST");
+    for (int i = 0; i < g->count; i++) {
         char entry[128];
-        snprintf(entry, sizeof(entry), " %s(%d)", 
-                 clients[available[i]].username, 
-                 clients[available[i]].elo_score);
-        strcat(msg, entry);
+        if (g->games) {
+            snprintf(entry, sizeof(entry), " %d:%s_vs_%s", g->entries[i].value,
+                     g->entries[i].names[0], g->entries[i].names[1]);
+        } else {
+            snprintf(entry, sizeof(entry), " %s(%d)", g->entries[i].names[0], g->entries[i].value);
+        }
+        if (len + strlen(entry) + 2 > sizeof(msg)) {
+            break;  // La ligne doit tenir dans le tampon de lecture du client
+        }
+        strcpy(msg + len, entry);
+        len += strlen(entry);
     }
+    strcpy(msg + len, "\n");
+    deliver(g->requester, g->session, msg);
     
-    strcat(msg, "\n");
-    send_line(clients[client_idx].socket_fd, msg);
+    if (!g->games) {
+        char bots[128];
+        snprintf(bots, sizeof(bots), "MSG Bots : %s1 (facile) à %s%d (fort), tapez '/challenge %sN'.\n",
+                 BOT_PREFIX, BOT_PREFIX, BOT_MAX_LEVEL, BOT_PREFIX);
+        deliver(g->requester, g->session, bots);
+    } else if (g->count == 0) {
+        deliver(g->requester, g->session, "MSG Aucune partie en cours.\n");
+    }
+    pthread_mutex_destroy(&g->lock);
+    free(g);
+}
+
+/**
+ * Part du shard courant dans une réponse à LIST ou GAMES
+ */
+static void gather_contribute(Gather* g) {
+    pthread_mutex_lock(&g->lock);
+    if (g->games) {
+        for (int i = first_game(); i < first_game() + GAMES_PER_SHARD; i++) {
+            if (games[i].active) {
+                strcpy(g->entries[g->count].names[0], games[i].player_names[0]);
+                strcpy(g->entries[g->count].names[1], games[i].player_names[1]);
+                g->entries[g->count++].value = i;
+            }
+        }
+    } else {
+        for (int i = 0; i < MAX_CLIENTS; i++) {
+            if (owned(i) && i != g->requester &&
+                clients[i].socket_fd > 0 &&
+                clients[i].status != CLIENT_IN_GAME) {
+                strcpy(g->entries[g->count].names[0], clients[i].username);
+                g->entries[g->count++].value = clients[i].elo_score;
+            }
+        }
+    }
+    int last = --g->remaining == 0;
+    pthread_mutex_unlock(&g->lock);
+    if (last) {
+        send_gather(g);
+    }
 }
 
 /**
  * Trouve la partie d'un client
  */
 static Game* find_game_for_client(int client_idx) {
-    for (int i = 0; i < MAX_CLIENTS / 2; i++) {
+    for (int i = first_game(); i < first_game() + GAMES_PER_SHARD; i++) {
         if (games[i].active && 
             (games[i].client_indices[0] == client_idx || 
              games[i].client_indices[1] == client_idx)) {
@@ -414,7 +1158,7 @@ static Game* find_game_for_client(int client_idx) {
  * Trouve l'index de la partie d'un client
  */
 static int find_game_index_for_client(int client_idx) {
-    for (int i = 0; i < MAX_CLIENTS / 2; i++) {
+    for (int i = first_game(); i < first_game() + GAMES_PER_SHARD; i++) {
         if (games[i].active && 
             (games[i].client_indices[0] == client_idx || 
              games[i].client_indices[1] == client_idx)) {
@@ -428,118 +1172,56 @@ static int find_game_index_for_client(int client_idx) {
  * Diffuse l'état actuel du jeu aux deux clients d'une partie
  */
 static void broadcast_game_state(Game* g) {
-    char line[256];
-    int c0_idx = g->client_indices[0];
-    int c1_idx = g->client_indices[1];
-    
-    snprintf(line, sizeof(line),
-        "STATE %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d\n",
-        g->board[0], g->board[1], g->board[2], g->board[3], g->board[4], g->board[5],
-        g->board[6], g->board[7], g->board[8], g->board[9], g->board[10], g->board[11],
-        g->scores[0], g->scores[1], g->current_player);
-    
-    send_line(clients[c0_idx].socket_fd, line);
-    send_line(clients[c1_idx].socket_fd, line);
+    StateUpdate update = {.state = &g->state, .previous = &g->sent_state, .game = g->serial,
+                          .seq = ++g->state_seq};
+    send_state(&update, g->client_indices[0]);
+    send_state(&update, g->client_indices[1]);
     
     // Envoyer aussi aux spectateurs
     for (int i = 0; i < g->num_spectators; i++) {
-        int spec_idx = g->spectator_indices[i];
-        if (spec_idx >= 0 && clients[spec_idx].socket_fd > 0) {
-            send_line(clients[spec_idx].socket_fd, line);
-        }
+        send_state(&update, g->spectator_indices[i]);
     }
+    g->sent_state = g->state;
 }
 
 /**
  * Envoie l'état actuel du jeu à un seul client
  */
 static void send_game_state(Game* g, int client_idx) {
-    char line[256];
-    
-    snprintf(line, sizeof(line),
-        "STATE %d %d %d %d %d %d %d %d %d %d %d %d %d %d %d\n",
-        g->board[0], g->board[1], g->board[2], g->board[3], g->board[4], g->board[5],
-        g->board[6], g->board[7], g->board[8], g->board[9], g->board[10], g->board[11],
-        g->scores[0], g->scores[1], g->current_player);
-    
-    send_line(clients[client_idx].socket_fd, line);
-}
-
-/**
- * Envoie la liste des parties en cours à un client
- */
-static void send_games_list(int client_idx) {
-    char msg[1024] = "GAMESLIST";
-    int has_games = 0;
-    
-    for (int i = 0; i < MAX_CLIENTS / 2; i++) {
-        if (games[i].active) {
-            has_games = 1;
-            char game_info[128];
-            snprintf(game_info, sizeof(game_info), " %d:%s_vs_%s", i,
-                     clients[games[i].client_indices[0]].username,
-                     clients[games[i].client_indices[1]].username);
-            strcat(msg, game_info);
-        }
-    }
-    
-    strcat(msg, "\n");
-    send_line(clients[client_idx].socket_fd, msg);
-    
-    if (!has_games) {
-        send_line(clients[client_idx].socket_fd, "MSG Aucune partie en cours.\n");
-    }
+    StateUpdate update = {.state = &g->state, .game = g->serial, .seq = g->state_seq};
+    send_state(&update, client_idx);
 }
 
 /**
  * Finalise la fin de partie après réception des réponses de sauvegarde
  */
 static void finalize_game_end(Game* g, int game_idx) {
-    // Compter les réponses positives
-    int save_requested = 0;
-    for (int i = 0; i < 2; i++) {
-        int player_idx = g->client_indices[i];
-        if (player_idx >= 0 && clients[player_idx].save_response == 1) {
-            save_requested = 1;
-            break;
-        }
-    }
-    
     // Sauvegarder si au moins un joueur a accepté
-    if (save_requested) {
+    if (g->save_requested) {
         save_game(g, g->end_result);
         
         // Notifier les joueurs
-        for (int i = 0; i < 2; i++) {
-            int player_idx = g->client_indices[i];
-            if (player_idx >= 0 && clients[player_idx].socket_fd > 0) {
-                send_line(clients[player_idx].socket_fd, "MSG Partie sauvegardée.\n");
-            }
-        }
+        broadcast_line(g, "MSG Partie sauvegardée.\n", TO_PLAYERS, -1);
     } else {
         // Notifier les joueurs
-        for (int i = 0; i < 2; i++) {
-            int player_idx = g->client_indices[i];
-            if (player_idx >= 0 && clients[player_idx].socket_fd > 0) {
-                send_line(clients[player_idx].socket_fd, "MSG Partie non sauvegardée.\n");
-            }
-        }
+        broadcast_line(g, "MSG Partie non sauvegardée.\n", TO_PLAYERS, -1);
     }
     
     // Notifier les spectateurs
+    broadcast_line(g, "MSG La partie que vous regardiez est terminée.\n", TO_SPECTATORS, -1);
     for (int i = 0; i < g->num_spectators; i++) {
         int spec_idx = g->spectator_indices[i];
         if (spec_idx >= 0 && clients[spec_idx].socket_fd > 0) {
-            send_line(clients[spec_idx].socket_fd, "MSG La partie que vous regardiez est terminée.\n");
             clients[spec_idx].status = CLIENT_WAITING;
             clients[spec_idx].watching_game = -1;
         }
     }
     
-    // Réinitialiser les données de sauvegarde des joueurs (le statut est déjà CLIENT_WAITING)
+    // Réinitialiser les données de sauvegarde des joueurs restés sur le shard
+    // (le statut est déjà CLIENT_WAITING)
     for (int i = 0; i < 2; i++) {
         int player_idx = g->client_indices[i];
-        if (player_idx >= 0) {
+        if (player_idx >= 0 && owned(player_idx)) {
             // Ne pas changer le status qui est déjà CLIENT_WAITING
             clients[player_idx].save_response = -1;
             clients[player_idx].game_to_save = -1;
@@ -602,10 +1284,10 @@ static void end_game(Game* g, const char* end_message, int game_idx) {
         }
         
         // Notifier les spectateurs
+        broadcast_line(g, "MSG La partie que vous regardiez est terminée.\n", TO_SPECTATORS, -1);
         for (int i = 0; i < g->num_spectators; i++) {
             int spec_idx = g->spectator_indices[i];
             if (spec_idx >= 0 && clients[spec_idx].socket_fd > 0) {
-                send_line(clients[spec_idx].socket_fd, "MSG La partie que vous regardiez est terminée.\n");
                 clients[spec_idx].status = CLIENT_WAITING;
                 clients[spec_idx].watching_game = -1;
             }
@@ -629,6 +1311,7 @@ static void end_game(Game* g, const char* end_message, int game_idx) {
             clients[player_idx].status = CLIENT_ASKED_SAVE;
             clients[player_idx].save_response = -1;  // Pas de réponse encore
             clients[player_idx].game_to_save = game_idx;
+            timer_arm(&current_reactor->timers, &clients[player_idx].save_timer, SAVE_TIMEOUT_S * 1000, timer_now_ms());
             players_asked++;
         }
     }
@@ -636,11 +1319,11 @@ static void end_game(Game* g, const char* end_message, int game_idx) {
     // Si aucun joueur n'est connecté, terminer immédiatement
     if (players_asked == 0) {
         // Notifier les spectateurs
+        broadcast_line(g, "MSG La partie que vous regardiez est terminée.\n", TO_SPECTATORS, -1);
+        broadcast_line(g, end_message, TO_SPECTATORS, -1);
         for (int i = 0; i < g->num_spectators; i++) {
             int spec_idx = g->spectator_indices[i];
             if (spec_idx >= 0 && clients[spec_idx].socket_fd > 0) {
-                send_line(clients[spec_idx].socket_fd, "MSG La partie que vous regardiez est terminée.\n");
-                send_line(clients[spec_idx].socket_fd, end_message);
                 clients[spec_idx].status = CLIENT_WAITING;
                 clients[spec_idx].watching_game = -1;
             }
@@ -653,1147 +1336,2524 @@ static void end_game(Game* g, const char* end_message, int game_idx) {
     }
 }
 
-int main() {
-    srand(time(NULL));
-    
-    // Initialisation des structures
+/**
+ * Niveau d'un bot d'après son nom : N pour bot-N, 0 si ce n'est pas un bot,
+ * -1 si le nom commence par bot- sans être un bot valide
+ */
+static int bot_level_from_name(const char* name) {
+    size_t len = strlen(BOT_PREFIX);
+    if (strncmp(name, BOT_PREFIX, len) != 0) {
+        return 0;
+    }
+    char* end;
+    long level = strtol(name + len, &end, 10);
+    if (end == name + len || *end != '\0' || level < 1 || level > BOT_MAX_LEVEL) {
+        return -1;
+    }
+    return (int)level;
+}
+
+/**
+ * Réserve un slot client du shard courant pour un bot (réutilise un bot qui
+ * n'est plus en partie). Retourne l'index du slot ou -1 si le serveur est plein
+ */
+static int alloc_bot(int level) {
+    int idx = -1;
     for (int i = 0; i < MAX_CLIENTS; i++) {
-        clients[i].socket_fd = -1;
-        clients[i].status = CLIENT_CONNECTED;
-        clients[i].opponent_index = -1;
-        clients[i].challenged_by = -1;
-        clients[i].watching_game = -1;
-        clients[i].save_mode = 0;
-        clients[i].save_response = -1;
-        clients[i].game_to_save = -1;
+        if (owned(i) && clients[i].is_bot && find_game_for_client(i) == NULL) {
+            idx = i;
+            break;
+        }
+    }
+    if (idx == -1) {
+        pthread_mutex_lock(&directory_lock);
+        if (num_clients < MAX_CLIENTS) {
+            idx = num_clients++;
+            directory[idx].shard = current_reactor->id;  // Jamais en ligne : pas de courrier
+        }
+        pthread_mutex_unlock(&directory_lock);
+        if (idx == -1) {
+            return -1;
+        }
+        current_reactor->owns[idx] = 1;
     }
     
-    for (int i = 0; i < MAX_CLIENTS / 2; i++) {
-        games[i].active = 0;
-        games[i].ending = 0;
+    memset(&clients[idx], 0, sizeof(clients[idx]));
+    clients[idx].socket_fd = -1;  // Pas de socket : send_line ignore les envois
+    timer_init(&clients[idx].timer, TIMER_CLIENT, idx);  // Jamais armés pour un bot
+    timer_init(&clients[idx].challenge_timer, TIMER_CHALLENGE, idx);
+    timer_init(&clients[idx].save_timer, TIMER_SAVE, idx);
+    clients[idx].is_bot = 1;
+    clients[idx].bot_level = level;
+    clients[idx].reactor = current_reactor->id;
+    clients[idx].status = CLIENT_WAITING;
+    clients[idx].opponent_index = -1;
+    clients[idx].challenged_by = -1;
+    clients[idx].watching_game = -1;
+    clients[idx].save_response = -1;
+    clients[idx].game_to_save = -1;
+    clients[idx].elo_score = 100;
+    snprintf(clients[idx].username, sizeof(clients[idx].username), "%s%d", BOT_PREFIX, level);
+    return idx;
+}
+
+/**
+ * Thread de recherche : renvoie la tâche par le pipe une fois le coup trouvé
+ */
+static void* bot_thread(void* arg) {
+    BotJob* job = arg;
+    EngineLimits limits = {2 * job->level, BOT_MOVE_TIME_MS, NULL, &bot_tt, bot_threads, &egdb, &book};
+    EngineResult result;
+    engine_search(&job->state, &limits, &result);
+    job->pit = result.pit;
+    
+    const TTStats* tt = &result.tt_stats;
+    printf("[%s%d] profondeur %d, %llu noeuds en %d ms, table %.1f%% succès\n", BOT_PREFIX,
+           job->level, result.depth, result.nodes, result.time_ms,
+           tt->probes ? 100.0 * tt->hits / tt->probes : 0.0);
+    
+    // Un pointeur fait moins de PIPE_BUF octets : l'écriture est atomique
+    if (write(bot_pipe[1], &job, sizeof(job)) != sizeof(job)) {
+        free(job);
+    }
+    return NULL;
+}
+
+/**
+ * Lance la recherche du bot si c'est à lui de jouer
+ */
+static void request_bot_move(Game* g, int game_idx) {
+    int bot_idx = g->client_indices[(int)g->state.current_player];
+    if (!clients[bot_idx].is_bot) {
+        return;
     }
     
-    // Création du socket serveur
-    int srv = socket(AF_INET, SOCK_STREAM, 0);
+    BotJob* job = malloc(sizeof(*job));
+    if (!job) {
+        return;
+    }
+    job->game_idx = game_idx;
+    job->serial = g->serial;
+    job->state = g->state;
+    job->level = clients[bot_idx].bot_level;
+    job->pit = -1;
     
-    // Configuration pour réutiliser l'adresse
-    int opt = 1;
-    setsockopt(srv, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, bot_thread, job) == 0) {
+        pthread_detach(thread);
+    } else {
+        bot_thread(job);  // Pas de thread disponible : recherche dans la boucle
+    }
+}
+
+static int is_bot_player(const Game* g, int player) {
+    int idx = g->client_indices[player];
+    return idx >= 0 && clients[idx].is_bot;
+}
+
+/**
+ * Termine d'office une partie sans espoir : la base de finales prouve la
+ * victoire d'un bot, qui la mènera à terme sans faute puisqu'il consulte la
+ * même base (entre deux bots, toute issue connue, nulle comprise). Tant
+ * qu'un humain peut encore changer le résultat, la partie continue. Les
+ * graines restantes sont réparties selon l'écart obtenu en jeu parfait.
+ * Retourne 1 si la partie est arbitrée
+ */
+static int adjudicate(Game* g) {
+    AwaleState* s = &g->state;
+    int margin;
+    if (!egdb_probe(&egdb, s, &margin)) {
+        return 0;
+    }
+    int me = s->current_player;
+    int seeds = egdb_board_seeds(s);
+    int diff = s->scores[me] - s->scores[1 - me] + margin;
+    int winner = diff > 0 ? me : diff < 0 ? 1 - me : -1;
+    if (!(is_bot_player(g, 0) && is_bot_player(g, 1)) && (winner < 0 || !is_bot_player(g, winner))) {
+        return 0;
+    }
     
-    // Configuration de l'adresse du serveur
-    struct sockaddr_in a = {0};
-    a.sin_family = AF_INET;
-    a.sin_addr.s_addr = INADDR_ANY;
-    a.sin_port = htons(PORT);
+    // seeds + margin est impair si un cycle partage un nombre impair de
+    // graines : la graine restante va au vainqueur
+    int share = (seeds + margin + (diff > 0)) / 2;
+    s->scores[me] += share;
+    s->scores[1 - me] += seeds - share;
+    memset(s->board, 0, sizeof(s->board));
+    s->key = awale_hash(s);
+    printf("Partie %s - %s arbitrée par la base de finales (%d-%d)\n", g->player_names[0],
+           g->player_names[1], s->scores[0], s->scores[1]);
+    return 1;
+}
+
+static void send_analysis(int client_idx, AnalysisKind kind, const AnalysisResult* r) {
+    char msg[128];
+    if (kind == ANALYSIS_HINT) {
+        snprintf(msg, sizeof(msg), "HINT %d recherche %d %d\n", r->pit, r->depth, r->score);
+    } else {
+        snprintf(msg, sizeof(msg), "ANALYSIS %d %d %d %llu %d\n", r->pit, r->score, r->depth,
+                 r->nodes, r->time_ms);
+    }
+    send_line(clients[client_idx].socket_fd, msg);
+}
+
+/**
+ * HINT / ANALYZE : réponse immédiate depuis le livre ou le cache, sinon la
+ * recherche est confiée au service d'analyse (réponse par analysis_pipe)
+ */
+static void request_analysis(int client_idx, Game* g, AnalysisKind kind) {
+    BookEntry entry;
+    if (kind == ANALYSIS_HINT && book_best_move(&book, &g->state, &entry)) {
+        char msg[128];
+        snprintf(msg, sizeof(msg), "HINT %d livre %u %u %u\n", entry.pit, entry.games,
+                 entry.wins, entry.draws);
+        send_line(clients[client_idx].socket_fd, msg);
+        return;
+    }
     
-    // Liaison et écoute
-    if (bind(srv, (struct sockaddr*)&a, sizeof(a)) < 0 || listen(srv, 10) < 0) {
-        perror("bind/listen");
+    AnalysisResult result;
+    pthread_mutex_lock(&analysis_cache_lock);
+    int cached = analysis_cache_get(&analysis_cache, g->state.key, kind, &result);
+    pthread_mutex_unlock(&analysis_cache_lock);
+    if (cached) {
+        send_analysis(client_idx, kind, &result);
+        return;
+    }
+    
+    AnalysisJob* job = malloc(sizeof(*job));
+    if (!job) {
+        return;
+    }
+    job->client_idx = client_idx;
+    job->serial = g->serial;
+    job->kind = kind;
+    job->state = g->state;
+    if (analysis_submit(job) < 0) {
+        free(job);
+        send_line(clients[client_idx].socket_fd, "MSG Analyse impossible pour le moment, réessayez.\n");
+    }
+}
+
+/**
+ * Reçoit une analyse terminée (réacteur 0) : mise en cache, puis la tâche
+ * va au shard du demandeur
+ * Retourne 0 si le pipe est vide
+ */
+static int handle_analysis_result(void) {
+    AnalysisJob* job;
+    if (read(analysis_pipe[0], &job, sizeof(job)) != sizeof(job)) {
+        return 0;
+    }
+    
+    pthread_mutex_lock(&analysis_cache_lock);
+    analysis_cache_put(&analysis_cache, job->state.key, job->kind, &job->result);
+    printf("[analyse] profondeur %d en %d ms, cache %llu succès / %llu demandes\n",
+           job->result.depth, job->result.time_ms, analysis_cache.hits,
+           analysis_cache.hits + analysis_cache.misses);
+    pthread_mutex_unlock(&analysis_cache_lock);
+    
+    Mail* m = new_mail(MAIL_ANALYSIS, job->client_idx, 0, "");
+    if (m == NULL) {
+        free(job);
         return 1;
     }
+    m->data = job;
+    route_mail(m);
+    return 1;
+}
+
+/**
+ * Analyse arrivée au shard du demandeur : réponse s'il est toujours dans
+ * la même partie et la même position
+ */
+static void run_analysis_job(AnalysisJob* job) {
+    Game* g = find_game_for_client(job->client_idx);
+    if (g != NULL && g->serial == job->serial && g->state.key == job->state.key) {
+        send_analysis(job->client_idx, job->kind, &job->result);
+    }
+}
+
+/**
+ * Joue un coup pour un joueur (humain ou bot) et gère la fin de partie
+ */
+static void play_move(int client_idx, Game* g, int game_idx, int pit) {
+    int player_id = clients[client_idx].player_id;
+    int opponent_idx = clients[client_idx].opponent_index;
     
-    printf("Server on %d\n", PORT);
+    printf("[%s] joue le pit %d\n", clients[client_idx].username, pit);
     
-    // Boucle principale du serveur
-    while (1) {
-        fd_set rfds;
-        FD_ZERO(&rfds);
-        FD_SET(srv, &rfds);
-        
-        int maxfd = srv;
-        
-        // Ajouter tous les clients connectés au select
-        for (int i = 0; i < num_clients; i++) {
-            if (clients[i].socket_fd > 0) {
-                FD_SET(clients[i].socket_fd, &rfds);
-                if (clients[i].socket_fd > maxfd) {
-                    maxfd = clients[i].socket_fd;
-                }
-            }
+    // Semer et capturer directement sur l'état de la partie
+    int gained = awale_play(&g->state, pit);
+    
+    if (gained < 0) {
+        int own_pit = pit >= player_id * PITS_PER_SIDE && pit < (player_id + 1) * PITS_PER_SIDE;
+        if (own_pit && g->state.board[pit] > 0) {
+            send_line(clients[client_idx].socket_fd, "MSG Coup invalide : vous devez nourrir l'adversaire.\n");
+        } else {
+            send_line(clients[client_idx].socket_fd, "MSG Coup invalide.\n");
         }
+        send_game_state(g, client_idx);  // Renvoyer l'état seulement au joueur
+        return;
+    }
+    
+    // Un coup joué retire la proposition d'égalité en attente
+    if (g->draw_offer_by != -1) {
+        g->draw_offer_by = -1;
+        timer_cancel(&current_reactor->timers, &g->draw_timer);
+        send_line(clients[opponent_idx].socket_fd, "MSG Proposition d'égalité retirée : un coup a été joué.\n");
+    }
+    
+    // Informer l'adversaire et les spectateurs
+    char notify[128];
+    snprintf(notify, sizeof(notify), "MSG %s a déplacé les graines de la case %d.\n", 
+             clients[client_idx].username, pit);
+    broadcast_line(g, notify, TO_PLAYERS | TO_SPECTATORS, client_idx);
+    
+    // Enregistrer le coup dans l'historique
+    if (g->num_moves < MAX_MOVES) {
+        g->moves[g->num_moves].player = player_id;
+        g->moves[g->num_moves].pit = pit;
+        g->moves[g->num_moves].seeds_captured = gained;
+        g->num_moves++;
+    }
+    
+    // Vérifier fin de partie (ou issue connue de la base de finales)
+    int over = awale_is_over(&g->state);
+    if (over) {
+        awale_collect_remaining(&g->state);
+    } else if (adjudicate(g)) {
+        over = 1;
+        broadcast_line(g, "MSG Issue connue de la base de finales : partie arbitrée.\n",
+                       TO_PLAYERS | TO_SPECTATORS, -1);
+    }
+    if (over) {
+        broadcast_game_state(g);
         
-        if (select(maxfd + 1, &rfds, NULL, NULL, NULL) <= 0) {
-            continue;
+        char end_msg[32];
+        if (g->state.scores[0] == g->state.scores[1]) {
+            strcpy(end_msg, "END draw\n");
+        } else {
+            int w = (g->state.scores[0] > g->state.scores[1]) ? 0 : 1;
+            snprintf(end_msg, sizeof(end_msg), "END winner %d\n", w);
         }
+        broadcast_line(g, end_msg, TO_PLAYERS, -1);
         
-        // Nouvelle connexion
-        if (FD_ISSET(srv, &rfds)) {
-            if (num_clients < MAX_CLIENTS) {
-                int new_fd = accept(srv, NULL, NULL);
-                if (new_fd >= 0) {
-                    clients[num_clients].socket_fd = new_fd;
-                    clients[num_clients].status = CLIENT_CONNECTED;  // En attente du username
-                    clients[num_clients].opponent_index = -1;
-                    clients[num_clients].challenged_by = -1;
-                    clients[num_clients].watching_game = -1;
-                    clients[num_clients].username[0] = '\0';  // Username vide pour l'instant
-                    clients[num_clients].bio_lines = 0;
-                    clients[num_clients].num_friends = 0;
-                    clients[num_clients].num_friend_requests = 0;
-                    clients[num_clients].private_mode = 0;
-                    clients[num_clients].save_mode = 0;
-                    clients[num_clients].save_response = -1;
-                    clients[num_clients].game_to_save = -1;
-                    clients[num_clients].elo_score = 100;  // Score ELO initial
-                    
-                    // Demander le username (non bloquant)
-                    send_line(new_fd, "REGISTER\n");
-                    
-                    printf("Nouvelle connexion acceptée (en attente du username)\n");
-                    num_clients++;
-                }
-            }
+        // Terminer la partie
+        end_game(g, end_msg, game_idx);
+        return;
+    }
+    
+    // Le joueur au trait a déjà été changé par awale_play
+    broadcast_game_state(g);
+    request_bot_move(g, game_idx);
+}
+
+/**
+ * Reçoit le coup d'un bot (réacteur 0) et le transmet au shard de sa partie
+ * Retourne 0 si le pipe est vide
+ */
+static int handle_bot_result(void) {
+    BotJob* job;
+    if (read(bot_pipe[0], &job, sizeof(job)) != sizeof(job)) {
+        return 0;
+    }
+    
+    Mail* m = new_mail(MAIL_BOT, -1, 0, "");
+    if (m == NULL) {
+        free(job);
+        return 1;
+    }
+    m->data = job;
+    int shard = job->game_idx / GAMES_PER_SHARD;
+    if (shard == current_reactor->id) {
+        handle_mail(m);
+    } else {
+        post_mail(&reactors[shard], m);
+    }
+    return 1;
+}
+
+/**
+ * Joue le coup d'un bot, sauf si sa partie est terminée entre-temps
+ */
+static void run_bot_job(BotJob* job) {
+    Game* g = &games[job->game_idx];
+    if (g->active && !g->ending && g->serial == job->serial && job->pit >= 0) {
+        int bot_idx = g->client_indices[(int)g->state.current_player];
+        if (clients[bot_idx].is_bot) {
+            play_move(bot_idx, g, job->game_idx, job->pit);
         }
-        
-        // Traiter les messages des clients existants
-        for (int i = 0; i < num_clients; i++) {
-            if (clients[i].socket_fd <= 0 || !FD_ISSET(clients[i].socket_fd, &rfds)) {
-                continue;
-            }
-            
-            char buf[256];
-            if (recv_line(clients[i].socket_fd, buf, sizeof(buf)) < 0) {
-                // Déconnexion
-                if (clients[i].username[0] != '\0') {
-                    printf("Client déconnecté: %s\n", clients[i].username);
+    }
+}
+
+/**
+ * Crée une partie entre un joueur qui a lancé un défi et celui qui l'accepte
+ * Retourne l'index de la partie ou -1 si le serveur est plein
+ */
+static int start_game(int challenger_idx, int accepter_idx) {
+    int game_idx = -1;
+    for (int g = first_game(); g < first_game() + GAMES_PER_SHARD; g++) {
+        if (!games[g].active) {
+            game_idx = g;
+            break;
+        }
+    }
+    
+    if (game_idx == -1) {
+        return -1;
+    }
+    
+    // Décider aléatoirement qui commence
+    int first_player = rand() % 2;
+    
+    if (first_player == 0) {
+        games[game_idx].client_indices[0] = challenger_idx;
+        games[game_idx].client_indices[1] = accepter_idx;
+    } else {
+        games[game_idx].client_indices[0] = accepter_idx;
+        games[game_idx].client_indices[1] = challenger_idx;
+    }
+    
+    init_game_state(&games[game_idx]);
+    
+    // Enregistrer les noms des joueurs
+    strcpy(games[game_idx].player_names[0], clients[games[game_idx].client_indices[0]].username);
+    strcpy(games[game_idx].player_names[1], clients[games[game_idx].client_indices[1]].username);
+    
+    // Activer le mode privé si un des joueurs l'a activé
+    if (clients[challenger_idx].private_mode || clients[accepter_idx].private_mode) {
+        games[game_idx].private_mode = 1;
+    }
+    
+    // Mettre à jour les statuts
+    clients[challenger_idx].status = CLIENT_IN_GAME;
+    clients[challenger_idx].opponent_index = accepter_idx;
+    clients[accepter_idx].status = CLIENT_IN_GAME;
+    clients[accepter_idx].opponent_index = challenger_idx;
+    clients[accepter_idx].challenged_by = -1;  // Réinitialiser le défi
+    timer_cancel(&current_reactor->timers, &clients[accepter_idx].challenge_timer);
+    
+    // Attribuer les rôles
+    clients[games[game_idx].client_indices[0]].player_id = 0;
+    clients[games[game_idx].client_indices[1]].player_id = 1;
+    
+    send_line(clients[games[game_idx].client_indices[0]].socket_fd, "ROLE 0\n");
+    send_line(clients[games[game_idx].client_indices[1]].socket_fd, "ROLE 1\n");
+    
+    // Informer les joueurs
+    char msg[128];
+    snprintf(msg, sizeof(msg), "MSG Partie commencée! Vous êtes P1 (pits 0..5). Adversaire: %s\n", 
+             clients[games[game_idx].client_indices[1]].username);
+    send_line(clients[games[game_idx].client_indices[0]].socket_fd, msg);
+    
+    snprintf(msg, sizeof(msg), "MSG Partie commencée! Vous êtes P2 (pits 6..11). Adversaire: %s\n", 
+             clients[games[game_idx].client_indices[0]].username);
+    send_line(clients[games[game_idx].client_indices[1]].socket_fd, msg);
+    
+    // Envoyer l'état initial
+    broadcast_game_state(&games[game_idx]);
+    
+    printf("Partie %d commencée (P1: %s, P2: %s)\n", game_idx,
+           clients[games[game_idx].client_indices[0]].username,
+           clients[games[game_idx].client_indices[1]].username);
+    
+    // Si un bot commence, lancer sa recherche
+    request_bot_move(&games[game_idx], game_idx);
+    return game_idx;
+}
+
+/**
+ * Ferme la connexion d'un client ; s'il était en partie, l'adversaire gagne
+ */
+static void disconnect_client(int i) {
+    if (clients[i].username[0] != '\0') {
+        printf("Client déconnecté: %s\n", clients[i].username);
+    } else {
+        printf("Client déconnecté (pas de username)\n");
+    }
+    
+    // Si le client était en partie, l'adversaire gagne automatiquement
+    if (clients[i].status == CLIENT_IN_GAME) {
+        int game_idx = find_game_index_for_client(i);
+        Game* g = (game_idx >= 0) ? &games[game_idx] : NULL;
+        if (g) {
+            int opponent_idx = clients[i].opponent_index;
+    
+            // Préparer le résultat pour sauvegarde
+            int winner_id = 1 - clients[i].player_id;
+            snprintf(g->end_result, sizeof(g->end_result), "%s gagne par forfait (%s déconnecté)", 
+                    g->player_names[winner_id], clients[i].username);
+    
+            if (opponent_idx >= 0 && clients[opponent_idx].socket_fd > 0) {
+                char end_msg[200];
+                snprintf(end_msg, sizeof(end_msg), 
+                        "END %s s'est déconnecté. Vous gagnez par forfait!\n",
+                        clients[i].username);
+                send_line(clients[opponent_idx].socket_fd, end_msg);
+    
+                // Vérifier si l'adversaire ou le joueur déconnecté a le mode sauvegarde activé
+                if (clients[opponent_idx].save_mode || clients[i].save_mode) {
+                    // Sauvegarde automatique
+                    save_game(g, g->end_result);
+                    send_line(clients[opponent_idx].socket_fd, "MSG Partie sauvegardée automatiquement.\n");
+                    clients[opponent_idx].status = CLIENT_WAITING;
+                    clients[opponent_idx].opponent_index = -1;
+                    g->active = 0;
+                    g->num_spectators = 0;
                 } else {
-                    printf("Client déconnecté (pas de username)\n");
+                    // Demander à l'adversaire s'il veut sauvegarder (non-bloquant)
+                    g->ending = 1;
+                    g->responses_received = 0;
+                    send_line(clients[opponent_idx].socket_fd, "ASKSAVE\n");
+                    clients[opponent_idx].status = CLIENT_ASKED_SAVE;
+                    clients[opponent_idx].save_response = -1;
+                    clients[opponent_idx].game_to_save = game_idx;
+                    timer_arm(&current_reactor->timers, &clients[opponent_idx].save_timer, SAVE_TIMEOUT_S * 1000, timer_now_ms());
+                    clients[opponent_idx].opponent_index = -1;
                 }
-                
-                // Si le client était en partie, l'adversaire gagne automatiquement
-                if (clients[i].status == CLIENT_IN_GAME) {
-                    int game_idx = find_game_index_for_client(i);
-                    Game* g = (game_idx >= 0) ? &games[game_idx] : NULL;
-                    if (g) {
-                        int opponent_idx = clients[i].opponent_index;
-                        
-                        // Préparer le résultat pour sauvegarde
-                        int winner_id = 1 - clients[i].player_id;
-                        snprintf(g->end_result, sizeof(g->end_result), "%s gagne par forfait (%s déconnecté)", 
-                                g->player_names[winner_id], clients[i].username);
-                        
-                        if (opponent_idx >= 0 && clients[opponent_idx].socket_fd > 0) {
-                            char end_msg[200];
-                            snprintf(end_msg, sizeof(end_msg), 
-                                    "END %s s'est déconnecté. Vous gagnez par forfait!\n",
-                                    clients[i].username);
-                            send_line(clients[opponent_idx].socket_fd, end_msg);
-                            
-                            // Vérifier si l'adversaire ou le joueur déconnecté a le mode sauvegarde activé
-                            if (clients[opponent_idx].save_mode || clients[i].save_mode) {
-                                // Sauvegarde automatique
-                                save_game(g, g->end_result);
-                                send_line(clients[opponent_idx].socket_fd, "MSG Partie sauvegardée automatiquement.\n");
-                                clients[opponent_idx].status = CLIENT_WAITING;
-                                clients[opponent_idx].opponent_index = -1;
-                                g->active = 0;
-                                g->num_spectators = 0;
-                            } else {
-                                // Demander à l'adversaire s'il veut sauvegarder (non-bloquant)
-                                g->ending = 1;
-                                g->responses_received = 0;
-                                send_line(clients[opponent_idx].socket_fd, "ASKSAVE\n");
-                                clients[opponent_idx].status = CLIENT_ASKED_SAVE;
-                                clients[opponent_idx].save_response = -1;
-                                clients[opponent_idx].game_to_save = game_idx;
-                                clients[opponent_idx].opponent_index = -1;
-                            }
-                        } else {
-                            // Pas d'adversaire connecté, sauvegarder si le joueur déconnecté avait le mode actif
-                            if (clients[i].save_mode) {
-                                save_game(g, g->end_result);
-                            }
-                            g->active = 0;
-                            g->num_spectators = 0;
-                        }
-                        
-                        // Notifier les spectateurs
-                        char spec_msg[200];
-                        snprintf(spec_msg, sizeof(spec_msg), 
-                                "END %s s'est déconnecté. %s gagne par forfait!\n",
-                                clients[i].username, 
-                                opponent_idx >= 0 ? clients[opponent_idx].username : "Adversaire");
-                        for (int j = 0; j < g->num_spectators; j++) {
-                            int spec_idx = g->spectator_indices[j];
-                            if (spec_idx >= 0 && clients[spec_idx].socket_fd > 0) {
-                                send_line(clients[spec_idx].socket_fd, spec_msg);
-                                clients[spec_idx].status = CLIENT_WAITING;
-                                clients[spec_idx].watching_game = -1;
-                            }
-                        }
-                    }
+            } else {
+                // Pas d'adversaire connecté, sauvegarder si le joueur déconnecté avait le mode actif
+                if (clients[i].save_mode) {
+                    save_game(g, g->end_result);
                 }
-                // Si le client était en train de répondre à une demande de sauvegarde
-                else if (clients[i].status == CLIENT_ASKED_SAVE) {
-                    int game_idx = clients[i].game_to_save;
-                    if (game_idx >= 0 && game_idx < MAX_CLIENTS / 2 && games[game_idx].ending) {
-                        // Considérer la déconnexion comme un "NO"
-                        clients[i].save_response = 0;
-                        games[game_idx].responses_received++;
-                        
-                        // Compter combien de joueurs sont encore connectés
-                        int connected_players = 0;
-                        for (int j = 0; j < 2; j++) {
-                            int player_idx = games[game_idx].client_indices[j];
-                            if (player_idx >= 0 && player_idx != i && clients[player_idx].socket_fd > 0) {
-                                connected_players++;
-                            }
-                        }
-                        
-                        // Si on a reçu toutes les réponses, finaliser la partie
-                        if (games[game_idx].responses_received >= connected_players + 1) {
-                            finalize_game_end(&games[game_idx], game_idx);
-                        }
-                    }
+                g->active = 0;
+                g->num_spectators = 0;
+            }
+    
+            // Notifier les spectateurs
+            char spec_msg[200];
+            snprintf(spec_msg, sizeof(spec_msg), 
+                    "END %s s'est déconnecté. %s gagne par forfait!\n",
+                    clients[i].username, 
+                    opponent_idx >= 0 ? clients[opponent_idx].username : "Adversaire");
+            broadcast_line(g, spec_msg, TO_SPECTATORS, -1);
+            for (int j = 0; j < g->num_spectators; j++) {
+                int spec_idx = g->spectator_indices[j];
+                if (spec_idx >= 0 && clients[spec_idx].socket_fd > 0) {
+                    clients[spec_idx].status = CLIENT_WAITING;
+                    clients[spec_idx].watching_game = -1;
                 }
-                // Si le client était spectateur, le retirer de la liste
-                else if (clients[i].status == CLIENT_SPECTATING) {
-                    Game* g = &games[clients[i].watching_game];
-                    for (int j = 0; j < g->num_spectators; j++) {
-                        if (g->spectator_indices[j] == i) {
-                            for (int k = j; k < g->num_spectators - 1; k++) {
-                                g->spectator_indices[k] = g->spectator_indices[k + 1];
-                            }
-                            g->num_spectators--;
-                            break;
-                        }
-                    }
+            }
+        }
+    }
+    // Si le client était en train de répondre à une demande de sauvegarde
+    else if (clients[i].status == CLIENT_ASKED_SAVE) {
+        int game_idx = clients[i].game_to_save;
+        if (game_idx >= 0 && game_idx < MAX_GAMES && games[game_idx].ending) {
+            // Considérer la déconnexion comme un "NO"
+            clients[i].save_response = 0;
+            games[game_idx].responses_received++;
+    
+            // Compter combien de joueurs sont encore connectés
+            int connected_players = 0;
+            for (int j = 0; j < 2; j++) {
+                int player_idx = games[game_idx].client_indices[j];
+                if (player_idx >= 0 && player_idx != i && owned(player_idx) && clients[player_idx].socket_fd > 0) {
+                    connected_players++;
                 }
-                
-                close(clients[i].socket_fd);
-                clients[i].socket_fd = -1;
-                clients[i].status = CLIENT_WAITING;
-                clients[i].opponent_index = -1;
-                clients[i].challenged_by = -1;
-                clients[i].watching_game = -1;
-                continue;
             }
-            
-            // Si le client est en attente de son username
-            if (clients[i].status == CLIENT_CONNECTED) {
-                if (strncmp(buf, "USERNAME ", 9) == 0) {
-                    char username[MAX_USERNAME_LEN];
-                    strncpy(username, buf + 9, MAX_USERNAME_LEN - 1);
-                    username[MAX_USERNAME_LEN - 1] = '\0';
-                    
-                    // Valider le format du username
-                    if (!is_valid_username(username)) {
-                        send_line(clients[i].socket_fd, "MSG Username invalide. Il doit contenir au moins 2 caractères alphanumériques, _ ou -. Déconnexion.\n");
-                        close(clients[i].socket_fd);
-                        clients[i].socket_fd = -1;
-                        printf("Connexion refusée: username '%s' invalide (format)\n", username);
-                        continue;
-                    }
-                    
-                    // Chercher si ce username existe déjà (connecté ou non)
-                    int existing_idx = find_client_by_username_any(username);
-                    int connected_idx = find_client_by_username(username);
-                    
-                    // Si le username est déjà connecté ailleurs
-                    if (connected_idx != -1) {
-                        send_line(clients[i].socket_fd, "MSG Username déjà connecté. Déconnexion.\n");
-                        close(clients[i].socket_fd);
-                        clients[i].socket_fd = -1;
-                        printf("Connexion refusée: username '%s' déjà connecté\n", username);
-                        continue;
-                    }
-                    
-                    // Si le username existe déjà (reconnexion)
-                    if (existing_idx != -1 && existing_idx != i) {
-                        // Copier les données de l'ancien slot vers le nouveau
-                        clients[i].elo_score = clients[existing_idx].elo_score;
-                        clients[i].num_friends = clients[existing_idx].num_friends;
-                        clients[i].num_friend_requests = clients[existing_idx].num_friend_requests;
-                        clients[i].bio_lines = clients[existing_idx].bio_lines;
-                        clients[i].private_mode = clients[existing_idx].private_mode;
-                        clients[i].save_mode = clients[existing_idx].save_mode;
-                        
-                        memcpy(clients[i].friends, clients[existing_idx].friends, sizeof(clients[i].friends));
-                        memcpy(clients[i].friend_requests, clients[existing_idx].friend_requests, sizeof(clients[i].friend_requests));
-                        memcpy(clients[i].bio, clients[existing_idx].bio, sizeof(clients[i].bio));
-                        
-                        // Effacer l'ancien slot (devenu obsolète)
-                        clients[existing_idx].username[0] = '\0';
-                        
-                        strcpy(clients[i].username, username);
-                        clients[i].status = CLIENT_WAITING;
-                        
-                        char welcome[128];
-                        snprintf(welcome, sizeof(welcome), "MSG Bon retour %s! (ELO: %d)\n", username, clients[i].elo_score);
-                        send_line(clients[i].socket_fd, welcome);
-                        
-                        printf("Client reconnecté: %s (ELO: %d)\n", username, clients[i].elo_score);
+    
+            // Si on a reçu toutes les réponses, finaliser la partie
+            if (games[game_idx].responses_received >= connected_players + 1) {
+                finalize_game_end(&games[game_idx], game_idx);
+            }
+        }
+    }
+    // Si le client était spectateur, le retirer de la liste
+    else if (clients[i].status == CLIENT_SPECTATING) {
+        remove_spectator(&games[clients[i].watching_game], i);
+    }
+    
+    // Les défis qu'il a lancés tombent, sur tous les shards
+    broadcast_mail(MAIL_CANCEL_CHALLENGES, i, clients[i].username, NULL);
+    
+    close_client_socket(i);
+    clients[i].status = CLIENT_WAITING;
+    clients[i].opponent_index = -1;
+    clients[i].challenged_by = -1;
+    clients[i].watching_game = -1;
+}
+
+/**
+ * Conclut la proposition d'égalité en cours : acceptée, la partie se termine
+ * sur une égalité ; refusée, la partie continue
+ */
+static void answer_draw_offer(Game* g, int game_idx, int accepted) {
+    int proposer_idx = g->client_indices[g->draw_offer_by];
+    int opponent_idx = g->client_indices[1 - g->draw_offer_by];
+    g->draw_offer_by = -1;
+    timer_cancel(&current_reactor->timers, &g->draw_timer);
+    
+    if (accepted) {
+        send_line(clients[g->client_indices[0]].socket_fd, "MSG Égalité acceptée.\n");
+        send_line(clients[g->client_indices[1]].socket_fd, "MSG Égalité acceptée.\n");
+        send_line(clients[g->client_indices[0]].socket_fd, "END draw\n");
+        send_line(clients[g->client_indices[1]].socket_fd, "END draw\n");
+    
+        printf("Égalité acceptée entre [%s] et [%s]\n",
+               clients[g->client_indices[0]].username,
+               clients[g->client_indices[1]].username);
+    
+        // Terminer la partie
+        end_game(g, "END draw\n", game_idx);
+    } else {
+        send_line(clients[proposer_idx].socket_fd, "MSG Égalité refusée.\n");
+        send_line(clients[opponent_idx].socket_fd, "MSG Égalité refusée par l'adversaire.\n");
+        broadcast_game_state(g);
+    
+        printf("[%s] a refusé l'égalité proposée par [%s]\n",
+               clients[opponent_idx].username, clients[proposer_idx].username);
+    }
+}
+
+/**
+ * Réponse d'un joueur à ASKSAVE (YES ou NO) ; la partie est finalisée
+ * quand tous les joueurs encore connectés ont répondu
+ */
+static void answer_save_prompt(int i, int save) {
+    clients[i].save_response = save;
+    timer_cancel(&current_reactor->timers, &clients[i].save_timer);
+    
+    // Enregistrer la réponse dans la partie
+    int game_idx = clients[i].game_to_save;
+    if (game_idx >= 0 && game_idx < MAX_GAMES && games[game_idx].ending) {
+        games[game_idx].responses_received++;
+        games[game_idx].save_requested |= save;
+    
+        // Libérer immédiatement ce joueur
+        clients[i].status = CLIENT_WAITING;
+        clients[i].game_to_save = -1;
+        send_line(clients[i].socket_fd, "MSG Réponse enregistrée.\n");
+    
+        // Compter combien de joueurs sont encore connectés (un joueur qui a
+        // répondu peut être passé à un autre shard : il ne compte plus)
+        int connected_players = 0;
+        for (int j = 0; j < 2; j++) {
+            int player_idx = games[game_idx].client_indices[j];
+            if (player_idx >= 0 && owned(player_idx) && clients[player_idx].socket_fd > 0) {
+                connected_players++;
+            }
+        }
+    
+        // Si on a reçu toutes les réponses, finaliser la partie
+        if (games[game_idx].responses_received >= connected_players) {
+            finalize_game_end(&games[game_idx], game_idx);
+        }
+    }
+}
+
+/**
+ * Coupe un client depuis un timer : comme pour un client trop lent, son
+ * socket est fermé en lecture et la lecture, qui voit la fin de connexion,
+ * fait la déconnexion habituelle (la raison, mise en file, part avant la
+ * fermeture)
+ */
+static void expel_client(int i, const char* reason) {
+    printf("Client %s : %s", clients[i].username[0] ? clients[i].username : "(sans nom)", reason + 4);
+    send_line(clients[i].socket_fd, reason);
+    shutdown(clients[i].socket_fd, SHUT_RD);
+}
+
+/**
+ * Timer d'un client : délai d'inscription, battement de cœur (PING après
+ * heartbeat_s de silence, déconnexion sans réponse en PONG_TIMEOUT_S) et
+ * inactivité au salon. Les échéances dépendent d'heures mises à jour à
+ * chaque réception : le timer n'est pas déplacé à chaque ligne, il est
+ * réarmé ici sur la plus proche.
+ */
+static void check_client(int i, uint64_t now) {
+    Client* c = &clients[i];
+    if (c->socket_fd <= 0) {
+        return;
+    }
+    if (c->status == CLIENT_CONNECTED) {
+        uint64_t deadline = c->connected_at + REGISTER_TIMEOUT_S * 1000;
+        if (now >= deadline) {
+            expel_client(i, "MSG Pas de username reçu à temps. Déconnexion.\n");
+        } else {
+            timer_arm(&current_reactor->timers, &c->timer, deadline - now, now);
+        }
+        return;
+    }
+    
+    uint64_t next = UINT64_MAX;
+    if (c->status == CLIENT_WAITING || c->status == CLIENT_EDITING_BIO) {
+        uint64_t deadline = c->last_command + IDLE_TIMEOUT_S * 1000ULL;
+        if (now >= deadline) {
+            expel_client(i, "MSG Inactif depuis trop longtemps. Déconnexion.\n");
+            return;
+        }
+        next = deadline;
+    }
+    if (heartbeat_s > 0) {
+        if (c->ping_sent > 0 && c->last_input >= c->ping_sent) {
+            c->ping_sent = 0;  // Réponse (ou autre donnée) reçue
+        }
+        if (c->ping_sent > 0) {
+            uint64_t deadline = c->ping_sent + PONG_TIMEOUT_S * 1000;
+            if (now >= deadline) {
+                expel_client(i, "MSG Pas de réponse au PING. Déconnexion.\n");
+                return;
+            }
+            next = deadline < next ? deadline : next;
+        } else {
+            uint64_t ping_at = c->last_input + heartbeat_s * 1000ULL;
+            if (now >= ping_at) {
+                send_line(c->socket_fd, "PING\n");
+                c->ping_sent = now;
+                ping_at = now + PONG_TIMEOUT_S * 1000;
+            }
+            next = ping_at < next ? ping_at : next;
+        }
+    }
+    if (next == UINT64_MAX) {
+        next = now + IDLE_TIMEOUT_S * 1000ULL;  // En partie sans battement : revoir plus tard
+    }
+    timer_arm(&current_reactor->timers, &c->timer, next - now, now);
+}
+
+/**
+ * Défi resté sans réponse : il tombe, les deux joueurs sont prévenus
+ */
+static void expire_challenge(int i) {
+    int challenger_idx = clients[i].challenged_by;
+    if (challenger_idx < 0) {
+        return;
+    }
+    clients[i].challenged_by = -1;
+    char challenger[MAX_USERNAME_LEN];
+    get_username(challenger_idx, challenger);
+    char msg[128];
+    snprintf(msg, sizeof(msg), "MSG Le défi de %s a expiré.\n", challenger);
+    send_line(clients[i].socket_fd, msg);
+    snprintf(msg, sizeof(msg), "MSG %s n'a pas répondu à votre défi.\n", clients[i].username);
+    deliver(challenger_idx, clients[i].challenged_session, msg);
+    printf("Défi de [%s] à [%s] expiré\n", challenger, clients[i].username);
+}
+
+/**
+ * Retire une proposition d'égalité restée sans réponse après DRAW_TIMEOUT_S
+ */
+static void expire_draw_offer(int game_idx) {
+    Game* g = &games[game_idx];
+    if (!g->active || g->ending || g->draw_offer_by == -1) {
+        return;
+    }
+    int proposer_idx = g->client_indices[g->draw_offer_by];
+    int opponent_idx = g->client_indices[1 - g->draw_offer_by];
+    g->draw_offer_by = -1;
+    send_line(clients[proposer_idx].socket_fd, "MSG Pas de réponse : égalité refusée.\n");
+    send_line(clients[opponent_idx].socket_fd, "MSG Délai écoulé, proposition d'égalité retirée.\n");
+    broadcast_game_state(g);
+    printf("Proposition d'égalité de [%s] expirée\n", clients[proposer_idx].username);
+}
+
+/**
+ * Traite les timers échus du shard courant ; retourne le délai en ms
+ * jusqu'à la prochaine échéance, -1 s'il n'y en a aucune (attente sans
+ * limite de la boucle principale)
+ */
+static int run_timers(void) {
+    uint64_t now = timer_now_ms();
+    Timer* t;
+    while ((t = timer_next_expired(&current_reactor->timers, now)) != NULL) {
+        if (t->kind == TIMER_CLIENT) {
+            check_client(t->idx, now);
+        } else if (t->kind == TIMER_CHALLENGE) {
+            expire_challenge(t->idx);
+        } else if (t->kind == TIMER_SAVE) {
+            if (clients[t->idx].status == CLIENT_ASKED_SAVE) {
+                send_line(clients[t->idx].socket_fd, "MSG Pas de réponse : partie non sauvegardée de votre côté.\n");
+                answer_save_prompt(t->idx, 0);
+            }
+        } else if (t->kind == TIMER_DRAW) {
+            expire_draw_offer(t->idx);
+        }
+    }
+    return timer_timeout_ms(&current_reactor->timers, now);
+}
+
+static __thread int replaying;  // Commande rejouée après un transfert : pas de second transfert
+
+/**
+ * Remet le client i au shard du courrier MAIL_ADOPT m : ses timers sont
+ * annulés ici et réarmés là-bas, l'annuaire le désigne avant que le
+ * courrier parte
+ */
+static void hand_off(int i, Mail* m) {
+    Reactor* r = current_reactor;
+    Reactor* to = m->data;
+    timer_cancel(&r->timers, &clients[i].timer);
+    timer_cancel(&r->timers, &clients[i].challenge_timer);
+    timer_cancel(&r->timers, &clients[i].save_timer);
+    unschedule_flush(r, i);
+    r->owns[i] = 0;
+    r->moving[i] = NULL;
+    clients[i].reactor = to->id;
+    pthread_mutex_lock(&directory_lock);
+    directory[i].shard = to->id;
+    post_mail(to, m);
+    pthread_mutex_unlock(&directory_lock);
+}
+
+/**
+ * Transfère le client i au shard `shard`, où sa commande line est rejouée.
+ * Avec epoll, le socket quitte l'epoll du shard et part tout de suite ; avec
+ * io_uring, le recv multishot est annulé et le transfert attend sa dernière
+ * complétion et la fin de l'envoi en cours. D'ici là, le client n'envoie ni
+ * ne traite plus rien sur ce shard.
+ */
+static void migrate_client(int i, int shard, const char* line) {
+    Mail* m = new_mail(MAIL_ADOPT, i, clients[i].session, line);
+    if (m == NULL) {
+        return;
+    }
+    m->data = &reactors[shard];
+#ifndef USE_SELECT
+    Reactor* r = current_reactor;
+    if (r->ring != NULL) {
+        r->moving[i] = m;
+        if (clients[i].recv_pending) {
+            uring_cancel(r->ring, URING_DATA(URING_RECV, i), URING_DATA(URING_CANCEL, i));
+        } else if (clients[i].output.inflight == 0) {
+            hand_off(i, m);
+        }
+        return;
+    }
+    epoll_ctl(r->epoll_fd, EPOLL_CTL_DEL, clients[i].socket_fd, NULL);
+#endif
+    hand_off(i, m);
+}
+
+/**
+ * Traite une ligne reçue d'un client
+ */
+static void handle_client_input(int i, char* buf) {
+    // Réponse au battement de cœur : la réception a déjà mis last_input à jour
+    if (!strcmp(buf, "PONG")) {
+        return;
+    }
+    clients[i].last_command = clients[i].last_input;
+    
+    // Si le client est en attente de son username
+    if (clients[i].status == CLIENT_CONNECTED) {
+        if (strncmp(buf, "USERNAME ", 9) == 0) {
+            // "USERNAME <nom> V2 [DELTA]" : le client passe aux trames dès
+            // maintenant, réponses à cette ligne comprises
+            char* token;
+            while ((token = strrchr(buf + 9, ' ')) != NULL) {
+                if (!strcmp(token + 1, PROTO_V2_TOKEN)) {
+                    clients[i].proto = 2;
+                } else if (!strcmp(token + 1, PROTO_DELTA_TOKEN)) {
+                    clients[i].delta = 1;
+                } else {
+                    break;
+                }
+                *token = '\0';
+            }
+            if (clients[i].proto != 2) {
+                clients[i].delta = 0;  // Les deltas n'existent qu'en trames
+            }
+    
+            char username[MAX_USERNAME_LEN];
+            strncpy(username, buf + 9, MAX_USERNAME_LEN - 1);
+            username[MAX_USERNAME_LEN - 1] = '\0';
+    
+            // Valider le format du username
+            if (!is_valid_username(username)) {
+                send_line(clients[i].socket_fd, "MSG Username invalide. Il doit contenir au moins 2 caractères alphanumériques, _ ou -. Déconnexion.\n");
+                close_client_socket(i);
+                printf("Connexion refusée: username '%s' invalide (format)\n", username);
+                return;
+            }
+    
+            // Chercher si ce username existe déjà (connecté ou non), sous
+            // l'annuaire : un autre shard ne peut pas inscrire le même nom
+            // entre la recherche et l'inscription
+            pthread_mutex_lock(&directory_lock);
+            int existing_idx = -1;
+            int connected_idx = -1;
+            for (int j = 0; j < num_clients; j++) {
+                if (j != i && strcmp(directory[j].username, username) == 0) {
+                    if (directory[j].online) {
+                        connected_idx = j;
+                    } else {
+                        existing_idx = j;
                     }
-                    // Nouveau username
-                    else {
-                        strcpy(clients[i].username, username);
-                        clients[i].status = CLIENT_WAITING;
-                        
-                        char welcome[128];
-                        snprintf(welcome, sizeof(welcome), "MSG Bienvenue %s! Tapez '/list' pour voir les joueurs disponibles.\n", username);
-                        send_line(clients[i].socket_fd, welcome);
-                        
-                        printf("Nouveau client connecté: %s\n", username);
+                }
+            }
+    
+            if (connected_idx == -1 && existing_idx != -1) {
+                // Copier les données de l'ancien slot vers le nouveau : hors
+                // ligne, il n'est plus touché par son shard
+                clients[i].elo_score = clients[existing_idx].elo_score;
+                clients[i].num_friends = clients[existing_idx].num_friends;
+                clients[i].num_friend_requests = clients[existing_idx].num_friend_requests;
+                clients[i].bio_lines = clients[existing_idx].bio_lines;
+                clients[i].private_mode = clients[existing_idx].private_mode;
+                clients[i].save_mode = clients[existing_idx].save_mode;
+    
+                memcpy(clients[i].friends, clients[existing_idx].friends, sizeof(clients[i].friends));
+                memcpy(clients[i].friend_requests, clients[existing_idx].friend_requests, sizeof(clients[i].friend_requests));
+                memcpy(clients[i].bio, clients[existing_idx].bio, sizeof(clients[i].bio));
+    
+                // Effacer l'ancien slot (devenu obsolète, il pourra être repris)
+                directory[existing_idx].username[0] = '\0';
+            }
+            if (connected_idx == -1) {
+                strcpy(directory[i].username, username);
+            }
+            pthread_mutex_unlock(&directory_lock);
+    
+            // Si le username est déjà connecté ailleurs
+            if (connected_idx != -1) {
+                send_line(clients[i].socket_fd, "MSG Username déjà connecté. Déconnexion.\n");
+                close_client_socket(i);
+                printf("Connexion refusée: username '%s' déjà connecté\n", username);
+                return;
+            }
+    
+            // Si le username existe déjà (reconnexion)
+            if (existing_idx != -1) {
+                strcpy(clients[i].username, username);
+                clients[i].status = CLIENT_WAITING;
+    
+                char welcome[128];
+                snprintf(welcome, sizeof(welcome), "MSG Bon retour %s! (ELO: %d)\n", username, clients[i].elo_score);
+                send_line(clients[i].socket_fd, welcome);
+    
+                printf("Client reconnecté: %s (ELO: %d)\n", username, clients[i].elo_score);
+            }
+            // Nouveau username
+            else {
+                strcpy(clients[i].username, username);
+                clients[i].status = CLIENT_WAITING;
+    
+                char welcome[128];
+                snprintf(welcome, sizeof(welcome), "MSG Bienvenue %s! Tapez '/list' pour voir les joueurs disponibles.\n", username);
+                send_line(clients[i].socket_fd, welcome);
+    
+                printf("Nouveau client connecté: %s\n", username);
+            }
+        } else {
+            // Message inattendu, ignorer
+            send_line(clients[i].socket_fd, "MSG Veuillez envoyer votre username avec 'USERNAME <nom>'.\n");
+        }
+        return;
+    }
+    
+    // Si le client répond à une demande de sauvegarde
+    if (clients[i].status == CLIENT_ASKED_SAVE) {
+        answer_save_prompt(i, !strcmp(buf, "YES"));
+        return;
+    }
+    
+    // Si le client est en train d'éditer sa bio
+    if (clients[i].status == CLIENT_EDITING_BIO) {
+        // Ligne vide = fin de la bio
+        if (strlen(buf) == 0) {
+            clients[i].status = CLIENT_WAITING;
+            char msg[128];
+            snprintf(msg, sizeof(msg), "MSG Bio enregistrée (%d ligne(s)).\n", clients[i].bio_lines);
+            send_line(clients[i].socket_fd, msg);
+            printf("[%s] a défini sa bio (%d lignes)\n", clients[i].username, clients[i].bio_lines);
+            return;
+        }
+    
+        // Ajouter la ligne si on n'a pas atteint la limite
+        if (clients[i].bio_lines < MAX_BIO_LINES) {
+            strncpy(clients[i].bio[clients[i].bio_lines], buf, MAX_BIO_LINE_LEN - 1);
+            clients[i].bio[clients[i].bio_lines][MAX_BIO_LINE_LEN - 1] = '\0';
+            clients[i].bio_lines++;
+    
+            if (clients[i].bio_lines < MAX_BIO_LINES) {
+                char prompt[64];
+                snprintf(prompt, sizeof(prompt), "MSG Ligne %d: \n", clients[i].bio_lines + 1);
+                send_line(clients[i].socket_fd, prompt);
+            } else {
+                // Limite atteinte, terminer automatiquement
+                clients[i].status = CLIENT_WAITING;
+                char msg[128];
+                snprintf(msg, sizeof(msg), "MSG Bio enregistrée (%d lignes - limite atteinte).\n", clients[i].bio_lines);
+                send_line(clients[i].socket_fd, msg);
+                printf("[%s] a défini sa bio (%d lignes)\n", clients[i].username, clients[i].bio_lines);
+            }
+        }
+        return;
+    }
+    
+    // Si le client est spectateur, il ne peut que faire stopwatch, CHAT ou RESYNC
+    if (clients[i].status == CLIENT_SPECTATING) {
+        if (!strcmp(buf, "STOPWATCH")) {
+            // Retirer le spectateur
+            remove_spectator(&games[clients[i].watching_game], i);
+    
+            clients[i].status = CLIENT_WAITING;
+            clients[i].watching_game = -1;
+    
+            send_line(clients[i].socket_fd, "MSG Vous avez arrêté de regarder la partie.\n");
+            printf("%s a arrêté de regarder\n", clients[i].username);
+        } else if (!strcmp(buf, "RESYNC")) {
+            send_game_state(&games[clients[i].watching_game], i);
+        } else if (!strncmp(buf, "CHAT ", 5)) {
+            // Les spectateurs peuvent envoyer des messages dans le chat de la partie
+            char* message = buf + 5;
+            Game* g = &games[clients[i].watching_game];
+            char chat_msg[512];
+            snprintf(chat_msg, sizeof(chat_msg), "CHAT [Spectateur %s]: %s\n", 
+                     clients[i].username, message);
+    
+            // Envoyer aux joueurs et aux autres spectateurs (SAUF l'expéditeur)
+            broadcast_line(g, chat_msg, TO_PLAYERS | TO_SPECTATORS, i);
+        } else {
+            send_line(clients[i].socket_fd, "MSG Vous êtes en mode spectateur. Tapez '/stopwatch' pour quitter ou envoyez un message.\n");
+        }
+        return;
+    }
+    
+    // Commande LIST - Demander la liste des utilisateurs
+    if (!strcmp(buf, "LIST")) {
+        request_gather(i, 0);
+        printf("[%s] a demandé la liste des joueurs\n", clients[i].username);
+    }
+    // Commande GAMES - Demander la liste des parties en cours
+    else if (!strcmp(buf, "GAMES")) {
+        request_gather(i, 1);
+        printf("[%s] a demandé la liste des parties\n", clients[i].username);
+    }
+    // Commande BOARD - Afficher le plateau (pour joueur ou spectateur en partie)
+    else if (!strcmp(buf, "BOARD")) {
+        if (clients[i].status == CLIENT_IN_GAME) {
+            Game* g = find_game_for_client(i);
+            if (g) {
+                send_game_state(g, i);
+                printf("[%s] a demandé le plateau (en partie)\n", clients[i].username);
+            }
+        } else if (clients[i].status == CLIENT_SPECTATING) {
+            Game* g = &games[clients[i].watching_game];
+            send_game_state(g, i);
+            printf("[%s] a demandé le plateau (spectateur)\n", clients[i].username);
+        } else {
+            send_line(clients[i].socket_fd, "MSG Vous n'êtes pas en partie.\n");
+        }
+    }
+    // Commande RESYNC - Position complète (client DELTA qui a constaté un trou)
+    else if (!strcmp(buf, "RESYNC")) {
+        Game* g = clients[i].status == CLIENT_IN_GAME ? find_game_for_client(i) : NULL;
+        if (g) {
+            send_game_state(g, i);
+        }
+    }
+    // Commande BIO - Définir sa bio (mode édition interactive)
+    else if (!strcmp(buf, "BIO")) {
+        if (clients[i].status != CLIENT_WAITING) {
+            send_line(clients[i].socket_fd, "MSG Vous ne pouvez éditer votre bio que depuis le lobby.\n");
+        } else {
+            clients[i].status = CLIENT_EDITING_BIO;
+            clients[i].bio_lines = 0;
+            send_line(clients[i].socket_fd, "MSG Entrez votre bio (max 10 lignes, ligne vide pour terminer):\n");
+            send_line(clients[i].socket_fd, "MSG Ligne 1: \n");
+            printf("[%s] commence à éditer sa bio\n", clients[i].username);
+        }
+    }
+    // Commande WHOIS - Afficher la bio d'un joueur
+    else if (!strncmp(buf, "WHOIS ", 6)) {
+        char target[MAX_USERNAME_LEN];
+        strncpy(target, buf + 6, MAX_USERNAME_LEN - 1);
+        target[MAX_USERNAME_LEN - 1] = '\0';
+    
+        DirectoryEntry entry;
+        int target_idx = lookup_user(target, &entry);
+    
+        if (target_idx == -1) {
+            send_line(clients[i].socket_fd, "MSG Utilisateur introuvable.\n");
+        } else {
+            // La bio est lue par le shard du joueur, qui répond
+            send_mail(MAIL_WHOIS, target_idx, entry.session, i, "");
+            printf("[%s] a consulté la bio de [%s]\n", clients[i].username, target);
+        }
+    }
+    // Commande ADDFRIEND - Ajouter un ami
+    else if (!strncmp(buf, "ADDFRIEND ", 10)) {
+        char friend_name[MAX_USERNAME_LEN];
+        strncpy(friend_name, buf + 10, MAX_USERNAME_LEN - 1);
+        friend_name[MAX_USERNAME_LEN - 1] = '\0';
+    
+        DirectoryEntry entry;
+        int friend_idx = lookup_user(friend_name, &entry);
+    
+        if (friend_idx == -1) {
+            send_line(clients[i].socket_fd, "MSG Utilisateur introuvable.\n");
+        } else if (friend_idx == i) {
+            send_line(clients[i].socket_fd, "MSG Vous ne pouvez pas vous ajouter vous-même comme ami.\n");
+        } else if (is_friend(i, friend_name)) {
+            send_line(clients[i].socket_fd, "MSG Cet utilisateur est déjà votre ami.\n");
+        } else {
+            // Envoyer une demande d'ami : le shard du destinataire l'enregistre et répond
+            send_mail(MAIL_FRIEND_REQUEST, friend_idx, entry.session, i, clients[i].username);
+        }
+    }
+    // Commande ACCEPTFRIEND - Accepter une demande d'ami
+    else if (!strncmp(buf, "ACCEPTFRIEND ", 13)) {
+        char friend_name[MAX_USERNAME_LEN];
+        strncpy(friend_name, buf + 13, MAX_USERNAME_LEN - 1);
+        friend_name[MAX_USERNAME_LEN - 1] = '\0';
+    
+        if (!has_friend_request(i, friend_name)) {
+            send_line(clients[i].socket_fd, "MSG Vous n'avez pas de demande d'ami de cet utilisateur.\n");
+        } else {
+            DirectoryEntry entry;
+            int friend_idx = lookup_user(friend_name, &entry);
+    
+            // Ajouter l'ami des deux côtés (chez l'autre joueur, par son shard)
+            int result = add_friend(i, friend_name);
+    
+            if (result == 1 && friend_idx != -1) {
+                // Retirer la demande
+                remove_friend_request(i, friend_name);
+    
+                char msg[128];
+                snprintf(msg, sizeof(msg), "MSG Vous êtes maintenant ami avec %s.\n", friend_name);
+                send_line(clients[i].socket_fd, msg);
+    
+                // Ajouter chez l'autre joueur et le notifier
+                send_mail(MAIL_FRIEND_ACCEPTED, friend_idx, entry.session, i, clients[i].username);
+    
+                printf("[%s] et [%s] sont maintenant amis\n", clients[i].username, friend_name);
+            } else {
+                send_line(clients[i].socket_fd, "MSG Erreur: liste d'amis pleine.\n");
+            }
+        }
+    }
+    // Commande LISTFRIENDREQUESTS - Lister les demandes d'amis reçues
+    else if (!strcmp(buf, "LISTFRIENDREQUESTS")) {
+        char line[256];
+    
+        snprintf(line, sizeof(line), "MSG === Demandes d'amis reçues (%d) ===\n", clients[i].num_friend_requests);
+        send_line(clients[i].socket_fd, line);
+    
+        if (clients[i].num_friend_requests == 0) {
+            send_line(clients[i].socket_fd, "MSG Aucune demande d'ami en attente.\n");
+        } else {
+            for (int j = 0; j < clients[i].num_friend_requests; j++) {
+                snprintf(line, sizeof(line), "MSG - %s (tapez '/acceptfriend %s' pour accepter)\n", 
+                        clients[i].friend_requests[j], clients[i].friend_requests[j]);
+                send_line(clients[i].socket_fd, line);
+            }
+        }
+    
+        send_line(clients[i].socket_fd, "MSG ==============================\n");
+    }
+    // Commande REMOVEFRIEND - Retirer un ami
+    else if (!strncmp(buf, "REMOVEFRIEND ", 13)) {
+        char friend_name[MAX_USERNAME_LEN];
+        strncpy(friend_name, buf + 13, MAX_USERNAME_LEN - 1);
+        friend_name[MAX_USERNAME_LEN - 1] = '\0';
+    
+        int result = remove_friend(i, friend_name);
+        if (result == 1) {
+            char msg[128];
+            snprintf(msg, sizeof(msg), "MSG %s a été retiré de votre liste d'amis.\n", friend_name);
+            send_line(clients[i].socket_fd, msg);
+            printf("[%s] a retiré [%s] de sa liste d'amis\n", clients[i].username, friend_name);
+        } else {
+            send_line(clients[i].socket_fd, "MSG Cet utilisateur n'est pas dans votre liste d'amis.\n");
+        }
+    }
+    // Commande LISTFRIENDS - Lister ses amis
+    else if (!strcmp(buf, "LISTFRIENDS")) {
+        char line[256];
+    
+        snprintf(line, sizeof(line), "MSG === Vos amis (%d/%d) ===\n", clients[i].num_friends, MAX_FRIENDS);
+        send_line(clients[i].socket_fd, line);
+    
+        if (clients[i].num_friends == 0) {
+            send_line(clients[i].socket_fd, "MSG Aucun ami dans votre liste.\n");
+        } else {
+            for (int j = 0; j < clients[i].num_friends; j++) {
+                snprintf(line, sizeof(line), "MSG - %s\n", clients[i].friends[j]);
+                send_line(clients[i].socket_fd, line);
+            }
+        }
+    
+        send_line(clients[i].socket_fd, "MSG ==================\n");
+    }
+    // Commande PRIVATE - Toggle du mode privé
+    else if (!strcmp(buf, "PRIVATE")) {
+        // Inverser le mode privé
+        clients[i].private_mode = !clients[i].private_mode;
+    
+        if (clients[i].private_mode) {
+            send_line(clients[i].socket_fd, "MSG Mode privé activé. Seuls vos amis pourront regarder vos parties.\n");
+            printf("[%s] a activé le mode privé\n", clients[i].username);
+        } else {
+            send_line(clients[i].socket_fd, "MSG Mode privé désactivé. Tout le monde peut regarder vos parties.\n");
+            printf("[%s] a désactivé le mode privé\n", clients[i].username);
+        }
+    }
+    // Commande SAVE - Toggle du mode sauvegarde automatique
+    else if (!strcmp(buf, "SAVE")) {
+        // Inverser le mode sauvegarde
+        clients[i].save_mode = !clients[i].save_mode;
+    
+        if (clients[i].save_mode) {
+            send_line(clients[i].socket_fd, "MSG Mode sauvegarde activé. Vos parties seront automatiquement sauvegardées.\n");
+            printf("[%s] a activé le mode sauvegarde\n", clients[i].username);
+        } else {
+            send_line(clients[i].socket_fd, "MSG Mode sauvegarde désactivé. Vos parties ne seront plus sauvegardées automatiquement.\n");
+            printf("[%s] a désactivé le mode sauvegarde\n", clients[i].username);
+        }
+    }
+    // Commande HISTORY - Lister les parties sauvegardées
+    else if (!strcmp(buf, "HISTORY")) {
+        FILE* p = popen("ls -1t saved_games/*.txt 2>/dev/null | head -20", "r");
+        if (!p) {
+            send_line(clients[i].socket_fd, "MSG Aucune partie sauvegardée.\n");
+        } else {
+            char line[512];
+            char response[4096] = "MSG === Parties sauvegardées (max 20) ===\n";
+            int count = 0;
+    
+            while (fgets(line, sizeof(line), p) && count < 20) {
+                // Retirer le \n
+                line[strcspn(line, "\n")] = 0;
+    
+                // Extraire juste le nom du fichier
+                char* filename = strrchr(line, '/');
+                if (filename) filename++;
+                else filename = line;
+    
+                char entry[256];
+                snprintf(entry, sizeof(entry), "%d. %s\n", ++count, filename);
+                strcat(response, entry);
+            }
+    
+            if (count == 0) {
+                strcpy(response, "MSG Aucune partie sauvegardée.\n");
+            } else {
+                strcat(response, "Tapez '/replay <numéro>' pour revoir une partie.\n");
+            }
+    
+            pclose(p);
+            send_line(clients[i].socket_fd, response);
+        }
+    }
+    // Commande REPLAY - Afficher le contenu d'une partie sauvegardée
+    else if (!strncmp(buf, "REPLAY ", 7)) {
+        int game_num = atoi(buf + 7);
+    
+        if (game_num < 1 || game_num > 20) {
+            send_line(clients[i].socket_fd, "MSG Numéro invalide. Tapez '/history' pour voir la liste.\n");
+        } else {
+            // Obtenir le nom du fichier
+            char cmd[256];
+            snprintf(cmd, sizeof(cmd), "ls -1t saved_games/*.txt 2>/dev/null | head -20 | sed -n '%dp'", game_num);
+    
+            FILE* p = popen(cmd, "r");
+            if (!p) {
+                send_line(clients[i].socket_fd, "MSG Erreur lors de la lecture.\n");
+            } else {
+                char filename[256];
+                if (fgets(filename, sizeof(filename), p)) {
+                    filename[strcspn(filename, "\n")] = 0;
+                    pclose(p);
+    
+                    // Lire et envoyer le contenu du fichier
+                    FILE* f = fopen(filename, "r");
+                    if (!f) {
+                        send_line(clients[i].socket_fd, "MSG Impossible d'ouvrir le fichier.\n");
+                    } else {
+                        char response[8192] = "REPLAY\n";
+                        char line[512];
+    
+                        while (fgets(line, sizeof(line), f)) {
+                            strcat(response, line);
+                        }
+    
+                        fclose(f);
+                        send_line(clients[i].socket_fd, response);
+                        printf("[%s] a consulté la partie: %s\n", clients[i].username, filename);
                     }
                 } else {
-                    // Message inattendu, ignorer
-                    send_line(clients[i].socket_fd, "MSG Veuillez envoyer votre username avec 'USERNAME <nom>'.\n");
+                    pclose(p);
+                    send_line(clients[i].socket_fd, "MSG Partie introuvable.\n");
                 }
-                continue;
             }
-            
-            // Si le client répond à une demande de sauvegarde
-            if (clients[i].status == CLIENT_ASKED_SAVE) {
-                if (!strcmp(buf, "YES")) {
-                    clients[i].save_response = 1;
+        }
+    }
+    // Commande WATCH - Regarder une partie
+    else if (!strncmp(buf, "WATCH ", 6)) {
+        int game_id = atoi(buf + 6);
+        int shard = game_id / GAMES_PER_SHARD;
+    
+        if (game_id < 0 || game_id >= MAX_GAMES || shard >= num_reactors) {
+            send_line(clients[i].socket_fd, "MSG Partie introuvable.\n");
+        } else if (shard != current_reactor->id) {
+            // Partie d'un autre shard : le spectateur y passe, WATCH y est rejoué
+            if (clients[i].status != CLIENT_WAITING) {
+                send_line(clients[i].socket_fd, "MSG Vous êtes déjà en partie.\n");
+            } else {
+                migrate_client(i, shard, buf);
+            }
+        } else if (!games[game_id].active) {
+            send_line(clients[i].socket_fd, "MSG Partie introuvable.\n");
+        } else if (!can_spectate(i, &games[game_id])) {
+            send_line(clients[i].socket_fd, "MSG Cette partie est en mode privé. Vous devez être ami avec un des joueurs.\n");
+        } else if (add_spectator(&games[game_id], i) < 0) {
+            send_line(clients[i].socket_fd, "MSG Partie pleine (trop de spectateurs).\n");
+        } else {
+            clients[i].status = CLIENT_SPECTATING;
+            clients[i].watching_game = game_id;
+    
+            char msg[200];
+            snprintf(msg, sizeof(msg), "MSG Vous regardez la partie entre %s et %s.\n",
+                     clients[games[game_id].client_indices[0]].username,
+                     clients[games[game_id].client_indices[1]].username);
+            send_line(clients[i].socket_fd, msg);
+    
+            // Envoyer l'état actuel de la partie
+            send_game_state(&games[game_id], i);
+    
+            printf("%s regarde la partie %d\n", clients[i].username, game_id);
+        }
+    }
+    // Commande CHAT - Envoyer un message à un joueur ou à tous (broadcast)
+    else if (!strncmp(buf, "CHAT ", 5)) {
+        char* message = buf + 5;
+    
+        // Vérifier si c'est un message privé (format: @username message) ou broadcast (format: message)
+        if (message[0] == '@') {
+            // Message privé
+            char* space = strchr(message + 1, ' ');
+            if (space) {
+                *space = '\0';
+                char* target_username = message + 1;
+                char* msg_content = space + 1;
+    
+                DirectoryEntry entry;
+                int target_idx = lookup_user(target_username, &entry);
+    
+                if (target_idx == -1) {
+                    send_line(clients[i].socket_fd, "MSG Utilisateur introuvable.\n");
+                } else if (target_idx == i) {
+                    send_line(clients[i].socket_fd, "MSG Vous ne pouvez pas vous envoyer un message à vous-même.\n");
                 } else {
-                    clients[i].save_response = 0;
+                    // Envoyer le message privé au destinataire ; son shard
+                    // répond à sa place s'il est en train d'éditer sa bio
+                    char chat_msg[512];
+                    snprintf(chat_msg, sizeof(chat_msg), "CHAT [Privé de %s]: %s\n", 
+                             clients[i].username, msg_content);
+                    send_mail(MAIL_PRIVATE_CHAT, target_idx, entry.session, i, chat_msg);
+    
+                    // NE PAS envoyer de confirmation à l'expéditeur (éviter duplication)
                 }
-                
-                // Enregistrer la réponse dans la partie
-                int game_idx = clients[i].game_to_save;
-                if (game_idx >= 0 && game_idx < MAX_CLIENTS / 2 && games[game_idx].ending) {
-                    games[game_idx].responses_received++;
-                    
-                    // Libérer immédiatement ce joueur
-                    clients[i].status = CLIENT_WAITING;
-                    clients[i].game_to_save = -1;
-                    send_line(clients[i].socket_fd, "MSG Réponse enregistrée.\n");
-                    
-                    // Compter combien de joueurs sont encore connectés
-                    int connected_players = 0;
-                    for (int j = 0; j < 2; j++) {
-                        int player_idx = games[game_idx].client_indices[j];
-                        if (player_idx >= 0 && clients[player_idx].socket_fd > 0) {
-                            connected_players++;
+            } else {
+                send_line(clients[i].socket_fd, "MSG Format invalide. Utilisez: chat @username message\n");
+            }
+        } else {
+            // Message broadcast selon le contexte
+            char chat_msg[512];
+    
+            if (clients[i].status == CLIENT_IN_GAME) {
+                // En partie : envoyer à l'adversaire et aux spectateurs
+                Game* g = find_game_for_client(i);
+                if (g) {
+                    snprintf(chat_msg, sizeof(chat_msg), "CHAT [%s]: %s\n", 
+                             clients[i].username, message);
+                    Message m;
+                    message_init(&m, chat_msg);
+    
+                    // Envoyer à l'adversaire
+                    int opponent_idx = clients[i].opponent_index;
+                    if (opponent_idx >= 0 && clients[opponent_idx].status != CLIENT_EDITING_BIO) {
+                        send_message(&m, opponent_idx);
+                    }
+    
+                    // Envoyer aux spectateurs
+                    for (int j = 0; j < g->num_spectators; j++) {
+                        int spec_idx = g->spectator_indices[j];
+                        if (spec_idx >= 0 && clients[spec_idx].status != CLIENT_EDITING_BIO) {
+                            send_message(&m, spec_idx);
                         }
                     }
-                    
-                    // Si on a reçu toutes les réponses, finaliser la partie
-                    if (games[game_idx].responses_received >= connected_players) {
-                        finalize_game_end(&games[game_idx], game_idx);
+                }
+            } else if (clients[i].status == CLIENT_SPECTATING) {
+                // En tant que spectateur : envoyer aux joueurs et autres spectateurs
+                Game* g = &games[clients[i].watching_game];
+                snprintf(chat_msg, sizeof(chat_msg), "CHAT [Spectateur %s]: %s\n", 
+                         clients[i].username, message);
+                Message m;
+                message_init(&m, chat_msg);
+    
+                // Envoyer aux joueurs
+                for (int j = 0; j < 2; j++) {
+                    int player_idx = g->client_indices[j];
+                    if (player_idx >= 0 && clients[player_idx].status != CLIENT_EDITING_BIO) {
+                        send_message(&m, player_idx);
                     }
                 }
-                
-                continue;
-            }
-            
-            // Si le client est en train d'éditer sa bio
-            if (clients[i].status == CLIENT_EDITING_BIO) {
-                // Ligne vide = fin de la bio
-                if (strlen(buf) == 0) {
-                    clients[i].status = CLIENT_WAITING;
-                    char msg[128];
-                    snprintf(msg, sizeof(msg), "MSG Bio enregistrée (%d ligne(s)).\n", clients[i].bio_lines);
-                    send_line(clients[i].socket_fd, msg);
-                    printf("[%s] a défini sa bio (%d lignes)\n", clients[i].username, clients[i].bio_lines);
+    
+                // Envoyer aux autres spectateurs (SAUF l'expéditeur)
+                for (int j = 0; j < g->num_spectators; j++) {
+                    int spec_idx = g->spectator_indices[j];
+                    if (spec_idx >= 0 && spec_idx != i && clients[spec_idx].status != CLIENT_EDITING_BIO) {
+                        send_message(&m, spec_idx);
+                    }
+                }
+            } else {
+                // Hors partie : broadcast à tous les joueurs en ligne (SAUF
+                // l'expéditeur), chaque shard envoie à ses clients
+                snprintf(chat_msg, sizeof(chat_msg), "CHAT [Global - %s]: %s\n", 
+                         clients[i].username, message);
+                broadcast_mail(MAIL_CHAT_ALL, i, chat_msg, NULL);
+            }
+        }
+    }
+    // Commande CHALLENGE - Défier un autre joueur
+    else if (!strncmp(buf, "CHALLENGE ", 10)) {
+        char target[MAX_USERNAME_LEN];
+        strncpy(target, buf + 10, MAX_USERNAME_LEN - 1);
+        target[MAX_USERNAME_LEN - 1] = '\0';
+    
+        DirectoryEntry entry;
+        int target_idx = lookup_user(target, &entry);
+        int bot_level = bot_level_from_name(target);
+    
+        // Défi contre un bot : accepté immédiatement
+        if (bot_level != 0) {
+            if (bot_level < 0) {
+                char msg[128];
+                snprintf(msg, sizeof(msg), "MSG Bot inconnu (%s1 à %s%d).\n", BOT_PREFIX, BOT_PREFIX, BOT_MAX_LEVEL);
+                send_line(clients[i].socket_fd, msg);
+            } else if (clients[i].status != CLIENT_WAITING) {
+                send_line(clients[i].socket_fd, "MSG Vous êtes déjà en partie.\n");
+            } else {
+                int bot_idx = alloc_bot(bot_level);
+                if (bot_idx < 0 || start_game(i, bot_idx) < 0) {
+                    send_line(clients[i].socket_fd, "MSG Serveur plein.\n");
+                } else {
+                    printf("[%s] a défié [%s]\n", clients[i].username, target);
+                }
+            }
+        } else if (target_idx == -1) {
+            send_line(clients[i].socket_fd, "MSG Joueur introuvable.\n");
+        } else if (target_idx == i) {
+            send_line(clients[i].socket_fd, "MSG Vous ne pouvez pas vous défier vous-même.\n");
+        } else {
+            // Le shard du joueur défié enregistre le défi et répond
+            send_mail(MAIL_CHALLENGE, target_idx, entry.session, i, clients[i].username);
+        }
+    }
+    // Commande ACCEPT - Accepter un défi
+    else if (!strncmp(buf, "ACCEPT ", 7)) {
+        char challenger[MAX_USERNAME_LEN];
+        strncpy(challenger, buf + 7, MAX_USERNAME_LEN - 1);
+        challenger[MAX_USERNAME_LEN - 1] = '\0';
+    
+        DirectoryEntry entry;
+        int challenger_idx = lookup_user(challenger, &entry);
+    
+        if (challenger_idx == -1) {
+            send_line(clients[i].socket_fd, "MSG Joueur introuvable.\n");
+        } else if (clients[i].challenged_by != challenger_idx ||
+                   clients[i].challenged_session != entry.session) {
+            // Vérifier que ce joueur a bien envoyé un défi
+            send_line(clients[i].socket_fd, "MSG Ce joueur ne vous a pas défié.\n");
+        } else if (!owned(challenger_idx) || current_reactor->moving[challenger_idx] != NULL) {
+            // Une partie réunit deux clients du même shard : celui qui accepte
+            // passe à celui du challenger, où ACCEPT est rejoué (une seule fois)
+            if (replaying || owned(challenger_idx)) {
+                send_line(clients[i].socket_fd, "MSG Ce joueur n'est plus disponible.\n");
+            } else if (clients[i].status != CLIENT_WAITING) {
+                send_line(clients[i].socket_fd, "MSG Vous êtes déjà en partie.\n");
+            } else {
+                migrate_client(i, entry.shard, buf);
+            }
+        } else if (clients[challenger_idx].status == CLIENT_IN_GAME) {
+            send_line(clients[i].socket_fd, "MSG Ce joueur est déjà en partie.\n");
+        } else {
+            // Créer une nouvelle partie
+            int game_idx = start_game(challenger_idx, i);
+            if (game_idx == -1) {
+                send_line(clients[i].socket_fd, "MSG Serveur plein.\n");
+                return;
+            }
+    
+            printf("[%s] a accepté le défi de [%s] - Partie %d commencée\n",
+                   clients[i].username, challenger, game_idx);
+        }
+    }
+    // Commande REFUSE - Refuser un défi
+    else if (!strncmp(buf, "REFUSE ", 7)) {
+        char challenger[MAX_USERNAME_LEN];
+        strncpy(challenger, buf + 7, MAX_USERNAME_LEN - 1);
+        challenger[MAX_USERNAME_LEN - 1] = '\0';
+    
+        DirectoryEntry entry;
+        int challenger_idx = lookup_user(challenger, &entry);
+    
+        if (challenger_idx == -1) {
+            send_line(clients[i].socket_fd, "MSG Joueur introuvable.\n");
+        } else if (clients[i].challenged_by != challenger_idx ||
+                   clients[i].challenged_session != entry.session) {
+            send_line(clients[i].socket_fd, "MSG Ce joueur ne vous a pas défié.\n");
+        } else {
+            char msg[128];
+            snprintf(msg, sizeof(msg), "MSG %s a refusé votre défi.\n", clients[i].username);
+            deliver(challenger_idx, entry.session, msg);
+    
+            clients[i].challenged_by = -1;  // Réinitialiser le défi
+            timer_cancel(&current_reactor->timers, &clients[i].challenge_timer);
+            send_line(clients[i].socket_fd, "MSG Défi refusé.\n");
+    
+            printf("[%s] a refusé le défi de [%s]\n", clients[i].username, challenger);
+        }
+    }
+    // Commandes de jeu (MOVE, DRAW) pour les clients en partie
+    else if (clients[i].status == CLIENT_IN_GAME) {
+        Game* g = find_game_for_client(i);
+        int game_idx = find_game_index_for_client(i);
+        if (g == NULL || game_idx == -1) return;
+    
+        int player_id = clients[i].player_id;
+        int opponent_idx = clients[i].opponent_index;
+    
+        // Commande QUIT - Abandonner la partie
+        if (!strcmp(buf, "QUIT")) {
+            // Le joueur abandonne, l'adversaire gagne
+            int winner = 1 - player_id;
+    
+            char msg[128];
+            snprintf(msg, sizeof(msg), "MSG %s a abandonné. Vous gagnez!\n", clients[i].username);
+            send_line(clients[opponent_idx].socket_fd, msg);
+    
+            snprintf(msg, sizeof(msg), "END winner %d\n", winner);
+            send_line(clients[opponent_idx].socket_fd, msg);
+    
+            send_line(clients[i].socket_fd, "MSG Vous avez abandonné.\n");
+            send_line(clients[i].socket_fd, "END forfeit\n");
+    
+            // Terminer la partie
+            char end_msg[64];
+            snprintf(end_msg, sizeof(end_msg), "END winner %d\n", winner);
+            end_game(g, end_msg, game_idx);
+    
+            printf("%s a abandonné contre %s\n", clients[i].username, clients[opponent_idx].username);
+            return;
+        }
+    
+        // Analyse de la position, à tout moment de la partie
+        if (!strcmp(buf, "ANALYZE")) {
+            request_analysis(i, g, ANALYSIS_FULL);
+            return;
+        }
+    
+        // Réponse à une proposition d'égalité de l'adversaire
+        if (g->draw_offer_by == 1 - player_id && (!strcmp(buf, "YES") || !strcmp(buf, "NO"))) {
+            answer_draw_offer(g, game_idx, !strcmp(buf, "YES"));
+            return;
+        }
+    
+        // Vérifier que c'est bien le tour du joueur
+        if (g->state.current_player != player_id) {
+            send_line(clients[i].socket_fd, "MSG Ce n'est pas votre tour.\n");
+            return;
+        }
+    
+        // Traitement d'un coup
+        if (!strncmp(buf, "MOVE ", 5)) {
+            play_move(i, g, game_idx, atoi(buf + 5));
+        }
+        // Demande de conseil
+        else if (!strcmp(buf, "HINT")) {
+            request_analysis(i, g, ANALYSIS_HINT);
+        }
+        // Proposition d'égalité : l'adversaire répond par YES ou NO quand il
+        // veut, la boucle principale n'attend pas sa réponse
+        else if (!strcmp(buf, "DRAW")) {
+            // Les bots jouent toujours jusqu'au bout
+            if (clients[opponent_idx].is_bot) {
+                send_line(clients[i].socket_fd, "MSG Égalité refusée.\n");
+                return;
+            }
+    
+            if (g->draw_offer_by != -1) {
+                send_line(clients[i].socket_fd, "MSG Une proposition d'égalité est déjà en attente.\n");
+                return;
+            }
+    
+            printf("[%s] propose l'égalité à [%s]\n", 
+                   clients[i].username, clients[opponent_idx].username);
+    
+            g->draw_offer_by = player_id;
+            timer_arm(&current_reactor->timers, &g->draw_timer, DRAW_TIMEOUT_S * 1000, timer_now_ms());
+            send_line(clients[opponent_idx].socket_fd, "ASKDRAW\n");
+            send_line(clients[i].socket_fd, "MSG Proposition d'égalité envoyée, en attente de la réponse.\n");
+        }
+    }
+}
+
+/**
+ * Vrai si le tampon d'un client contient une commande complète (ligne ou trame)
+ */
+static int client_has_line(int i) {
+    if (clients[i].proto == 2) {
+        return proto_has_frame(&clients[i].input);
+    }
+    return linebuf_has_line(&clients[i].input);
+}
+
+/**
+ * Extrait la prochaine commande d'un client sous forme de ligne : les trames
+ * v2 sont retraduites pour passer par le même traitement. Retourne 0 si
+ * aucune, -1 si la trame est trop longue pour une commande ou ne tient pas
+ * sur une ligne (un CHAT avec '\n' serait relayé tel quel aux clients texte).
+ */
+static int next_client_line(int i, char* buf, size_t cap) {
+    if (clients[i].proto != 2) {
+        return linebuf_next_line(&clients[i].input, buf, cap);
+    }
+    char payload[256];
+    int op;
+    size_t len;
+    int r = proto_next_frame(&clients[i].input, &op, payload, sizeof(payload), &len);
+    if (r > 0 && !proto_payload_is_line(op, payload, len)) {
+        return -1;
+    }
+    if (r > 0) {
+        proto_decode_line(op, payload, len, buf, cap);
+    }
+    return r;
+}
+
+/**
+ * Vrai tant que le client reste sur le shard courant (pas de transfert en cours)
+ */
+static int staying(int i) {
+    return owned(i) && current_reactor->moving[i] == NULL;
+}
+
+/**
+ * Traite les lignes complètes du tampon d'un client ; après une commande qui
+ * le transfère, le reste attend le nouveau shard
+ */
+static void handle_client_lines(int i, int fd) {
+    char buf[256];
+    clients[i].last_input = timer_now_ms();
+    int registering = clients[i].status == CLIENT_CONNECTED;
+    while (clients[i].socket_fd == fd && staying(i)) {
+        int r = next_client_line(i, buf, sizeof(buf));
+        if (r < 0) {
+            printf("Client %s : trame invalide, déconnexion\n",
+                   clients[i].username[0] ? clients[i].username : "(sans nom)");
+            disconnect_client(i);
+            break;
+        }
+        if (r == 0) {
+            break;
+        }
+        handle_client_input(i, buf);
+    }
+    if (registering && owned(i) && clients[i].socket_fd == fd && clients[i].status != CLIENT_CONNECTED) {
+        check_client(i, clients[i].last_input);  // Inscrit : battement de cœur au lieu du délai d'inscription
+    }
+}
+
+/**
+ * Lit ce que le client a envoyé et traite toutes les lignes complètes ; une
+ * ligne incomplète attend le prochain réveil dans le tampon du client.
+ * En edge-triggered, epoll ne signale à nouveau le socket qu'à l'arrivée de
+ * nouvelles données : on lit tant que le tampon se remplit entièrement.
+ * Seul le shard du client lit son socket ; transféré, le client n'est plus
+ * lu ici, le nouveau shard reprend la lecture.
+ */
+static void handle_client_events(int i) {
+    int fd = clients[i].socket_fd;
+    while (fd > 0 && clients[i].socket_fd == fd && owned(i)) {
+        if (client_has_line(i)) {
+            handle_client_lines(i, fd);
+            continue;
+        }
+        size_t room = LINEBUF_SIZE - clients[i].input.len;
+        ssize_t r = linebuf_fill(&clients[i].input, fd, MSG_DONTWAIT);
+        if (r < 0 && errno == EINTR) {
+            continue;
+        }
+        if (r < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return;
+        }
+        if (r <= 0) {
+            disconnect_client(i);
+            return;
+        }
+        if ((size_t)r < room) {
+            // Socket vidé : on traite les lignes reçues puis on rend la main
+            handle_client_lines(i, fd);
+            return;
+        }
+    }
+}
+
+/**
+ * Commence à recevoir sur le socket d'un nouveau client : epoll (socket non
+ * bloquant) ou recv multishot io_uring (le socket reste bloquant, io_uring
+ * attend lui-même qu'il soit prêt)
+ */
+static int watch_client(Reactor* r, int idx) {
+    int fd = clients[idx].socket_fd;
+#ifndef USE_SELECT
+    if (r->ring != NULL) {
+        clients[idx].recv_pending = 1;
+        uring_recv_multishot(r->ring, fd, URING_DATA(URING_RECV, idx));
+        return 0;
+    }
+#endif
+    if (set_nonblocking(fd) < 0) {
+        return -1;
+    }
+    return watch_fd(r, fd, &clients[idx]);
+}
+
+/**
+ * Arrivée d'un client transféré : le shard le prend en charge, réarme ses
+ * timers, rejoue la commande qui l'a transféré puis traite le reste de son
+ * tampon
+ */
+static void adopt_client(Mail* m) {
+    int i = m->to;
+    Reactor* r = current_reactor;
+    r->owns[i] = 1;
+    if (watch_client(r, i) < 0) {
+        disconnect_client(i);
+        return;
+    }
+    uint64_t now = timer_now_ms();
+    check_client(i, now);
+    if (clients[i].challenged_by >= 0) {
+        timer_arm(&r->timers, &clients[i].challenge_timer, CHALLENGE_TIMEOUT_S * 1000, now);
+    }
+    if (clients[i].output.len > 0) {
+        schedule_flush(i);
+    }
+    
+    int fd = clients[i].socket_fd;
+    replaying = 1;
+    handle_client_input(i, m->text);
+    replaying = 0;
+    if (clients[i].socket_fd == fd && client_has_line(i)) {
+        handle_client_lines(i, fd);
+    }
+}
+
+/**
+ * Exécute un courrier pour le shard courant ; celui d'un client qui a
+ * quitté le shard entre-temps le suit, celui d'une connexion fermée est
+ * perdu
+ */
+static void handle_mail(Mail* m) {
+    int to = m->to;
+    if (m->kind == MAIL_ADOPT) {
+        adopt_client(m);
+        free(m);
+        return;
+    }
+    if (to >= 0 && !owned(to)) {
+        route_mail(m);
+        return;
+    }
+    if (to >= 0 && (clients[to].socket_fd <= 0 || (m->session != 0 && clients[to].session != m->session))) {
+        free_mail(m);
+        return;
+    }
+    
+    char msg[256];
+    if (m->kind == MAIL_DELIVER) {
+        send_line(clients[to].socket_fd, m->text);
+    } else if (m->kind == MAIL_CHALLENGE) {
+        if (clients[to].status == CLIENT_IN_GAME) {
+            deliver(m->from, m->from_session, "MSG Ce joueur est déjà en partie.\n");
+        } else {
+            // Enregistrer le défi, qui tombe sans réponse en CHALLENGE_TIMEOUT_S
+            clients[to].challenged_by = m->from;
+            clients[to].challenged_session = m->from_session;
+            timer_arm(&current_reactor->timers, &clients[to].challenge_timer, CHALLENGE_TIMEOUT_S * 1000, timer_now_ms());
+            
+            // Envoyer le défi
+            snprintf(msg, sizeof(msg), "CHALLENGED_BY %s\n", m->text);
+            send_line(clients[to].socket_fd, msg);
+            
+            deliver(m->from, m->from_session, "MSG Défi envoyé. En attente de réponse...\n");
+            printf("[%s] a défié [%s]\n", m->text, clients[to].username);
+        }
+    } else if (m->kind == MAIL_PRIVATE_CHAT) {
+        if (clients[to].status == CLIENT_EDITING_BIO) {
+            // Le destinataire est en train d'éditer sa bio
+            snprintf(msg, sizeof(msg), "MSG %s est en train d'éditer sa bio. Attendez qu'il termine.\n",
+                     clients[to].username);
+            deliver(m->from, m->from_session, msg);
+        } else {
+            send_line(clients[to].socket_fd, m->text);
+        }
+    } else if (m->kind == MAIL_CHAT_ALL) {
+        Message line;
+        message_init(&line, m->text);
+        for (int j = 0; j < MAX_CLIENTS; j++) {
+            if (owned(j) && j != m->from && clients[j].status == CLIENT_WAITING) {
+                send_message(&line, j);
+            }
+        }
+    } else if (m->kind == MAIL_CANCEL_CHALLENGES) {
+        for (int j = 0; j < MAX_CLIENTS; j++) {
+            if (owned(j) && clients[j].challenged_by == m->from &&
+                clients[j].challenged_session == m->from_session) {
+                clients[j].challenged_by = -1;
+                timer_cancel(&current_reactor->timers, &clients[j].challenge_timer);
+                snprintf(msg, sizeof(msg), "MSG Défi de %s annulé (déconnexion).\n", m->text);
+                send_line(clients[j].socket_fd, msg);
+            }
+        }
+    } else if (m->kind == MAIL_WHOIS) {
+        char response[2048];
+        int offset = 0;
+        
+        offset += snprintf(response + offset, sizeof(response) - offset,
+                          "BIO\n=== Bio de %s ===\n", clients[to].username);
+        
+        if (clients[to].bio_lines == 0) {
+            offset += snprintf(response + offset, sizeof(response) - offset,
+                             "(Aucune bio définie)\n");
+        } else {
+            for (int j = 0; j < clients[to].bio_lines; j++) {
+                offset += snprintf(response + offset, sizeof(response) - offset,
+                                 "%s\n", clients[to].bio[j]);
+            }
+        }
+        
+        snprintf(response + offset, sizeof(response) - offset, "==================\n");
+        deliver(m->from, m->from_session, response);
+    } else if (m->kind == MAIL_FRIEND_REQUEST) {
+        int result = add_friend_request(to, m->text);
+        if (result == 1) {
+            snprintf(msg, sizeof(msg), "MSG Demande d'ami envoyée à %s.\n", clients[to].username);
+            deliver(m->from, m->from_session, msg);
+            
+            // Notifier le destinataire
+            snprintf(msg, sizeof(msg), "MSG %s vous a envoyé une demande d'ami. Tapez '/acceptfriend %s' pour accepter.\n",
+                     m->text, m->text);
+            send_line(clients[to].socket_fd, msg);
+            
+            printf("[%s] a envoyé une demande d'ami à [%s]\n", m->text, clients[to].username);
+        } else if (result == -1) {
+            deliver(m->from, m->from_session, "MSG Vous avez déjà envoyé une demande d'ami à cet utilisateur.\n");
+        } else {
+            deliver(m->from, m->from_session, "MSG L'utilisateur a trop de demandes en attente.\n");
+        }
+    } else if (m->kind == MAIL_FRIEND_ACCEPTED) {
+        if (add_friend(to, m->text) == 1) {
+            snprintf(msg, sizeof(msg), "MSG %s a accepté votre demande d'ami.\n", m->text);
+            send_line(clients[to].socket_fd, msg);
+        }
+    } else if (m->kind == MAIL_GATHER) {
+        gather_contribute(m->data);
+    } else if (m->kind == MAIL_BOT) {
+        run_bot_job(m->data);
+    } else if (m->kind == MAIL_ANALYSIS) {
+        run_analysis_job(m->data);
+    }
+    free_mail(m);
+}
+
+/**
+ * Traite le courrier arrivé dans la boîte du shard, dans l'ordre
+ */
+static void drain_mailbox(Reactor* r) {
+    pthread_mutex_lock(&r->lock);
+    Mail* m = r->mailbox;
+    r->mailbox = NULL;
+    r->mailbox_tail = &r->mailbox;
+    pthread_mutex_unlock(&r->lock);
+    while (m != NULL) {
+        Mail* next = m->next;
+        handle_mail(m);
+        m = next;
+    }
+}
+
+/**
+ * Emplacement pour une nouvelle connexion sur le shard r, réservé sous
+ * l'annuaire : un nouveau tant qu'il en reste, sinon un emplacement libéré
+ * (release_closed_slots) par n'importe quel shard, fermé avant d'avoir
+ * choisi un username ou repris par une reconnexion. Les comptes inscrits
+ * gardent le leur pour la reconnexion. -1 si aucun ; avec stall, r sera
+ * relancé à la prochaine libération (socket d'écoute epoll en mode front).
+ */
+static int claim_slot(Reactor* r, int stall) {
+    int idx = -1;
+    pthread_mutex_lock(&directory_lock);
+    if (num_clients < MAX_CLIENTS) {
+        idx = num_clients++;
+    } else {
+        for (int i = 0; i < MAX_CLIENTS && idx < 0; i++) {
+            if (directory[i].shard < 0 && directory[i].username[0] == '\0') {
+                idx = i;
+            }
+        }
+    }
+    if (idx >= 0) {
+        directory[idx].shard = r->id;
+        directory[idx].session++;
+        directory[idx].online = 1;
+        clients[idx].session = directory[idx].session;
+        r->owns[idx] = 1;
+    } else if (stall) {
+        stalled_accepts |= 1u << r->id;
+    }
+    pthread_mutex_unlock(&directory_lock);
+    return idx;
+}
+
+/**
+ * Rend à l'annuaire un emplacement du shard r qui n'attend plus rien
+ */
+static void release_slot(Reactor* r, int idx) {
+    r->owns[idx] = 0;
+    pthread_mutex_lock(&directory_lock);
+    directory[idx].online = 0;
+    directory[idx].shard = -1;
+    pthread_mutex_unlock(&directory_lock);
+}
+
+/**
+ * Inscrit sur l'emplacement idx une connexion acceptée par le réacteur r et
+ * lui demande son username
+ */
+static void add_client(Reactor* r, int idx, int new_fd) {
+    // Les lignes d'un tour partent ensemble (flush_scheduled) : Nagle ne
+    // ferait que retarder le STATE jusqu'à l'ACK du segment précédent
+    int one = 1;
+    setsockopt(new_fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    clients[idx].socket_fd = new_fd;
+    clients[idx].status = CLIENT_CONNECTED;  // En attente du username
+    clients[idx].opponent_index = -1;
+    clients[idx].challenged_by = -1;
+    clients[idx].watching_game = -1;
+    clients[idx].username[0] = '\0';  // Username vide pour l'instant
+    clients[idx].bio_lines = 0;
+    clients[idx].num_friends = 0;
+    clients[idx].num_friend_requests = 0;
+    clients[idx].private_mode = 0;
+    clients[idx].save_mode = 0;
+    clients[idx].save_response = -1;
+    clients[idx].game_to_save = -1;
+    clients[idx].elo_score = 100;  // Score ELO initial
+    clients[idx].is_bot = 0;
+    clients[idx].bot_level = 0;
+    clients[idx].reactor = r->id;
+    clients[idx].proto = 1;
+    clients[idx].delta = 0;
+    clients[idx].state_game = 0;
+    clients[idx].recv_pending = 0;
+    clients[idx].connected_at = timer_now_ms();
+    clients[idx].last_input = clients[idx].connected_at;
+    clients[idx].last_command = clients[idx].connected_at;
+    clients[idx].ping_sent = 0;
+    linebuf_init(&clients[idx].input);
+    outq_init(&clients[idx].output);
+    if (watch_client(r, idx) < 0) {
+        close(new_fd);
+        clients[idx].socket_fd = -1;
+        release_slot(r, idx);
+        return;
+    }
+    
+    timer_arm(&r->timers, &clients[idx].timer, REGISTER_TIMEOUT_S * 1000, clients[idx].connected_at);
+    
+    // Demander le username (non bloquant), en annonçant le protocole v2
+    send_line(new_fd, "REGISTER " PROTO_V2_TOKEN " " PROTO_DELTA_TOKEN "\n");
+    
+    printf("Nouvelle connexion acceptée (en attente du username)\n");
+}
+
+/**
+ * Accepte les connexions en attente ; le socket d'écoute est non bloquant,
+ * on accepte jusqu'à le vider ou manquer d'emplacements. Les nouveaux
+ * clients appartiennent au réacteur qui les accepte.
+ */
+static void accept_new_client(Reactor* r) {
+    int idx;
+    while ((idx = claim_slot(r, 1)) >= 0) {
+        int new_fd = accept(r->listen_fd, NULL, NULL);
+        if (new_fd < 0) {
+            release_slot(r, idx);
+            break;
+        }
+        add_client(r, idx, new_fd);
+    }
+}
+
+/**
+ * Libère les emplacements fermés du shard dès qu'ils n'attendent plus rien
+ * du noyau (recv io_uring, envoi en cours) ni du shard (liste d'envoi,
+ * partie) : n'importe quel shard peut alors les reprendre
+ */
+static void release_closed_slots(Reactor* r) {
+    if (r->num_closed == 0) {
+        return;
+    }
+    r->num_closed = 0;
+    int released = 0;
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        Client* c = &clients[i];
+        if (!r->owns[i] || c->socket_fd > 0 || c->is_bot) {
+            continue;
+        }
+        if (c->recv_pending || c->output.inflight > 0 || c->flush_queued || find_game_for_client(i) != NULL) {
+            r->num_closed++;  // Revu au prochain tour
+        } else {
+            release_slot(r, i);
+            released = 1;
+        }
+    }
+    if (!released) {
+        return;
+    }
+    
+    // Les connexions laissées dans la file d'attente d'un socket d'écoute
+    // plein ne redéclencheront pas d'événement : relancer leurs réacteurs
+    pthread_mutex_lock(&directory_lock);
+    unsigned stalled = stalled_accepts;
+    stalled_accepts = 0;
+    pthread_mutex_unlock(&directory_lock);
+    for (int k = 0; stalled != 0; k++) {
+        if (stalled & (1u << k)) {
+            stalled &= ~(1u << k);
+            if (k == r->id) {
+                accept_new_client(r);
+            } else {
+                __atomic_store_n(&reactors[k].retry_accept, 1, __ATOMIC_RELEASE);
+                wake_reactor(&reactors[k]);
+            }
+        }
+    }
+}
+
+/**
+ * Ouvre un socket d'écoute non bloquant sur PORT ; avec reuseport, chaque
+ * réacteur a le sien et le noyau répartit les connexions entre eux
+ */
+static int open_listener(int reuseport) {
+    int srv = socket(AF_INET, SOCK_STREAM, 0);
+    if (srv < 0) {
+        return -1;
+    }
+    
+    // Configuration pour réutiliser l'adresse
+    int opt = 1;
+    setsockopt(srv, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    if (reuseport && setsockopt(srv, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+        close(srv);
+        return -1;
+    }
+    
+    // Configuration de l'adresse du serveur
+    struct sockaddr_in a = {0};
+    a.sin_family = AF_INET;
+    a.sin_addr.s_addr = INADDR_ANY;
+    a.sin_port = htons(PORT);
+    
+    // Liaison et écoute
+    if (bind(srv, (struct sockaddr*)&a, sizeof(a)) < 0 || listen(srv, 10) < 0 ||
+        set_nonblocking(srv) < 0) {
+        close(srv);
+        return -1;
+    }
+    return srv;
+}
+
+#ifndef USE_SELECT
+/**
+ * Boucle epoll d'un réacteur. Chaque événement porte sa source : un Client,
+ * ou l'adresse de la variable qui contient le descripteur du socket d'écoute
+ * ou d'un pipe. Les pipes des bots et de l'analyse sont lus par le réacteur 0.
+ * L'événement d'un client transféré plus tôt dans le même lot est ignoré.
+ */
+static void reactor_epoll_loop(Reactor* r) {
+    struct epoll_event events[MAX_EVENTS];
+    while (1) {
+        // Courrier des autres shards, puis réveil au plus tard à la
+        // prochaine échéance de la roue des timers
+        drain_mailbox(r);
+        int timeout_ms = run_timers();
+        flush_scheduled(r);
+        release_closed_slots(r);
+        if (__atomic_exchange_n(&r->retry_accept, 0, __ATOMIC_ACQ_REL)) {
+            accept_new_client(r);
+        }
+        
+        int n = epoll_wait(r->epoll_fd, events, MAX_EVENTS, timeout_ms);
+        for (int k = 0; k < n; k++) {
+            void* source = events[k].data.ptr;
+            if (source == &r->wake_pipe[0]) {
+                char drain[64];
+                while (read(r->wake_pipe[0], drain, sizeof(drain)) > 0) {
+                }
+            } else if (source == &bot_pipe[0]) {
+                while (handle_bot_result()) {
+                }
+            } else if (source == &analysis_pipe[0]) {
+                while (handle_analysis_result()) {
+                }
+            } else if (source == &r->listen_fd) {
+                accept_new_client(r);
+            } else {
+                int i = (int)((Client*)source - clients);
+                if (!owned(i)) {
                     continue;
                 }
-                
-                // Ajouter la ligne si on n'a pas atteint la limite
-                if (clients[i].bio_lines < MAX_BIO_LINES) {
-                    strncpy(clients[i].bio[clients[i].bio_lines], buf, MAX_BIO_LINE_LEN - 1);
-                    clients[i].bio[clients[i].bio_lines][MAX_BIO_LINE_LEN - 1] = '\0';
-                    clients[i].bio_lines++;
-                    
-                    if (clients[i].bio_lines < MAX_BIO_LINES) {
-                        char prompt[64];
-                        snprintf(prompt, sizeof(prompt), "MSG Ligne %d: \n", clients[i].bio_lines + 1);
-                        send_line(clients[i].socket_fd, prompt);
-                    } else {
-                        // Limite atteinte, terminer automatiquement
-                        clients[i].status = CLIENT_WAITING;
-                        char msg[128];
-                        snprintf(msg, sizeof(msg), "MSG Bio enregistrée (%d lignes - limite atteinte).\n", clients[i].bio_lines);
-                        send_line(clients[i].socket_fd, msg);
-                        printf("[%s] a défini sa bio (%d lignes)\n", clients[i].username, clients[i].bio_lines);
-                    }
+                if (events[k].events & EPOLLOUT) {
+                    flush_client(i);
                 }
-                continue;
-            }
-            
-            // Si le client est spectateur, il ne peut que faire stopwatch ou CHAT
-            if (clients[i].status == CLIENT_SPECTATING) {
-                if (!strcmp(buf, "STOPWATCH")) {
-                    Game* g = &games[clients[i].watching_game];
-                    
-                    // Retirer le spectateur
-                    for (int j = 0; j < g->num_spectators; j++) {
-                        if (g->spectator_indices[j] == i) {
-                            // Décaler les spectateurs suivants
-                            for (int k = j; k < g->num_spectators - 1; k++) {
-                                g->spectator_indices[k] = g->spectator_indices[k + 1];
-                            }
-                            g->num_spectators--;
-                            break;
-                        }
-                    }
-                    
-                    clients[i].status = CLIENT_WAITING;
-                    clients[i].watching_game = -1;
-                    
-                    send_line(clients[i].socket_fd, "MSG Vous avez arrêté de regarder la partie.\n");
-                    printf("%s a arrêté de regarder\n", clients[i].username);
-                } else if (!strncmp(buf, "CHAT ", 5)) {
-                    // Les spectateurs peuvent envoyer des messages dans le chat de la partie
-                    char* message = buf + 5;
-                    Game* g = &games[clients[i].watching_game];
-                    char chat_msg[512];
-                    snprintf(chat_msg, sizeof(chat_msg), "CHAT [Spectateur %s]: %s\n", 
-                             clients[i].username, message);
-                    
-                    // Envoyer aux joueurs
-                    for (int j = 0; j < 2; j++) {
-                        int player_idx = g->client_indices[j];
-                        if (player_idx >= 0 && clients[player_idx].socket_fd > 0) {
-                            send_line(clients[player_idx].socket_fd, chat_msg);
-                        }
-                    }
-                    
-                    // Envoyer aux autres spectateurs (SAUF l'expéditeur)
-                    for (int j = 0; j < g->num_spectators; j++) {
-                        int spec_idx = g->spectator_indices[j];
-                        if (spec_idx >= 0 && spec_idx != i && clients[spec_idx].socket_fd > 0) {
-                            send_line(clients[spec_idx].socket_fd, chat_msg);
-                        }
-                    }
-                } else {
-                    send_line(clients[i].socket_fd, "MSG Vous êtes en mode spectateur. Tapez '/stopwatch' pour quitter ou envoyez un message.\n");
+                if (events[k].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    handle_client_events(i);
                 }
-                continue;
-            }
-            
-            // Commande LIST - Demander la liste des utilisateurs
-            if (!strcmp(buf, "LIST")) {
-                send_online_users(i);
-                printf("[%s] a demandé la liste des joueurs\n", clients[i].username);
-            }
-            // Commande GAMES - Demander la liste des parties en cours
-            else if (!strcmp(buf, "GAMES")) {
-                send_games_list(i);
-                printf("[%s] a demandé la liste des parties\n", clients[i].username);
             }
-            // Commande BOARD - Afficher le plateau (pour joueur ou spectateur en partie)
-            else if (!strcmp(buf, "BOARD")) {
-                if (clients[i].status == CLIENT_IN_GAME) {
-                    Game* g = find_game_for_client(i);
-                    if (g) {
-                        send_game_state(g, i);
-                        printf("[%s] a demandé le plateau (en partie)\n", clients[i].username);
-                    }
-                } else if (clients[i].status == CLIENT_SPECTATING) {
-                    Game* g = &games[clients[i].watching_game];
-                    send_game_state(g, i);
-                    printf("[%s] a demandé le plateau (spectateur)\n", clients[i].username);
-                } else {
-                    send_line(clients[i].socket_fd, "MSG Vous n'êtes pas en partie.\n");
-                }
+        }
+    }
+}
+
+/**
+ * Données reçues par le recv multishot d'un client : elles passent par son
+ * tampon de lignes comme avec epoll, puis le tampon fourni est rendu au noyau.
+ * Pendant un transfert, elles attendent dans le tampon le nouveau shard (qui
+ * coupe le client si le tampon déborde d'ici là) ; la dernière complétion du
+ * recv annulé, l'envoi en cours terminé, le client part.
+ */
+static void uring_recv_done(Reactor* r, int idx, const struct io_uring_cqe* cqe) {
+    Client* c = &clients[idx];
+    int fd = c->socket_fd;
+    if (cqe->res > 0 && fd > 0) {
+        const char* data = uring_buffer(r->ring, cqe);
+        size_t n = (size_t)cqe->res;
+        while (n > 0 && c->socket_fd == fd) {
+            size_t copied = linebuf_append(&c->input, data, n);
+            data += copied;
+            n -= copied;
+            if (r->moving[idx] == NULL) {
+                handle_client_lines(idx, fd);
+            } else if (n > 0) {
+                printf("Client %s : tampon plein pendant un transfert, déconnexion\n", c->username);
+                disconnect_client(idx);
             }
-            // Commande BIO - Définir sa bio (mode édition interactive)
-            else if (!strcmp(buf, "BIO")) {
-                if (clients[i].status != CLIENT_WAITING) {
-                    send_line(clients[i].socket_fd, "MSG Vous ne pouvez éditer votre bio que depuis le lobby.\n");
-                } else {
-                    clients[i].status = CLIENT_EDITING_BIO;
-                    clients[i].bio_lines = 0;
-                    send_line(clients[i].socket_fd, "MSG Entrez votre bio (max 10 lignes, ligne vide pour terminer):\n");
-                    send_line(clients[i].socket_fd, "MSG Ligne 1: \n");
-                    printf("[%s] commence à éditer sa bio\n", clients[i].username);
-                }
+        }
+    }
+    if (cqe->flags & IORING_CQE_F_BUFFER) {
+        uring_recycle_buffer(r->ring, cqe);
+    }
+    if (fd <= 0 || c->socket_fd != fd) {
+        // Client déjà fermé : la dernière complétion du recv libère l'emplacement
+        if (!(cqe->flags & IORING_CQE_F_MORE)) {
+            c->recv_pending = 0;
+        }
+        return;
+    }
+    if (r->moving[idx] != NULL && cqe->res != 0) {
+        if (!(cqe->flags & IORING_CQE_F_MORE)) {
+            c->recv_pending = 0;
+            if (c->output.inflight == 0) {
+                hand_off(idx, r->moving[idx]);
             }
-            // Commande WHOIS - Afficher la bio d'un joueur
-            else if (!strncmp(buf, "WHOIS ", 6)) {
-                char target[MAX_USERNAME_LEN];
-                strncpy(target, buf + 6, MAX_USERNAME_LEN - 1);
-                target[MAX_USERNAME_LEN - 1] = '\0';
-                
-                int target_idx = find_client_by_username(target);
-                
-                if (target_idx == -1) {
-                    send_line(clients[i].socket_fd, "MSG Utilisateur introuvable.\n");
-                } else {
-                    char response[2048];
-                    int offset = 0;
-                    
-                    offset += snprintf(response + offset, sizeof(response) - offset,
-                                      "BIO\n=== Bio de %s ===\n", clients[target_idx].username);
-                    
-                    if (clients[target_idx].bio_lines == 0) {
-                        offset += snprintf(response + offset, sizeof(response) - offset,
-                                         "(Aucune bio définie)\n");
+        }
+        return;
+    }
+    if (cqe->res == 0 || (cqe->res < 0 && cqe->res != -ENOBUFS && cqe->res != -EINTR)) {
+        disconnect_client(idx);
+        if (!(cqe->flags & IORING_CQE_F_MORE)) {
+            c->recv_pending = 0;
+        }
+        return;
+    }
+    // Plus de tampon libre (-ENOBUFS) ou fin du multishot : on relance
+    if (!(cqe->flags & IORING_CQE_F_MORE)) {
+        uring_recv_multishot(r->ring, fd, URING_DATA(URING_RECV, idx));
+    }
+}
+
+/**
+ * Fin d'un envoi io_uring : le reste d'un envoi partiel repart, sinon la
+ * suite de la file (et le STATE retenu une fois sous le seuil)
+ */
+static void uring_send_done(Reactor* r, int idx, int res) {
+    Client* c = &clients[idx];
+    OutputQueue* q = &c->output;
+    if (res == -EAGAIN || res == -EINTR) {
+        res = 0;  // Rien d'envoyé : on recommence
+    }
+    if (res < 0) {
+        // Connexion en erreur : le recv verra la fermeture
+        q->dropped += q->inflight;
+        outq_sent(q, q->inflight);
+    } else {
+        outq_sent(q, (size_t)res);
+    }
+    
+    if (c->socket_fd <= 0) {
+        // Client fermé pendant l'envoi : la file n'attendait que cette complétion
+        outq_free(q);
+    } else if (q->inflight > 0) {
+        uring_send(r->ring, c->socket_fd, outq_sending(q), q->inflight, URING_DATA(URING_SEND, idx));
+    } else {
+        if (q->len < output_high_water && q->pending_state_len > 0) {
+            outq_push(q, q->pending_state, q->pending_state_len);
+            q->pending_state_len = 0;
+        }
+        flush_queue(c);
+        if (r->moving[idx] != NULL && !c->recv_pending) {
+            hand_off(idx, r->moving[idx]);  // Transfert qui n'attendait que cet envoi
+        }
+    }
+}
+
+/**
+ * Boucle io_uring d'un réacteur : accept et recv multishot, un send en cours
+ * par client, poll multishot sur les pipes. Un multishot que le noyau
+ * termine (pas de IORING_CQE_F_MORE) est relancé. L'annulation d'un recv
+ * (URING_CANCEL, transfert) n'a rien à traiter : le recv lui-même se termine.
+ */
+static void reactor_uring_loop(Reactor* r) {
+    while (1) {
+        // Courrier des autres shards, puis réveil au plus tard à la
+        // prochaine échéance de la roue des timers
+        drain_mailbox(r);
+        int timeout_ms = run_timers();
+        flush_scheduled(r);
+        release_closed_slots(r);
+        
+        if (uring_submit_and_wait(r->ring, timeout_ms) < 0) {
+            continue;
+        }
+        struct io_uring_cqe* cqe;
+        while ((cqe = uring_peek_cqe(r->ring)) != NULL) {
+            int kind = (int)(cqe->user_data >> 32);
+            int idx = (int)(uint32_t)cqe->user_data;
+            int rearm = !(cqe->flags & IORING_CQE_F_MORE);
+            if (kind == URING_RECV) {
+                uring_recv_done(r, idx, cqe);
+            } else if (kind == URING_SEND) {
+                uring_send_done(r, idx, cqe->res);
+            } else if (kind == URING_ACCEPT) {
+                if (cqe->res >= 0) {
+                    int slot = claim_slot(r, 0);
+                    if (slot < 0) {
+                        close(cqe->res);  // Serveur plein
                     } else {
-                        for (int j = 0; j < clients[target_idx].bio_lines; j++) {
-                            offset += snprintf(response + offset, sizeof(response) - offset,
-                                             "%s\n", clients[target_idx].bio[j]);
-                        }
+                        add_client(r, slot, cqe->res);
                     }
-                    
-                    offset += snprintf(response + offset, sizeof(response) - offset,
-                                      "==================\n");
-                    
-                    send_line(clients[i].socket_fd, response);
-                    printf("[%s] a consulté la bio de [%s]\n", clients[i].username, target);
                 }
-            }
-            // Commande ADDFRIEND - Ajouter un ami
-            else if (!strncmp(buf, "ADDFRIEND ", 10)) {
-                char friend_name[MAX_USERNAME_LEN];
-                strncpy(friend_name, buf + 10, MAX_USERNAME_LEN - 1);
-                friend_name[MAX_USERNAME_LEN - 1] = '\0';
-                
-                int friend_idx = find_client_by_username(friend_name);
-                
-                if (friend_idx == -1) {
-                    send_line(clients[i].socket_fd, "MSG Utilisateur introuvable.\n");
-                } else if (friend_idx == i) {
-                    send_line(clients[i].socket_fd, "MSG Vous ne pouvez pas vous ajouter vous-même comme ami.\n");
-                } else if (is_friend(i, friend_name)) {
-                    send_line(clients[i].socket_fd, "MSG Cet utilisateur est déjà votre ami.\n");
-                } else {
-                    // Envoyer une demande d'ami
-                    int result = add_friend_request(friend_idx, clients[i].username);
-                    if (result == 1) {
-                        char msg[128];
-                        snprintf(msg, sizeof(msg), "MSG Demande d'ami envoyée à %s.\n", friend_name);
-                        send_line(clients[i].socket_fd, msg);
-                        
-                        // Notifier le destinataire
-                        char notif[200];
-                        snprintf(notif, sizeof(notif), "MSG %s vous a envoyé une demande d'ami. Tapez '/acceptfriend %s' pour accepter.\n", 
-                                clients[i].username, clients[i].username);
-                        send_line(clients[friend_idx].socket_fd, notif);
-                        
-                        printf("[%s] a envoyé une demande d'ami à [%s]\n", clients[i].username, friend_name);
-                    } else if (result == -1) {
-                        send_line(clients[i].socket_fd, "MSG Vous avez déjà envoyé une demande d'ami à cet utilisateur.\n");
-                    } else {
-                        send_line(clients[i].socket_fd, "MSG L'utilisateur a trop de demandes en attente.\n");
-                    }
+                if (rearm) {
+                    uring_accept_multishot(r->ring, r->listen_fd, URING_DATA(URING_ACCEPT, 0));
                 }
-            }
-            // Commande ACCEPTFRIEND - Accepter une demande d'ami
-            else if (!strncmp(buf, "ACCEPTFRIEND ", 13)) {
-                char friend_name[MAX_USERNAME_LEN];
-                strncpy(friend_name, buf + 13, MAX_USERNAME_LEN - 1);
-                friend_name[MAX_USERNAME_LEN - 1] = '\0';
-                
-                if (!has_friend_request(i, friend_name)) {
-                    send_line(clients[i].socket_fd, "MSG Vous n'avez pas de demande d'ami de cet utilisateur.\n");
-                } else {
-                    int friend_idx = find_client_by_username(friend_name);
-                    
-                    // Ajouter l'ami des deux côtés
-                    int result1 = add_friend(i, friend_name);
-                    int result2 = -1;
-                    if (friend_idx != -1) {
-                        result2 = add_friend(friend_idx, clients[i].username);
-                    }
-                    
-                    if (result1 == 1 && result2 == 1) {
-                        // Retirer la demande
-                        remove_friend_request(i, friend_name);
-                        
-                        char msg[128];
-                        snprintf(msg, sizeof(msg), "MSG Vous êtes maintenant ami avec %s.\n", friend_name);
-                        send_line(clients[i].socket_fd, msg);
-                        
-                        // Notifier l'autre joueur
-                        if (friend_idx != -1) {
-                            snprintf(msg, sizeof(msg), "MSG %s a accepté votre demande d'ami.\n", clients[i].username);
-                            send_line(clients[friend_idx].socket_fd, msg);
-                        }
-                        
-                        printf("[%s] et [%s] sont maintenant amis\n", clients[i].username, friend_name);
-                    } else {
-                        send_line(clients[i].socket_fd, "MSG Erreur: liste d'amis pleine.\n");
-                    }
+            } else if (kind == URING_WAKE) {
+                char drain[64];
+                while (read(r->wake_pipe[0], drain, sizeof(drain)) > 0) {
                 }
-            }
-            // Commande LISTFRIENDREQUESTS - Lister les demandes d'amis reçues
-            else if (!strcmp(buf, "LISTFRIENDREQUESTS")) {
-                char line[256];
-                
-                snprintf(line, sizeof(line), "MSG === Demandes d'amis reçues (%d) ===\n", clients[i].num_friend_requests);
-                send_line(clients[i].socket_fd, line);
-                
-                if (clients[i].num_friend_requests == 0) {
-                    send_line(clients[i].socket_fd, "MSG Aucune demande d'ami en attente.\n");
-                } else {
-                    for (int j = 0; j < clients[i].num_friend_requests; j++) {
-                        snprintf(line, sizeof(line), "MSG - %s (tapez '/acceptfriend %s' pour accepter)\n", 
-                                clients[i].friend_requests[j], clients[i].friend_requests[j]);
-                        send_line(clients[i].socket_fd, line);
-                    }
+                if (rearm) {
+                    uring_poll_multishot(r->ring, r->wake_pipe[0], URING_DATA(URING_WAKE, 0));
                 }
-                
-                send_line(clients[i].socket_fd, "MSG ==============================\n");
-            }
-            // Commande REMOVEFRIEND - Retirer un ami
-            else if (!strncmp(buf, "REMOVEFRIEND ", 13)) {
-                char friend_name[MAX_USERNAME_LEN];
-                strncpy(friend_name, buf + 13, MAX_USERNAME_LEN - 1);
-                friend_name[MAX_USERNAME_LEN - 1] = '\0';
-                
-                int result = remove_friend(i, friend_name);
-                if (result == 1) {
-                    char msg[128];
-                    snprintf(msg, sizeof(msg), "MSG %s a été retiré de votre liste d'amis.\n", friend_name);
-                    send_line(clients[i].socket_fd, msg);
-                    printf("[%s] a retiré [%s] de sa liste d'amis\n", clients[i].username, friend_name);
-                } else {
-                    send_line(clients[i].socket_fd, "MSG Cet utilisateur n'est pas dans votre liste d'amis.\n");
+            } else if (kind == URING_BOT) {
+                while (handle_bot_result()) {
                 }
-            }
-            // Commande LISTFRIENDS - Lister ses amis
-            else if (!strcmp(buf, "LISTFRIENDS")) {
-                char line[256];
-                
-                snprintf(line, sizeof(line), "MSG === Vos amis (%d/%d) ===\n", clients[i].num_friends, MAX_FRIENDS);
-                send_line(clients[i].socket_fd, line);
-                
-                if (clients[i].num_friends == 0) {
-                    send_line(clients[i].socket_fd, "MSG Aucun ami dans votre liste.\n");
-                } else {
-                    for (int j = 0; j < clients[i].num_friends; j++) {
-                        snprintf(line, sizeof(line), "MSG - %s\n", clients[i].friends[j]);
-                        send_line(clients[i].socket_fd, line);
-                    }
+                if (rearm) {
+                    uring_poll_multishot(r->ring, bot_pipe[0], URING_DATA(URING_BOT, 0));
                 }
-                
-                send_line(clients[i].socket_fd, "MSG ==================\n");
-            }
-            // Commande PRIVATE - Toggle du mode privé
-            else if (!strcmp(buf, "PRIVATE")) {
-                // Inverser le mode privé
-                clients[i].private_mode = !clients[i].private_mode;
-                
-                if (clients[i].private_mode) {
-                    send_line(clients[i].socket_fd, "MSG Mode privé activé. Seuls vos amis pourront regarder vos parties.\n");
-                    printf("[%s] a activé le mode privé\n", clients[i].username);
-                } else {
-                    send_line(clients[i].socket_fd, "MSG Mode privé désactivé. Tout le monde peut regarder vos parties.\n");
-                    printf("[%s] a désactivé le mode privé\n", clients[i].username);
+            } else if (kind == URING_ANALYSIS) {
+                while (handle_analysis_result()) {
                 }
-            }
-            // Commande SAVE - Toggle du mode sauvegarde automatique
-            else if (!strcmp(buf, "SAVE")) {
-                // Inverser le mode sauvegarde
-                clients[i].save_mode = !clients[i].save_mode;
-                
-                if (clients[i].save_mode) {
-                    send_line(clients[i].socket_fd, "MSG Mode sauvegarde activé. Vos parties seront automatiquement sauvegardées.\n");
-                    printf("[%s] a activé le mode sauvegarde\n", clients[i].username);
-                } else {
-                    send_line(clients[i].socket_fd, "MSG Mode sauvegarde désactivé. Vos parties ne seront plus sauvegardées automatiquement.\n");
-                    printf("[%s] a désactivé le mode sauvegarde\n", clients[i].username);
+                if (rearm) {
+                    uring_poll_multishot(r->ring, analysis_pipe[0], URING_DATA(URING_ANALYSIS, 0));
                 }
             }
-            // Commande HISTORY - Lister les parties sauvegardées
-            else if (!strcmp(buf, "HISTORY")) {
-                FILE* p = popen("ls -1t saved_games/*.txt 2>/dev/null | head -20", "r");
-                if (!p) {
-                    send_line(clients[i].socket_fd, "MSG Aucune partie sauvegardée.\n");
-                } else {
-                    char line[512];
-                    char response[4096] = "MSG === Parties sauvegardées (max 20) ===\n";
-                    int count = 0;
-                    
-                    while (fgets(line, sizeof(line), p) && count < 20) {
-                        // Retirer le \n
-                        line[strcspn(line, "\n")] = 0;
-                        
-                        // Extraire juste le nom du fichier
-                        char* filename = strrchr(line, '/');
-                        if (filename) filename++;
-                        else filename = line;
-                        
-                        char entry[256];
-                        snprintf(entry, sizeof(entry), "%d. %s\n", ++count, filename);
-                        strcat(response, entry);
-                    }
-                    
-                    if (count == 0) {
-                        strcpy(response, "MSG Aucune partie sauvegardée.\n");
-                    } else {
-                        strcat(response, "Tapez '/replay <numéro>' pour revoir une partie.\n");
-                    }
-                    
-                    pclose(p);
-                    send_line(clients[i].socket_fd, response);
-                }
+            uring_cqe_seen(r->ring);
+        }
+    }
+}
+
+static void* reactor_main(void* arg) {
+    Reactor* r = arg;
+    current_reactor = r;
+    if (r->ring != NULL) {
+        reactor_uring_loop(r);
+    } else {
+        reactor_epoll_loop(r);
+    }
+    return NULL;
+}
+#endif
+
+int main(int argc, char** argv) {
+    srand(time(NULL));
+    
+    // Options : -t N threads de recherche par coup de bot, -e base de finales,
+    // -b livre d'ouvertures, -w seuil de la file d'envoi d'un client (Ko),
+    // -r N réacteurs (threads réseau), -u io_uring au lieu d'epoll
+    const char* egdb_path = EGDB_PATH;
+    const char* book_path = BOOK_PATH;
+    int use_uring = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc && atoi(argv[i + 1]) >= 1) {
+            bot_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+            egdb_path = argv[++i];
+        } else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) {
+            book_path = argv[++i];
+        } else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc && atoi(argv[i + 1]) >= 1) {
+            output_high_water = (size_t)atoi(argv[++i]) * 1024;
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc && atoi(argv[i + 1]) >= 1) {
+            num_reactors = atoi(argv[++i]);
+            if (num_reactors > MAX_REACTORS) {
+                num_reactors = MAX_REACTORS;
             }
-            // Commande REPLAY - Afficher le contenu d'une partie sauvegardée
-            else if (!strncmp(buf, "REPLAY ", 7)) {
-                int game_num = atoi(buf + 7);
-                
-                if (game_num < 1 || game_num > 20) {
-                    send_line(clients[i].socket_fd, "MSG Numéro invalide. Tapez '/history' pour voir la liste.\n");
-                } else {
-                    // Obtenir le nom du fichier
-                    char cmd[256];
-                    snprintf(cmd, sizeof(cmd), "ls -1t saved_games/*.txt 2>/dev/null | head -20 | sed -n '%dp'", game_num);
-                    
-                    FILE* p = popen(cmd, "r");
-                    if (!p) {
-                        send_line(clients[i].socket_fd, "MSG Erreur lors de la lecture.\n");
-                    } else {
-                        char filename[256];
-                        if (fgets(filename, sizeof(filename), p)) {
-                            filename[strcspn(filename, "\n")] = 0;
-                            pclose(p);
-                            
-                            // Lire et envoyer le contenu du fichier
-                            FILE* f = fopen(filename, "r");
-                            if (!f) {
-                                send_line(clients[i].socket_fd, "MSG Impossible d'ouvrir le fichier.\n");
-                            } else {
-                                char response[8192] = "REPLAY\n";
-                                char line[512];
-                                
-                                while (fgets(line, sizeof(line), f)) {
-                                    strcat(response, line);
-                                }
-                                
-                                fclose(f);
-                                send_line(clients[i].socket_fd, response);
-                                printf("[%s] a consulté la partie: %s\n", clients[i].username, filename);
-                            }
-                        } else {
-                            pclose(p);
-                            send_line(clients[i].socket_fd, "MSG Partie introuvable.\n");
-                        }
-                    }
+        } else if (strcmp(argv[i], "-u") == 0) {
+            use_uring = 1;
+        } else if (strcmp(argv[i], "-k") == 0 && i + 1 < argc && atoi(argv[i + 1]) >= 0) {
+            heartbeat_s = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage : %s [-t threads] [-e base_de_finales] [-b livre] [-w seuil_Ko] [-r réacteurs] [-u] [-k secondes]\n", argv[0]);
+            return 1;
+        }
+    }
+#ifdef USE_SELECT
+    if (num_reactors > 1) {
+        fprintf(stderr, "Le backend select n'a qu'un réacteur (-r ignoré)\n");
+        num_reactors = 1;
+    }
+    if (use_uring) {
+        fprintf(stderr, "Le backend select n'utilise pas io_uring (-u ignoré)\n");
+        use_uring = 0;
+    }
+#else
+    // io_uring si le noyau sait faire (recv multishot, tampons fournis), sinon epoll
+    for (int k = 0; k < num_reactors && use_uring; k++) {
+        reactors[k].ring = malloc(sizeof(Uring));
+        if (reactors[k].ring == NULL ||
+            uring_init(reactors[k].ring, URING_ENTRIES, URING_BUFFERS, URING_BUFFER_SIZE) < 0) {
+            perror("io_uring indisponible, repli sur epoll");
+            free(reactors[k].ring);
+            reactors[k].ring = NULL;
+            use_uring = 0;
+        }
+    }
+    for (int k = 0; k < num_reactors && !use_uring; k++) {
+        if (reactors[k].ring != NULL) {
+            uring_close(reactors[k].ring);
+            free(reactors[k].ring);
+            reactors[k].ring = NULL;
+        }
+    }
+#endif
+    if (egdb_open(&egdb, egdb_path) == 0) {
+        printf("Base de finales %s : jusqu'à %d graines\n", egdb_path, egdb.max_seeds);
+    }
+    if (book_open(&book, book_path) == 0) {
+        printf("Livre d'ouvertures %s : %llu entrées\n", book_path, (unsigned long long)book.count);
+    }
+    
+    // Initialisation des structures
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        clients[i].socket_fd = -1;
+        clients[i].status = CLIENT_CONNECTED;
+        clients[i].opponent_index = -1;
+        clients[i].challenged_by = -1;
+        clients[i].watching_game = -1;
+        clients[i].save_mode = 0;
+        clients[i].save_response = -1;
+        clients[i].game_to_save = -1;
+        clients[i].is_bot = 0;
+        timer_init(&clients[i].timer, TIMER_CLIENT, i);
+        timer_init(&clients[i].challenge_timer, TIMER_CHALLENGE, i);
+        timer_init(&clients[i].save_timer, TIMER_SAVE, i);
+    }
+    
+    for (int i = 0; i < MAX_GAMES; i++) {
+        games[i].active = 0;
+        games[i].ending = 0;
+        timer_init(&games[i].draw_timer, TIMER_DRAW, i);
+    }
+    
+    // Pipe par lequel les threads des bots renvoient leurs coups ; seule
+    // l'extrémité lue par la boucle principale est non bloquante
+    if (pipe(bot_pipe) < 0 || set_nonblocking(bot_pipe[0]) < 0) {
+        perror("pipe");
+        return 1;
+    }
+    if (tt_init(&bot_tt, BOT_TT_MB) != 0) {
+        perror("tt_init");
+        return 1;
+    }
+    
+    // Service d'analyse : ses threads partagent la table des bots
+    AnalysisConfig analysis_config = {&bot_tt, &egdb};
+    if (pipe(analysis_pipe) < 0 || set_nonblocking(analysis_pipe[0]) < 0 ||
+        analysis_cache_init(&analysis_cache, ANALYSIS_CACHE_SIZE) < 0 ||
+        analysis_start(ANALYSIS_WORKERS, analysis_pipe[1], &analysis_config) < 0) {
+        perror("analysis");
+        return 1;
+    }
+    
+    // Un socket d'écoute, un epoll, un pipe de réveil, une boîte aux lettres
+    // et une roue de timers par réacteur
+    for (int k = 0; k < num_reactors; k++) {
+        Reactor* r = &reactors[k];
+        r->id = k;
+        r->num_to_flush = 0;
+        r->wakes = 0;
+        pthread_mutex_init(&r->lock, NULL);
+        r->mailbox = NULL;
+        r->mailbox_tail = &r->mailbox;
+        timer_wheel_init(&r->timers, TIMER_TICK_MS, timer_now_ms());
+        r->listen_fd = open_listener(num_reactors > 1);
+        if (r->listen_fd < 0) {
+            perror("bind/listen");
+            return 1;
+        }
+        if (pipe(r->wake_pipe) < 0 || set_nonblocking(r->wake_pipe[0]) < 0 ||
+            set_nonblocking(r->wake_pipe[1]) < 0) {
+            perror("pipe");
+            return 1;
+        }
+#ifndef USE_SELECT
+        if (r->ring != NULL) {
+            // io_uring attend lui-même les connexions : socket d'écoute bloquant
+            fcntl(r->listen_fd, F_SETFL, fcntl(r->listen_fd, F_GETFL) & ~O_NONBLOCK);
+            uring_accept_multishot(r->ring, r->listen_fd, URING_DATA(URING_ACCEPT, 0));
+            uring_poll_multishot(r->ring, r->wake_pipe[0], URING_DATA(URING_WAKE, 0));
+            continue;
+        }
+        r->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (r->epoll_fd < 0) {
+            perror("epoll_create1");
+            return 1;
+        }
+        if (watch_fd(r, r->listen_fd, &r->listen_fd) < 0 ||
+            watch_fd(r, r->wake_pipe[0], &r->wake_pipe[0]) < 0) {
+            perror("epoll_ctl");
+            return 1;
+        }
+#endif
+    }
+    current_reactor = &reactors[0];
+    
+    if (num_reactors > 1 || use_uring) {
+        printf("Server on %d (%d réacteur%s, %s)\n", PORT, num_reactors,
+               num_reactors > 1 ? "s" : "", use_uring ? "io_uring" : "epoll");
+    } else {
+        printf("Server on %d\n", PORT);
+    }
+    
+    // Boucle principale du serveur
+#ifdef USE_SELECT
+    int srv = reactors[0].listen_fd;
+    while (1) {
+        // Courrier (coups des bots, analyses), puis réveil au plus tard à la
+        // prochaine échéance de la roue des timers
+        drain_mailbox(&reactors[0]);
+        int timeout_ms = run_timers();
+        flush_scheduled(&reactors[0]);
+        release_closed_slots(&reactors[0]);
+        
+        fd_set rfds;
+        fd_set wfds;
+        FD_ZERO(&rfds);
+        FD_ZERO(&wfds);
+        FD_SET(srv, &rfds);
+        
+        int maxfd = srv;
+        
+        FD_SET(bot_pipe[0], &rfds);
+        if (bot_pipe[0] > maxfd) {
+            maxfd = bot_pipe[0];
+        }
+        FD_SET(analysis_pipe[0], &rfds);
+        if (analysis_pipe[0] > maxfd) {
+            maxfd = analysis_pipe[0];
+        }
+        
+        // Ajouter tous les clients connectés au select (en écriture s'ils ont
+        // une file d'envoi en attente)
+        for (int i = 0; i < MAX_CLIENTS; i++) {
+            if (owned(i) && clients[i].socket_fd > 0) {
+                FD_SET(clients[i].socket_fd, &rfds);
+                if (clients[i].output.len > 0) {
+                    FD_SET(clients[i].socket_fd, &wfds);
                 }
-            }
-            // Commande WATCH - Regarder une partie
-            else if (!strncmp(buf, "WATCH ", 6)) {
-                int game_id = atoi(buf + 6);
-                
-                if (game_id < 0 || game_id >= MAX_CLIENTS / 2 || !games[game_id].active) {
-                    send_line(clients[i].socket_fd, "MSG Partie introuvable.\n");
-                } else if (games[game_id].num_spectators >= MAX_SPECTATORS) {
-                    send_line(clients[i].socket_fd, "MSG Partie pleine (trop de spectateurs).\n");
-                } else if (!can_spectate(i, &games[game_id])) {
-                    send_line(clients[i].socket_fd, "MSG Cette partie est en mode privé. Vous devez être ami avec un des joueurs.\n");
-                } else {
-                    // Ajouter le spectateur
-                    games[game_id].spectator_indices[games[game_id].num_spectators] = i;
-                    games[game_id].num_spectators++;
-                    
-                    clients[i].status = CLIENT_SPECTATING;
-                    clients[i].watching_game = game_id;
-                    
-                    char msg[200];
-                    snprintf(msg, sizeof(msg), "MSG Vous regardez la partie entre %s et %s.\n",
-                             clients[games[game_id].client_indices[0]].username,
-                             clients[games[game_id].client_indices[1]].username);
-                    send_line(clients[i].socket_fd, msg);
-                    
-                    // Envoyer l'état actuel de la partie
-                    send_game_state(&games[game_id], i);
-                    
-                    printf("%s regarde la partie %d\n", clients[i].username, game_id);
+                if (clients[i].socket_fd > maxfd) {
+                    maxfd = clients[i].socket_fd;
                 }
             }
-            // Commande CHAT - Envoyer un message à un joueur ou à tous (broadcast)
-            else if (!strncmp(buf, "CHAT ", 5)) {
-                char* message = buf + 5;
-                
-                // Vérifier si c'est un message privé (format: @username message) ou broadcast (format: message)
-                if (message[0] == '@') {
-                    // Message privé
-                    char* space = strchr(message + 1, ' ');
-                    if (space) {
-                        *space = '\0';
-                        char* target_username = message + 1;
-                        char* msg_content = space + 1;
-                        
-                        int target_idx = find_client_by_username(target_username);
-                        
-                        if (target_idx == -1) {
-                            send_line(clients[i].socket_fd, "MSG Utilisateur introuvable.\n");
-                        } else if (target_idx == i) {
-                            send_line(clients[i].socket_fd, "MSG Vous ne pouvez pas vous envoyer un message à vous-même.\n");
-                        } else if (clients[target_idx].status == CLIENT_EDITING_BIO) {
-                            // Le destinataire est en train d'éditer sa bio
-                            char wait_msg[256];
-                            snprintf(wait_msg, sizeof(wait_msg), 
-                                     "MSG %s est en train d'éditer sa bio. Attendez qu'il termine.\n", 
-                                     clients[target_idx].username);
-                            send_line(clients[i].socket_fd, wait_msg);
-                        } else {
-                            // Envoyer le message privé au destinataire
-                            char chat_msg[512];
-                            snprintf(chat_msg, sizeof(chat_msg), "CHAT [Privé de %s]: %s\n", 
-                                     clients[i].username, msg_content);
-                            send_line(clients[target_idx].socket_fd, chat_msg);
-                            
-                            // NE PAS envoyer de confirmation à l'expéditeur (éviter duplication)
-                        }
-                    } else {
-                        send_line(clients[i].socket_fd, "MSG Format invalide. Utilisez: chat @username message\n");
-                    }
-                } else {
-                    // Message broadcast selon le contexte
-                    char chat_msg[512];
-                    
-                    if (clients[i].status == CLIENT_IN_GAME) {
-                        // En partie : envoyer à l'adversaire et aux spectateurs
-                        Game* g = find_game_for_client(i);
-                        if (g) {
-                            snprintf(chat_msg, sizeof(chat_msg), "CHAT [%s]: %s\n", 
-                                     clients[i].username, message);
-                            
-                            // Envoyer à l'adversaire
-                            int opponent_idx = clients[i].opponent_index;
-                            if (opponent_idx >= 0 && clients[opponent_idx].socket_fd > 0 
-                                && clients[opponent_idx].status != CLIENT_EDITING_BIO) {
-                                send_line(clients[opponent_idx].socket_fd, chat_msg);
-                            }
-                            
-                            // Envoyer aux spectateurs
-                            for (int j = 0; j < g->num_spectators; j++) {
-                                int spec_idx = g->spectator_indices[j];
-                                if (spec_idx >= 0 && clients[spec_idx].socket_fd > 0
-                                    && clients[spec_idx].status != CLIENT_EDITING_BIO) {
-                                    send_line(clients[spec_idx].socket_fd, chat_msg);
-                                }
-                            }
-                        }
-                    } else if (clients[i].status == CLIENT_SPECTATING) {
-                        // En tant que spectateur : envoyer aux joueurs et autres spectateurs
-                        Game* g = &games[clients[i].watching_game];
-                        snprintf(chat_msg, sizeof(chat_msg), "CHAT [Spectateur %s]: %s\n", 
-                                 clients[i].username, message);
-                        
-                        // Envoyer aux joueurs
-                        for (int j = 0; j < 2; j++) {
-                            int player_idx = g->client_indices[j];
-                            if (player_idx >= 0 && clients[player_idx].socket_fd > 0
-                                && clients[player_idx].status != CLIENT_EDITING_BIO) {
-                                send_line(clients[player_idx].socket_fd, chat_msg);
-                            }
-                        }
-                        
-                        // Envoyer aux autres spectateurs (SAUF l'expéditeur)
-                        for (int j = 0; j < g->num_spectators; j++) {
-                            int spec_idx = g->spectator_indices[j];
-                            if (spec_idx >= 0 && spec_idx != i && clients[spec_idx].socket_fd > 0
-                                && clients[spec_idx].status != CLIENT_EDITING_BIO) {
-                                send_line(clients[spec_idx].socket_fd, chat_msg);
-                            }
-                        }
-                    } else {
-                        // Hors partie : broadcast à tous les joueurs en ligne (SAUF l'expéditeur)
-                        snprintf(chat_msg, sizeof(chat_msg), "CHAT [Global - %s]: %s\n", 
-                                 clients[i].username, message);
-                        
-                        for (int j = 0; j < num_clients; j++) {
-                            if (j != i && clients[j].socket_fd > 0 && clients[j].status == CLIENT_WAITING
-                                && clients[j].status != CLIENT_EDITING_BIO) {
-                                send_line(clients[j].socket_fd, chat_msg);
-                            }
-                        }
-                    }
-                }
+        }
+        
+        struct timeval tv = {timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+        if (select(maxfd + 1, &rfds, &wfds, NULL, timeout_ms < 0 ? NULL : &tv) <= 0) {
+            continue;
+        }
+        
+        // Coups des bots
+        if (FD_ISSET(bot_pipe[0], &rfds)) {
+            while (handle_bot_result()) {
             }
-            // Commande CHALLENGE - Défier un autre joueur
-            else if (!strncmp(buf, "CHALLENGE ", 10)) {
-                char target[MAX_USERNAME_LEN];
-                strncpy(target, buf + 10, MAX_USERNAME_LEN - 1);
-                target[MAX_USERNAME_LEN - 1] = '\0';
-                
-                int target_idx = find_client_by_username(target);
-                
-                if (target_idx == -1) {
-                    send_line(clients[i].socket_fd, "MSG Joueur introuvable.\n");
-                } else if (target_idx == i) {
-                    send_line(clients[i].socket_fd, "MSG Vous ne pouvez pas vous défier vous-même.\n");
-                } else if (clients[target_idx].status == CLIENT_IN_GAME) {
-                    send_line(clients[i].socket_fd, "MSG Ce joueur est déjà en partie.\n");
-                } else {
-                    // Enregistrer le défi
-                    clients[target_idx].challenged_by = i;
-                    
-                    // Envoyer le défi
-                    char challenge_msg[128];
-                    snprintf(challenge_msg, sizeof(challenge_msg), "CHALLENGED_BY %s\n", clients[i].username);
-                    send_line(clients[target_idx].socket_fd, challenge_msg);
-                    
-                    send_line(clients[i].socket_fd, "MSG Défi envoyé. En attente de réponse...\n");
-                    printf("[%s] a défié [%s]\n", clients[i].username, target);
-                }
+        }
+        
+        // Analyses terminées (HINT, ANALYZE)
+        if (FD_ISSET(analysis_pipe[0], &rfds)) {
+            while (handle_analysis_result()) {
             }
-            // Commande ACCEPT - Accepter un défi
-            else if (!strncmp(buf, "ACCEPT ", 7)) {
-                char challenger[MAX_USERNAME_LEN];
-                strncpy(challenger, buf + 7, MAX_USERNAME_LEN - 1);
-                challenger[MAX_USERNAME_LEN - 1] = '\0';
-                
-                int challenger_idx = find_client_by_username(challenger);
-                
-                if (challenger_idx == -1) {
-                    send_line(clients[i].socket_fd, "MSG Joueur introuvable.\n");
-                } else if (clients[i].challenged_by != challenger_idx) {
-                    // Vérifier que ce joueur a bien envoyé un défi
-                    send_line(clients[i].socket_fd, "MSG Ce joueur ne vous a pas défié.\n");
-                } else {
-                    // Créer une nouvelle partie
-                    int game_idx = -1;
-                    for (int g = 0; g < MAX_CLIENTS / 2; g++) {
-                        if (!games[g].active) {
-                            game_idx = g;
-                            break;
-                        }
-                    }
-                    
-                    if (game_idx == -1) {
-                        send_line(clients[i].socket_fd, "MSG Serveur plein.\n");
-                        continue;
-                    }
-                    
-                    // Décider aléatoirement qui commence
-                    int first_player = rand() % 2;
-                    
-                    if (first_player == 0) {
-                        games[game_idx].client_indices[0] = challenger_idx;
-                        games[game_idx].client_indices[1] = i;
-                    } else {
-                        games[game_idx].client_indices[0] = i;
-                        games[game_idx].client_indices[1] = challenger_idx;
-                    }
-                    
-                    init_game_state(&games[game_idx]);
-                    games[game_idx].current_player = 0;
-                    
-                    // Enregistrer les noms des joueurs
-                    strcpy(games[game_idx].player_names[0], clients[games[game_idx].client_indices[0]].username);
-                    strcpy(games[game_idx].player_names[1], clients[games[game_idx].client_indices[1]].username);
-                    
-                    // Activer le mode privé si un des joueurs l'a activé
-                    if (clients[challenger_idx].private_mode || clients[i].private_mode) {
-                        games[game_idx].private_mode = 1;
-                    }
-                    
-                    // Mettre à jour les statuts
-                    clients[challenger_idx].status = CLIENT_IN_GAME;
-                    clients[challenger_idx].opponent_index = i;
-                    clients[i].status = CLIENT_IN_GAME;
-                    clients[i].opponent_index = challenger_idx;
-                    clients[i].challenged_by = -1;  // Réinitialiser le défi
-                    
-                    // Attribuer les rôles
-                    clients[games[game_idx].client_indices[0]].player_id = 0;
-                    clients[games[game_idx].client_indices[1]].player_id = 1;
-                    
-                    send_line(clients[games[game_idx].client_indices[0]].socket_fd, "ROLE 0\n");
-                    send_line(clients[games[game_idx].client_indices[1]].socket_fd, "ROLE 1\n");
-                    
-                    // Informer les joueurs
-                    char msg[128];
-                    snprintf(msg, sizeof(msg), "MSG Partie commencée! Vous êtes P1 (pits 0..5). Adversaire: %s\n", 
-                             clients[games[game_idx].client_indices[1]].username);
-                    send_line(clients[games[game_idx].client_indices[0]].socket_fd, msg);
-                    
-                    snprintf(msg, sizeof(msg), "MSG Partie commencée! Vous êtes P2 (pits 6..11). Adversaire: %s\n", 
-                             clients[games[game_idx].client_indices[0]].username);
-                    send_line(clients[games[game_idx].client_indices[1]].socket_fd, msg);
-                    
-                    // Envoyer l'état initial
-                    broadcast_game_state(&games[game_idx]);
-                    
-                    printf("[%s] a accepté le défi de [%s] - Partie %d commencée (P1: %s, P2: %s)\n",
-                           clients[i].username, challenger,
-                           game_idx,
-                           clients[games[game_idx].client_indices[0]].username,
-                           clients[games[game_idx].client_indices[1]].username);
-                }
+        }
+        
+        // Nouvelles connexions
+        if (FD_ISSET(srv, &rfds)) {
+            accept_new_client(&reactors[0]);
+        }
+        
+        // Traiter les messages des clients existants
+        for (int i = 0; i < MAX_CLIENTS; i++) {
+            if (!owned(i)) {
+                continue;
             }
-            // Commande REFUSE - Refuser un défi
-            else if (!strncmp(buf, "REFUSE ", 7)) {
-                char challenger[MAX_USERNAME_LEN];
-                strncpy(challenger, buf + 7, MAX_USERNAME_LEN - 1);
-                challenger[MAX_USERNAME_LEN - 1] = '\0';
-                
-                int challenger_idx = find_client_by_username(challenger);
-                
-                if (challenger_idx == -1) {
-                    send_line(clients[i].socket_fd, "MSG Joueur introuvable.\n");
-                } else if (clients[i].challenged_by != challenger_idx) {
-                    send_line(clients[i].socket_fd, "MSG Ce joueur ne vous a pas défié.\n");
-                } else {
-                    char msg[128];
-                    snprintf(msg, sizeof(msg), "MSG %s a refusé votre défi.\n", clients[i].username);
-                    send_line(clients[challenger_idx].socket_fd, msg);
-                    
-                    clients[i].challenged_by = -1;  // Réinitialiser le défi
-                    send_line(clients[i].socket_fd, "MSG Défi refusé.\n");
-                    
-                    printf("[%s] a refusé le défi de [%s]\n", clients[i].username, challenger);
-                }
+            if (clients[i].socket_fd > 0 && FD_ISSET(clients[i].socket_fd, &wfds)) {
+                flush_client(i);
             }
-            // Commandes de jeu (MOVE, DRAW) pour les clients en partie
-            else if (clients[i].status == CLIENT_IN_GAME) {
-                Game* g = find_game_for_client(i);
-                int game_idx = find_game_index_for_client(i);
-                if (g == NULL || game_idx == -1) continue;
-                
-                int player_id = clients[i].player_id;
-                int opponent_idx = clients[i].opponent_index;
-                
-                // Commande QUIT - Abandonner la partie
-                if (!strcmp(buf, "QUIT")) {
-                    // Le joueur abandonne, l'adversaire gagne
-                    int winner = 1 - player_id;
-                    
-                    char msg[128];
-                    snprintf(msg, sizeof(msg), "MSG %s a abandonné. Vous gagnez!\n", clients[i].username);
-                    send_line(clients[opponent_idx].socket_fd, msg);
-                    
-                    snprintf(msg, sizeof(msg), "END winner %d\n", winner);
-                    send_line(clients[opponent_idx].socket_fd, msg);
-                    
-                    send_line(clients[i].socket_fd, "MSG Vous avez abandonné.\n");
-                    send_line(clients[i].socket_fd, "END forfeit\n");
-                    
-                    // Terminer la partie
-                    char end_msg[64];
-                    snprintf(end_msg, sizeof(end_msg), "END winner %d\n", winner);
-                    end_game(g, end_msg, game_idx);
-                    
-                    printf("%s a abandonné contre %s\n", clients[i].username, clients[opponent_idx].username);
-                    continue;
-                }
-                
-                // Vérifier que c'est bien le tour du joueur
-                if (g->current_player != player_id) {
-                    send_line(clients[i].socket_fd, "MSG Ce n'est pas votre tour.\n");
-                    continue;
-                }
-                
-                // Traitement d'un coup
-                if (!strncmp(buf, "MOVE ", 5)) {
-                    int pit = atoi(buf + 5);
-                    
-                    printf("[%s] joue le pit %d\n", clients[i].username, pit);
-                    
-                    // Copier l'état du jeu dans les variables globales
-                    memcpy(board, g->board, 12);
-                    
-                    int last = apply_move_from_pit(player_id, pit);
-                    
-                    if (last == -2) {
-                        send_line(clients[i].socket_fd, "MSG Coup invalide.\n");
-                        send_game_state(g, i);  // Renvoyer l'état seulement au joueur
-                        continue;
-                    }
-                    
-                    // Mettre à jour l'état du jeu
-                    memcpy(g->board, board, 12);
-                    
-                    // Informer l'adversaire et les spectateurs
-                    char notify[128];
-                    snprintf(notify, sizeof(notify), "MSG %s a déplacé les graines de la case %d.\n", 
-                             clients[i].username, pit);
-                    send_line(clients[opponent_idx].socket_fd, notify);
-                    
-                    // Envoyer aussi aux spectateurs
-                    for (int j = 0; j < g->num_spectators; j++) {
-                        int spec_idx = g->spectator_indices[j];
-                        if (spec_idx >= 0 && clients[spec_idx].socket_fd > 0) {
-                            send_line(clients[spec_idx].socket_fd, notify);
-                        }
-                    }
-                    
-                    // Capturer les graines
-                    char gained = collect_seeds((char)player_id, (char)last);
-                    g->scores[player_id] += gained;
-                    
-                    // Enregistrer le coup dans l'historique
-                    if (g->num_moves < MAX_MOVES) {
-                        g->moves[g->num_moves].player = player_id;
-                        g->moves[g->num_moves].pit = pit;
-                        g->moves[g->num_moves].seeds_captured = gained;
-                        g->num_moves++;
-                    }
-                    
-                    // Vérifier fin de partie
-                    memcpy(board, g->board, 12);
-                    memcpy(scores, g->scores, 2);
-                    
-                    if (is_game_over(CONTINUE)) {
-                        collect_remaining_seeds(CONTINUE);
-                        memcpy(g->scores, scores, 2);
-                        memcpy(g->board, board, 12);
-                        broadcast_game_state(g);
-                        
-                        char end_msg[32];
-                        if (g->scores[0] == g->scores[1]) {
-                            send_line(clients[g->client_indices[0]].socket_fd, "END draw\n");
-                            send_line(clients[g->client_indices[1]].socket_fd, "END draw\n");
-                            strcpy(end_msg, "END draw\n");
-                        } else {
-                            int w = (g->scores[0] > g->scores[1]) ? 0 : 1;
-                            snprintf(end_msg, sizeof(end_msg), "END winner %d\n", w);
-                            send_line(clients[g->client_indices[0]].socket_fd, end_msg);
-                            send_line(clients[g->client_indices[1]].socket_fd, end_msg);
-                        }
-                        
-                        // Terminer la partie
-                        end_game(g, end_msg, game_idx);
-                        continue;
-                    }
-                    
-                    // Changement de joueur
-                    g->current_player = 1 - g->current_player;
-                    broadcast_game_state(g);
-                }
-                // Traitement d'une demande d'égalité
-                else if (!strcmp(buf, "DRAW")) {
-                    printf("[%s] propose l'égalité à [%s]\n", 
-                           clients[i].username, clients[opponent_idx].username);
-                    
-                    send_line(clients[opponent_idx].socket_fd, "ASKDRAW\n");
-                    
-                    char ans[16];
-                    if (recv_line(clients[opponent_idx].socket_fd, ans, sizeof(ans)) > 0) {
-                        if (!strcmp(ans, "YES")) {
-                            memcpy(board, g->board, 12);
-                            memcpy(scores, g->scores, 2);
-                            collect_remaining_seeds(DRAW);
-                            
-                            send_line(clients[g->client_indices[0]].socket_fd, "MSG Égalité acceptée.\n");
-                            send_line(clients[g->client_indices[1]].socket_fd, "MSG Égalité acceptée.\n");
-                            send_line(clients[g->client_indices[0]].socket_fd, "END draw\n");
-                            send_line(clients[g->client_indices[1]].socket_fd, "END draw\n");
-                            
-                            printf("Égalité acceptée entre [%s] et [%s]\n",
-                                   clients[g->client_indices[0]].username,
-                                   clients[g->client_indices[1]].username);
-                            
-                            // Terminer la partie
-                            end_game(g, "END draw\n", game_idx);
-                        } else {
-                            send_line(clients[i].socket_fd, "MSG Égalité refusée.\n");
-                            send_line(clients[opponent_idx].socket_fd, "MSG Égalité refusée par l'adversaire.\n");
-                            broadcast_game_state(g);
-                            
-                            printf("[%s] a refusé l'égalité proposée par [%s]\n",
-                                   clients[opponent_idx].username, clients[i].username);
-                        }
-                    }
-                }
+            if (clients[i].socket_fd > 0 && FD_ISSET(clients[i].socket_fd, &rfds)) {
+                handle_client_events(i);
             }
         }
     }
+#else
+    // Les pipes des bots et de l'analyse sont lus par le réacteur 0, qui
+    // tourne dans le thread principal
+    if (reactors[0].ring != NULL) {
+        uring_poll_multishot(reactors[0].ring, bot_pipe[0], URING_DATA(URING_BOT, 0));
+        uring_poll_multishot(reactors[0].ring, analysis_pipe[0], URING_DATA(URING_ANALYSIS, 0));
+    } else if (watch_fd(&reactors[0], bot_pipe[0], &bot_pipe[0]) < 0 ||
+               watch_fd(&reactors[0], analysis_pipe[0], &analysis_pipe[0]) < 0) {
+        perror("epoll_ctl");
+        return 1;
+    }
+    for (int k = 1; k < num_reactors; k++) {
+        if (pthread_create(&reactors[k].thread, NULL, reactor_main, &reactors[k]) != 0) {
+            perror("pthread_create");
+            return 1;
+        }
+    }
+    reactor_main(&reactors[0]);
+#endif
     
     // Nettoyage
-    for (int i = 0; i < num_clients; i++) {
+    for (int i = 0; i < MAX_CLIENTS; i++) {
         if (clients[i].socket_fd > 0) {
             close(clients[i].socket_fd);
         }
     }
-    close(srv);
+    for (int k = 0; k < num_reactors; k++) {
+        close(reactors[k].listen_fd);
+    }
     
     return 0;
 }
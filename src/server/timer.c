@@ -0,0 +1,161 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+#include "../../include/timer.h"
+
+#include <limits.h>
+#include <string.h>
+#include <time.h>
+
+#define TIMER_MASK (TIMER_SLOTS - 1)
+#define TIMER_HORIZON ((uint64_t)1 << (TIMER_LEVELS * TIMER_SLOT_BITS))  // En ticks
+
+uint64_t timer_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+void timer_wheel_init(TimerWheel* w, unsigned tick_ms, uint64_t now_ms) {
+    memset(w, 0, sizeof(*w));
+    w->tick_ms = tick_ms > 0 ? tick_ms : 1;
+    w->origin_ms = now_ms;
+}
+
+void timer_init(Timer* t, int kind, int idx) {
+    t->next = NULL;
+    t->pprev = NULL;
+    t->expires = 0;
+    t->kind = kind;
+    t->idx = idx;
+}
+
+static void link_timer(Timer** head, Timer* t) {
+    t->next = *head;
+    if (t->next != NULL) {
+        t->next->pprev = &t->next;
+    }
+    *head = t;
+    t->pprev = head;
+}
+
+static void unlink_timer(Timer* t) {
+    *t->pprev = t->next;
+    if (t->next != NULL) {
+        t->next->pprev = t->pprev;
+    }
+    t->next = NULL;
+    t->pprev = NULL;
+}
+
+/**
+ * Range un timer au niveau le plus fin qui contient son échéance, dans la
+ * case que ce niveau atteindra à l'échéance
+ */
+static void place(TimerWheel* w, Timer* t) {
+    uint64_t delta = t->expires - w->tick;
+    int level = 0;
+    while (level < TIMER_LEVELS - 1 && delta >= (uint64_t)1 << ((level + 1) * TIMER_SLOT_BITS)) {
+        level++;
+    }
+    link_timer(&w->slots[level][(t->expires >> (level * TIMER_SLOT_BITS)) & TIMER_MASK], t);
+}
+
+void timer_arm(TimerWheel* w, Timer* t, uint64_t delay_ms, uint64_t now_ms) {
+    if (t->pprev != NULL) {
+        unlink_timer(t);
+    } else {
+        w->armed++;
+    }
+    uint64_t at = now_ms + delay_ms > w->origin_ms ? now_ms + delay_ms - w->origin_ms : 0;
+    t->expires = (at + w->tick_ms - 1) / w->tick_ms;
+    if (t->expires < w->tick) {
+        t->expires = w->tick;
+    } else if (t->expires - w->tick >= TIMER_HORIZON) {
+        t->expires = w->tick + TIMER_HORIZON - 1;
+    }
+    place(w, t);
+}
+
+void timer_cancel(TimerWheel* w, Timer* t) {
+    if (t->pprev != NULL) {
+        unlink_timer(t);
+        w->armed--;
+    }
+}
+
+int timer_armed(const Timer* t) {
+    return t->pprev != NULL;
+}
+
+/**
+ * Traite le tick w->tick : à chaque tour complet d'un niveau, la case
+ * courante du niveau au-dessus est redistribuée plus finement, puis les
+ * timers de la case du niveau 0 passent dans la liste des échus
+ */
+static void process_tick(TimerWheel* w) {
+    for (int level = 1; level < TIMER_LEVELS; level++) {
+        if (w->tick & (((uint64_t)1 << (level * TIMER_SLOT_BITS)) - 1)) {
+            break;
+        }
+        Timer** slot = &w->slots[level][(w->tick >> (level * TIMER_SLOT_BITS)) & TIMER_MASK];
+        Timer* t = *slot;
+        *slot = NULL;
+        while (t != NULL) {
+            Timer* next = t->next;
+            place(w, t);
+            t = next;
+        }
+    }
+    Timer** slot = &w->slots[0][w->tick & TIMER_MASK];
+    Timer* t = *slot;
+    *slot = NULL;
+    while (t != NULL) {
+        Timer* next = t->next;
+        link_timer(&w->due, t);
+        t = next;
+    }
+    w->tick++;
+}
+
+Timer* timer_next_expired(TimerWheel* w, uint64_t now_ms) {
+    uint64_t elapsed = now_ms > w->origin_ms ? (now_ms - w->origin_ms) / w->tick_ms : 0;
+    while (w->due == NULL && w->tick <= elapsed) {
+        if (w->armed == 0) {
+            w->tick = elapsed + 1;  // Roue vide : rien à parcourir
+            break;
+        }
+        process_tick(w);
+    }
+    Timer* t = w->due;
+    if (t != NULL) {
+        unlink_timer(t);
+        w->armed--;
+    }
+    return t;
+}
+
+int timer_timeout_ms(const TimerWheel* w, uint64_t now_ms) {
+    if (w->armed == 0) {
+        return -1;
+    }
+    if (w->due != NULL) {
+        return 0;
+    }
+    // Première case non vide du niveau 0, ou fin de son tour (redistribution)
+    uint64_t t = w->tick;
+    while ((t & TIMER_MASK) != 0 && w->slots[0][t & TIMER_MASK] == NULL) {
+        t++;
+    }
+    uint64_t deadline = w->origin_ms + t * w->tick_ms;
+    if (deadline <= now_ms) {
+        return 0;
+    }
+    return deadline - now_ms > INT_MAX ? INT_MAX : (int)(deadline - now_ms);
+}
@@ -0,0 +1,310 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+// Sans objet avec le backend select (qui doit aussi compiler hors Linux)
+#ifndef USE_SELECT
+
+#include "../../include/uring.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#define URING_BUFFER_GROUP 0
+
+static int sys_setup(unsigned entries, struct io_uring_params* p) {
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int sys_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags,
+                     const void* arg, size_t argsz) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, argsz);
+}
+
+static int sys_register(int fd, unsigned opcode, const void* arg, unsigned nr_args) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+static unsigned pending_sqes(const Uring* u) {
+    return *u->sq_tail - __atomic_load_n(u->sq_head, __ATOMIC_ACQUIRE);
+}
+
+/**
+ * Prochaine SQE libre, remise à zéro ; si la file est pleine, ce qui est
+ * préparé part d'abord au noyau
+ */
+static struct io_uring_sqe* get_sqe(Uring* u) {
+    if (pending_sqes(u) >= u->sq_entries) {
+        sys_enter(u->fd, pending_sqes(u), 0, 0, NULL, 0);
+    }
+    unsigned tail = *u->sq_tail;
+    struct io_uring_sqe* sqe = &u->sqes[tail & u->sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+    u->sq_array[tail & u->sq_mask] = tail & u->sq_mask;
+    return sqe;
+}
+
+static void commit_sqe(Uring* u) {
+    __atomic_store_n(u->sq_tail, *u->sq_tail + 1, __ATOMIC_RELEASE);
+}
+
+static void add_buffer(Uring* u, unsigned bid) {
+    unsigned short tail = u->buf_ring->tail;
+    struct io_uring_buf* b = &u->buf_ring->bufs[tail & (u->buf_count - 1)];
+    b->addr = (uint64_t)(uintptr_t)(u->buffers + (size_t)bid * u->buf_size);
+    b->len = u->buf_size;
+    b->bid = (uint16_t)bid;
+    __atomic_store_n(&u->buf_ring->tail, (unsigned short)(tail + 1), __ATOMIC_RELEASE);
+}
+
+/**
+ * Le recv multishot (noyau 6.0) ne se détecte qu'à l'usage : un octet
+ * échangé sur une paire de sockets doit arriver avec IORING_CQE_F_MORE
+ */
+static int probe_recv_multishot(Uring* u) {
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sv) < 0) {
+        return -1;
+    }
+    uring_recv_multishot(u, sv[0], 0);
+    int ok = write(sv[1], "x", 1) == 1 && uring_submit_and_wait(u, 1000) == 0;
+    struct io_uring_cqe* cqe = uring_peek_cqe(u);
+    ok = ok && cqe != NULL && cqe->res == 1 && (cqe->flags & IORING_CQE_F_MORE);
+    // Fermer la paire termine le recv : attendre sa dernière complétion
+    shutdown(sv[0], SHUT_RDWR);
+    while (cqe != NULL) {
+        int more = cqe->flags & IORING_CQE_F_MORE;
+        if (cqe->flags & IORING_CQE_F_BUFFER) {
+            uring_recycle_buffer(u, cqe);
+        }
+        uring_cqe_seen(u);
+        if (!more) {
+            break;
+        }
+        if (uring_submit_and_wait(u, 1000) < 0) {
+            ok = 0;
+            break;
+        }
+        cqe = uring_peek_cqe(u);
+    }
+    close(sv[0]);
+    close(sv[1]);
+    if (!ok) {
+        errno = EOPNOTSUPP;
+        return -1;
+    }
+    return 0;
+}
+
+int uring_init(Uring* u, unsigned entries, unsigned buf_count, unsigned buf_size) {
+    memset(u, 0, sizeof(*u));
+    u->fd = -1;
+
+    // Les opérations multishot produisent plus de complétions que de soumissions
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    p.flags = IORING_SETUP_CQSIZE;
+    p.cq_entries = 4 * entries;
+    u->fd = sys_setup(entries, &p);
+    if (u->fd < 0) {
+        return -1;
+    }
+    if (!(p.features & IORING_FEAT_SINGLE_MMAP) || !(p.features & IORING_FEAT_EXT_ARG)) {
+        uring_close(u);
+        errno = EOPNOTSUPP;
+        return -1;
+    }
+
+    // Les deux anneaux partagent une seule projection
+    size_t cq_ring_size = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    u->sq_ring_size = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    if (cq_ring_size > u->sq_ring_size) {
+        u->sq_ring_size = cq_ring_size;
+    }
+    u->sq_ring = mmap(NULL, u->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      u->fd, IORING_OFF_SQ_RING);
+    if (u->sq_ring == MAP_FAILED) {
+        u->sq_ring = NULL;
+        uring_close(u);
+        return -1;
+    }
+    u->cq_ring = u->sq_ring;
+    u->sqes_size = p.sq_entries * sizeof(struct io_uring_sqe);
+    u->sqes = mmap(NULL, u->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   u->fd, IORING_OFF_SQES);
+    if (u->sqes == MAP_FAILED) {
+        u->sqes = NULL;
+        uring_close(u);
+        return -1;
+    }
+    char* sq = u->sq_ring;
+    u->sq_head = (unsigned*)(sq + p.sq_off.head);
+    u->sq_tail = (unsigned*)(sq + p.sq_off.tail);
+    u->sq_mask = *(unsigned*)(sq + p.sq_off.ring_mask);
+    u->sq_array = (unsigned*)(sq + p.sq_off.array);
+    u->sq_entries = p.sq_entries;
+    char* cq = u->cq_ring;
+    u->cq_head = (unsigned*)(cq + p.cq_off.head);
+    u->cq_tail = (unsigned*)(cq + p.cq_off.tail);
+    u->cq_mask = *(unsigned*)(cq + p.cq_off.ring_mask);
+    u->cqes = (struct io_uring_cqe*)(cq + p.cq_off.cqes);
+
+    // Anneau de tampons de réception (buffer ring, noyau 5.19) ; buf_count
+    // doit être une puissance de deux
+    u->buf_count = buf_count;
+    u->buf_size = buf_size;
+    u->buf_ring_size = buf_count * sizeof(struct io_uring_buf);
+    u->buf_ring = mmap(NULL, u->buf_ring_size, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    u->buffers = mmap(NULL, (size_t)buf_count * buf_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (u->buf_ring == MAP_FAILED || u->buffers == MAP_FAILED) {
+        u->buf_ring = u->buf_ring == MAP_FAILED ? NULL : u->buf_ring;
+        u->buffers = u->buffers == MAP_FAILED ? NULL : u->buffers;
+        uring_close(u);
+        return -1;
+    }
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(reg));
+    reg.ring_addr = (uint64_t)(uintptr_t)u->buf_ring;
+    reg.ring_entries = buf_count;
+    reg.bgid = URING_BUFFER_GROUP;
+    if (sys_register(u->fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+        uring_close(u);
+        return -1;
+    }
+    for (unsigned bid = 0; bid < buf_count; bid++) {
+        add_buffer(u, bid);
+    }
+
+    if (probe_recv_multishot(u) < 0) {
+        uring_close(u);
+        errno = EOPNOTSUPP;
+        return -1;
+    }
+    return 0;
+}
+
+void uring_close(Uring* u) {
+    if (u->buffers != NULL) {
+        munmap(u->buffers, (size_t)u->buf_count * u->buf_size);
+    }
+    if (u->buf_ring != NULL) {
+        munmap(u->buf_ring, u->buf_ring_size);
+    }
+    if (u->sqes != NULL) {
+        munmap(u->sqes, u->sqes_size);
+    }
+    if (u->sq_ring != NULL) {
+        munmap(u->sq_ring, u->sq_ring_size);
+    }
+    if (u->fd >= 0) {
+        close(u->fd);
+    }
+    memset(u, 0, sizeof(*u));
+    u->fd = -1;
+}
+
+void uring_accept_multishot(Uring* u, int fd, uint64_t user_data) {
+    struct io_uring_sqe* sqe = get_sqe(u);
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe->user_data = user_data;
+    commit_sqe(u);
+}
+
+void uring_recv_multishot(Uring* u, int fd, uint64_t user_data) {
+    struct io_uring_sqe* sqe = get_sqe(u);
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = URING_BUFFER_GROUP;
+    sqe->user_data = user_data;
+    commit_sqe(u);
+}
+
+void uring_send(Uring* u, int fd, const void* buf, size_t len, uint64_t user_data) {
+    struct io_uring_sqe* sqe = get_sqe(u);
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)buf;
+    sqe->len = (unsigned)len;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = user_data;
+    commit_sqe(u);
+}
+
+void uring_poll_multishot(Uring* u, int fd, uint64_t user_data) {
+    struct io_uring_sqe* sqe = get_sqe(u);
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = POLLIN;
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->user_data = user_data;
+    commit_sqe(u);
+}
+
+void uring_cancel(Uring* u, uint64_t target, uint64_t user_data) {
+    struct io_uring_sqe* sqe = get_sqe(u);
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = target;
+    sqe->user_data = user_data;
+    commit_sqe(u);
+}
+
+int uring_submit_and_wait(Uring* u, int timeout_ms) {
+    struct __kernel_timespec ts;
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0, sizeof(arg));
+    unsigned flags = IORING_ENTER_GETEVENTS;
+    const void* argp = NULL;
+    size_t argsz = 0;
+    if (timeout_ms >= 0) {
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = (long long)(timeout_ms % 1000) * 1000000;
+        arg.ts = (uint64_t)(uintptr_t)&ts;
+        flags |= IORING_ENTER_EXT_ARG;
+        argp = &arg;
+        argsz = sizeof(arg);
+    }
+    if (sys_enter(u->fd, pending_sqes(u), 1, flags, argp, argsz) < 0 &&
+        errno != ETIME && errno != EINTR) {
+        return -1;
+    }
+    return 0;
+}
+
+struct io_uring_cqe* uring_peek_cqe(Uring* u) {
+    unsigned head = *u->cq_head;
+    if (head == __atomic_load_n(u->cq_tail, __ATOMIC_ACQUIRE)) {
+        return NULL;
+    }
+    return &u->cqes[head & u->cq_mask];
+}
+
+void uring_cqe_seen(Uring* u) {
+    __atomic_store_n(u->cq_head, *u->cq_head + 1, __ATOMIC_RELEASE);
+}
+
+const char* uring_buffer(const Uring* u, const struct io_uring_cqe* cqe) {
+    return u->buffers + (size_t)(cqe->flags >> IORING_CQE_BUFFER_SHIFT) * u->buf_size;
+}
+
+void uring_recycle_buffer(Uring* u, const struct io_uring_cqe* cqe) {
+    add_buffer(u, cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+}
+
+#endif // USE_SELECT
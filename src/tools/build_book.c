@@ -0,0 +1,164 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+// Construction du livre d'ouvertures (voir include/book.h)
+// Parcourt les parties sauvegardées une à une, compte pour chaque position
+// des premiers demi-coups les coups joués et leur issue, puis écrit les
+// entrées triées par clé.
+//
+// Usage : build_book [-p demi-coups] [-m parties_min] [dossier] [fichier]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/archive.h"
+#include "../../include/book.h"
+
+#define DEFAULT_PLIES 16
+#define DEFAULT_OUTPUT "bin/awale.book"
+
+// Table de hachage (position, coup) -> entrée, adressage ouvert
+typedef struct {
+    BookEntry* slots;
+    size_t capacity;     // Puissance de 2
+    size_t used;
+    int plies;
+    int games;
+    int skipped;
+} Builder;
+
+static size_t slot_of(const Builder* b, uint64_t key, int pit) {
+    uint64_t h = (key ^ (uint64_t)pit * 0x9E3779B97F4A7C15ull) * 0xBF58476D1CE4E5B9ull;
+    return (size_t)(h >> 16) & (b->capacity - 1);
+}
+
+static BookEntry* lookup(Builder* b, uint64_t key, int pit) {
+    if (2 * (b->used + 1) > b->capacity) {
+        Builder grown = *b;
+        grown.capacity = b->capacity ? 2 * b->capacity : 4096;
+        grown.slots = calloc(grown.capacity, sizeof(BookEntry));
+        grown.used = 0;
+        for (size_t i = 0; i < b->capacity; i++) {
+            if (b->slots[i].games > 0) {
+                size_t j = slot_of(&grown, b->slots[i].key, b->slots[i].pit);
+                while (grown.slots[j].games > 0) {
+                    j = (j + 1) & (grown.capacity - 1);
+                }
+                grown.slots[j] = b->slots[i];
+                grown.used++;
+            }
+        }
+        free(b->slots);
+        *b = grown;
+    }
+
+    size_t i = slot_of(b, key, pit);
+    while (b->slots[i].games > 0 && (b->slots[i].key != key || b->slots[i].pit != pit)) {
+        i = (i + 1) & (b->capacity - 1);
+    }
+    if (b->slots[i].games == 0) {
+        b->slots[i].key = key;
+        b->slots[i].pit = (uint8_t)pit;
+        b->used++;
+    }
+    return &b->slots[i];
+}
+
+static void add_game(const char* path, const ArchiveGame* game, int ok, void* ctx) {
+    Builder* b = ctx;
+    if (!ok || game->winner == ARCHIVE_UNFINISHED) {
+        if (!ok) {
+            fprintf(stderr, "%s:%d : %s (ignorée)\n", path, game->line, game->error);
+        }
+        b->skipped++;
+        return;
+    }
+
+    AwaleState s;
+    awale_init(&s);
+    for (int i = 0; i < game->num_moves && i < b->plies; i++) {
+        BookEntry* e = lookup(b, s.key, game->pits[i]);
+        int mover = s.current_player;
+        e->games++;
+        e->wins += game->winner == mover;
+        e->draws += game->winner == ARCHIVE_DRAW;
+        awale_play(&s, game->pits[i]);
+    }
+    b->games++;
+}
+
+static int by_key(const void* a, const void* b) {
+    const BookEntry* x = a;
+    const BookEntry* y = b;
+    if (x->key != y->key) {
+        return x->key < y->key ? -1 : 1;
+    }
+    return (int)x->pit - (int)y->pit;
+}
+
+int main(int argc, char** argv) {
+    Builder b = {NULL, 0, 0, DEFAULT_PLIES, 0, 0};
+    unsigned min_games = 1;
+    const char* dir = ARCHIVE_DIR;
+    const char* output = DEFAULT_OUTPUT;
+    int positional = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            b.plies = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            min_games = (unsigned)atoi(argv[++i]);
+        } else if (argv[i][0] != '-' && positional == 0) {
+            dir = argv[i];
+            positional++;
+        } else if (argv[i][0] != '-' && positional == 1) {
+            output = argv[i];
+            positional++;
+        } else {
+            fprintf(stderr, "Usage : %s [-p demi-coups] [-m parties_min] [dossier] [fichier]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    if (archive_scan(dir, add_game, &b) < 0) {
+        perror(dir);
+        return 1;
+    }
+
+    // Compactage puis tri par clé
+    size_t count = 0;
+    for (size_t i = 0; i < b.capacity; i++) {
+        if (b.slots[i].games >= min_games && b.slots[i].games > 0) {
+            b.slots[count++] = b.slots[i];
+        }
+    }
+    if (count > 0) {
+        qsort(b.slots, count, sizeof(BookEntry), by_key);
+    }
+
+    FILE* f = fopen(output, "wb");
+    if (f == NULL) {
+        perror(output);
+        return 1;
+    }
+    BookHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, BOOK_MAGIC, 4);
+    header.version = BOOK_VERSION;
+    header.count = count;
+    int ok = fwrite(&header, sizeof(header), 1, f) == 1 &&
+             fwrite(b.slots, sizeof(BookEntry), count, f) == count;
+    if (fclose(f) != 0 || !ok) {
+        perror(output);
+        return 1;
+    }
+    printf("%d parties (%d ignorées), %zu entrées écrites dans %s\n", b.games, b.skipped, count, output);
+    free(b.slots);
+    return 0;
+}
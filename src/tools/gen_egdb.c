@@ -0,0 +1,228 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+// Générateur de la base de finales (voir include/egdb.h)
+//
+// Les positions à n graines sont résolues par n croissant : une capture mène
+// à une table déjà calculée, un coup sans capture reste dans la table en
+// cours, qui peut contenir des cycles. Pour chaque seuil t, on calcule
+// par balayages successifs jusqu'au point fixe les positions où le joueur au
+// trait peut s'assurer un écart >= t (ensemble W) et celles où l'adversaire
+// peut lui imposer <= -t (ensemble L). Une partie sans fin vaut 0 : elle
+// n'appartient à aucun des deux ensembles. La valeur d'une position est le
+// plus grand t tel qu'elle soit dans W (ou -t dans L), 0 sinon.
+//
+// Usage : gen_egdb [-n graines] fichier
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../../include/egdb.h"
+
+#define DEFAULT_SEEDS 12
+#define NO_MOVE 0xFF
+
+// Coups d'une position, précalculés une fois par table
+typedef struct {
+    uint32_t child[PITS_PER_SIDE];   // Index de la position obtenue
+    uint8_t captured[PITS_PER_SIDE]; // Graines capturées, NO_MOVE si coup illégal
+    int8_t terminal;                 // Vrai si aucun coup légal
+    int8_t terminal_value;           // Écart si chaque joueur ramasse son camp
+} Successors;
+
+// Répartitions de seeds graines dans pits cases : C(seeds + pits - 1, pits - 1)
+static uint64_t compositions(int seeds, int pits) {
+    uint64_t c = 1;
+    for (int j = 1; j < pits; j++) {
+        c = c * (seeds + j) / j;
+    }
+    return c;
+}
+
+// Inverse de egdb_index
+static void unrank(uint64_t index, int seeds, char board[NUM_PITS]) {
+    int remaining = seeds;
+    for (int i = 0; i < NUM_PITS - 1; i++) {
+        int v = 0;
+        for (;; v++) {
+            uint64_t count = compositions(remaining - v, NUM_PITS - 1 - i);
+            if (index < count) {
+                break;
+            }
+            index -= count;
+        }
+        board[i] = (char)v;
+        remaining -= v;
+    }
+    board[NUM_PITS - 1] = (char)remaining;
+}
+
+static void build_successors(int seeds, Successors* succ, uint64_t count) {
+    for (uint64_t i = 0; i < count; i++) {
+        AwaleState s;
+        memset(&s, 0, sizeof(s));
+        unrank(i, seeds, s.board);
+        s.key = awale_hash(&s);
+
+        Successors* out = &succ[i];
+        memset(out->captured, NO_MOVE, sizeof(out->captured));
+        int legal = awale_legal_moves(&s);
+        out->terminal = legal == 0;
+        if (out->terminal) {
+            int own = 0;
+            for (int p = 0; p < PITS_PER_SIDE; p++) {
+                own += s.board[p];
+            }
+            out->terminal_value = (int8_t)(2 * own - seeds);
+            continue;
+        }
+        for (int pit = 0; pit < PITS_PER_SIDE; pit++) {
+            if (!((legal >> pit) & 1)) {
+                continue;
+            }
+            AwaleState child = s;
+            int gained = awale_play(&child, pit);
+            // L'adversaire devient le joueur au trait : ses cases d'abord
+            char board[NUM_PITS];
+            for (int p = 0; p < NUM_PITS; p++) {
+                board[p] = child.board[(p + PITS_PER_SIDE) % NUM_PITS];
+            }
+            out->captured[pit] = (uint8_t)gained;
+            out->child[pit] = (uint32_t)egdb_index(board, seeds - gained);
+        }
+    }
+}
+
+/**
+ * Résout la table à seeds graines ; les tables plus petites sont dans tables[]
+ */
+static void solve(int seeds, int8_t** tables, const Successors* succ, uint64_t count) {
+    int8_t* value = tables[seeds];
+    uint8_t* state = malloc(count);  // Bit 0 : dans W, bit 1 : dans L
+    memset(value, 0, count);
+
+    for (int t = 1; t <= seeds; t++) {
+        memset(state, 0, count);
+        int changed = 1;
+        while (changed) {
+            changed = 0;
+            for (uint64_t i = 0; i < count; i++) {
+                if (state[i]) {
+                    continue;
+                }
+                const Successors* s = &succ[i];
+                int win = 0;
+                int loss = 1;
+                if (s->terminal) {
+                    win = s->terminal_value >= t;
+                    loss = s->terminal_value <= -t;
+                } else {
+                    for (int pit = 0; pit < PITS_PER_SIDE && !win; pit++) {
+                        int c = s->captured[pit];
+                        if (c == NO_MOVE) {
+                            continue;
+                        }
+                        if (c > 0) {
+                            int gain = c - tables[seeds - c][s->child[pit]];
+                            win = gain >= t;
+                            loss &= gain <= -t;
+                        } else {
+                            win = (state[s->child[pit]] & 2) != 0;
+                            loss &= (state[s->child[pit]] & 1) != 0;
+                        }
+                    }
+                }
+                if (win || loss) {
+                    state[i] = win ? 1 : 2;
+                    changed = 1;
+                }
+            }
+        }
+        for (uint64_t i = 0; i < count; i++) {
+            if (state[i] & 1) {
+                value[i] = (int8_t)t;
+            } else if (state[i] & 2) {
+                value[i] = (int8_t)-t;
+            }
+        }
+    }
+    free(state);
+}
+
+int main(int argc, char** argv) {
+    int max_seeds = DEFAULT_SEEDS;
+    const char* path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            max_seeds = atoi(argv[++i]);
+        } else if (argv[i][0] != '-' && path == NULL) {
+            path = argv[i];
+        } else {
+            path = NULL;
+            break;
+        }
+    }
+    if (path == NULL || max_seeds < 0 || max_seeds > EGDB_MAX_SEEDS) {
+        fprintf(stderr, "Usage : %s [-n graines (max %d)] fichier\n", argv[0], EGDB_MAX_SEEDS);
+        return 2;
+    }
+
+    EgdbHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, EGDB_MAGIC, 4);
+    header.version = EGDB_VERSION;
+    header.max_seeds = max_seeds;
+    uint64_t offset = sizeof(header);
+    for (int n = 0; n <= max_seeds; n++) {
+        header.offsets[n] = offset;
+        offset += egdb_count(n);
+    }
+
+    int8_t* tables[EGDB_MAX_SEEDS + 1];
+    for (int n = 0; n <= max_seeds; n++) {
+        uint64_t count = egdb_count(n);
+        clock_t t0 = clock();
+        tables[n] = malloc(count);
+        Successors* succ = malloc(count * sizeof(Successors));
+        if (tables[n] == NULL || succ == NULL) {
+            fprintf(stderr, "Mémoire insuffisante pour %d graines\n", n);
+            return 1;
+        }
+        build_successors(n, succ, count);
+        solve(n, tables, succ, count);
+        free(succ);
+
+        uint64_t wins = 0;
+        uint64_t losses = 0;
+        for (uint64_t i = 0; i < count; i++) {
+            wins += tables[n][i] > 0;
+            losses += tables[n][i] < 0;
+        }
+        fprintf(stderr, "%2d graines : %10llu positions (%5.1f%% gagnées, %5.1f%% perdues) en %.1f s\n",
+                n, (unsigned long long)count, 100.0 * wins / count, 100.0 * losses / count,
+                (double)(clock() - t0) / CLOCKS_PER_SEC);
+    }
+
+    FILE* f = fopen(path, "wb");
+    if (f == NULL) {
+        perror(path);
+        return 1;
+    }
+    int ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    for (int n = 0; ok && n <= max_seeds; n++) {
+        ok = fwrite(tables[n], 1, egdb_count(n), f) == egdb_count(n);
+    }
+    if (fclose(f) != 0 || !ok) {
+        perror(path);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,99 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+// Générateur des tables de semis (exécuté à la compilation, voir Makefile)
+// Pour chaque (case de départ, nombre de graines), on précalcule l'incrément
+// de chaque case (tours complets + reste) et l'index de la dernière case semée.
+// Génère aussi les clés de Zobrist, tirées avec une graine fixe pour que le
+// hash d'une position soit le même d'un binaire à l'autre.
+
+#include <stdint.h>
+#include <stdio.h>
+
+#define NUM_PITS 12
+#define TOTAL_SEEDS 48
+#define ZOBRIST_SEED 0x41574C45u  // "AWLE"
+
+static uint64_t splitmix64(uint64_t* x) {
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static void print_keys(const char* name, int rows, uint64_t* rng) {
+    printf("static const uint64_t %s[%d][%d] = {\n", name, rows, TOTAL_SEEDS + 1);
+    for (int r = 0; r < rows; r++) {
+        printf("    {");
+        for (int n = 0; n <= TOTAL_SEEDS; n++) {
+            uint64_t key = splitmix64(rng);
+            printf("0x%016llxull%s%s", (unsigned long long)key,
+                   n < TOTAL_SEEDS ? "," : "", n % 4 == 3 && n < TOTAL_SEEDS ? "\n     " : "");
+        }
+        printf("},\n");
+    }
+    printf("};\n\n");
+}
+
+int main(void) {
+    static int delta[NUM_PITS][TOTAL_SEEDS + 1][NUM_PITS];
+    static int last[NUM_PITS][TOTAL_SEEDS + 1];
+
+    for (int pit = 0; pit < NUM_PITS; pit++) {
+        for (int seeds = 0; seeds <= TOTAL_SEEDS; seeds++) {
+            // Semis de référence, une graine à la fois
+            int index = pit;
+            for (int left = seeds; left > 0; ) {
+                index = (index + 1) % NUM_PITS;
+                if (index != pit) {
+                    delta[pit][seeds][index]++;
+                    left--;
+                }
+            }
+            last[pit][seeds] = index;
+        }
+    }
+
+    printf("// Fichier généré par src/tools/gen_sow_tables.c -- ne pas modifier\n");
+    printf("#ifndef SOW_TABLES_H\n#define SOW_TABLES_H\n\n");
+
+    printf("static const unsigned char SOW_DELTA[%d][%d][%d] = {\n", NUM_PITS, TOTAL_SEEDS + 1, NUM_PITS);
+    for (int pit = 0; pit < NUM_PITS; pit++) {
+        printf("    {\n");
+        for (int seeds = 0; seeds <= TOTAL_SEEDS; seeds++) {
+            printf("        {");
+            for (int j = 0; j < NUM_PITS; j++) {
+                printf("%d%s", delta[pit][seeds][j], j + 1 < NUM_PITS ? "," : "");
+            }
+            printf("},\n");
+        }
+        printf("    },\n");
+    }
+    printf("};\n\n");
+
+    printf("static const signed char SOW_LAST[%d][%d] = {\n", NUM_PITS, TOTAL_SEEDS + 1);
+    for (int pit = 0; pit < NUM_PITS; pit++) {
+        printf("    {");
+        for (int seeds = 0; seeds <= TOTAL_SEEDS; seeds++) {
+            printf("%d%s", last[pit][seeds], seeds < TOTAL_SEEDS ? "," : "");
+        }
+        printf("},\n");
+    }
+    printf("};\n\n");
+
+    // Clés de Zobrist : une par (case, nombre de graines), par (joueur, score)
+    // et une pour le joueur au trait
+    uint64_t rng = ZOBRIST_SEED;
+    print_keys("ZOBRIST_PIT", NUM_PITS, &rng);
+    print_keys("ZOBRIST_SCORE", 2, &rng);
+    printf("static const uint64_t ZOBRIST_SIDE = 0x%016llxull;\n\n", (unsigned long long)splitmix64(&rng));
+
+    printf("#endif // SOW_TABLES_H\n");
+    return 0;
+}
@@ -0,0 +1,417 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+// Générateur de charge pour le serveur : des paires de clients se défient et
+// enchaînent les parties en jouant des coups légaux au hasard, aussi vite
+// que le serveur répond. Affiche le débit en coups/s et en lignes reçues/s,
+// les octets et segments TCP reçus par coup, et la latence (moyenne, p99)
+// entre un MOVE et le STATE qui le confirme : à lancer contre ./bin/server
+// puis ./bin/server -u pour comparer epoll et io_uring, avec et sans -b.
+//
+// Usage : loadgen [-b] [-D] [-c connexions] [-d secondes] [-j threads] [-p port] [hôte]
+//   -b : protocole binaire v2 (trames, voir include/proto.h)
+//   -D : v2 avec positions en STATE_DELTA (implique -b)
+//   Le serveur ne réutilise pas ses emplacements de clients : le relancer
+//   entre deux mesures.
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <linux/tcp.h>
+#include <poll.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../../include/game.h"
+#include "../../include/linebuf.h"
+#include "../../include/proto.h"
+
+#define DEFAULT_CONNECTIONS 20
+#define DEFAULT_DURATION 10
+#define DEFAULT_PORT 4321
+#define MAX_CONNECTIONS 1024
+#define MAX_THREADS 64
+
+typedef struct {
+    int fd;
+    LineBuffer input;
+    char name[24];
+    int partner;                // Index de l'autre joueur de la paire, dans le tableau du thread
+    int challenger;             // C'est lui qui lance les défis
+    int registered;
+    int player;                 // ROLE de la partie en cours
+    double move_sent;           // Heure du dernier MOVE sans réponse, 0 si aucun
+    int proto;                  // 2 une fois "USERNAME <nom> V2" envoyé
+    AwaleState view;            // Position reconstruite à partir des STATE_DELTA
+    int seq;                    // Son numéro, -1 si aucune
+} Conn;
+
+typedef struct {
+    pthread_t thread;
+    Conn* conns;                // Paires consécutives : 2k défie 2k + 1
+    int count;
+    unsigned seed;
+    unsigned long long moves;
+    unsigned long long games;
+    unsigned long long lines;   // Lignes (ou trames) reçues du serveur
+    unsigned long long bytes;   // Octets reçus du serveur
+    float* latencies;           // Une mesure (s) par coup confirmé
+    size_t num_latencies;
+    size_t cap_latencies;
+} Worker;
+
+static struct sockaddr_in server_addr;
+static double deadline;
+static int use_v2;              // Option -b
+static int use_delta;           // Option -D
+
+static int by_value(const void* a, const void* b) {
+    float x = *(const float*)a;
+    float y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void send_str(Conn* c, const char* s) {
+    char frame[PROTO_HEADER_LEN + 64];
+    size_t n = strlen(s);
+    if (c->proto == 2) {
+        n = proto_encode_line(s, n, frame, sizeof(frame));
+        s = frame;
+    }
+    while (n > 0) {
+        ssize_t w = send(c->fd, s, n, MSG_NOSIGNAL);
+        if (w < 0 && errno == EINTR) {
+            continue;
+        }
+        if (w <= 0) {
+            return;
+        }
+        s += w;
+        n -= (size_t)w;
+    }
+}
+
+static void send_challenge(Conn* conns, Conn* c) {
+    char line[64];
+    snprintf(line, sizeof(line), "CHALLENGE %s\n", conns[c->partner].name);
+    send_str(c, line);
+}
+
+/**
+ * Position d'une ligne STATE ; 0 si elle est mal formée
+ */
+static int parse_state(const char* state_line, AwaleState* s) {
+    int v[15];
+    const char* p = state_line + 6;
+    for (int k = 0; k < 15; k++) {
+        char* end;
+        v[k] = (int)strtol(p, &end, 10);
+        if (end == p) {
+            return 0;
+        }
+        p = end;
+    }
+    for (int k = 0; k < NUM_PITS; k++) {
+        s->board[k] = (char)v[k];
+    }
+    s->scores[0] = (char)v[12];
+    s->scores[1] = (char)v[13];
+    s->current_player = (char)v[14];
+    s->key = 0;
+    return 1;
+}
+
+/**
+ * Joue un coup légal au hasard si c'est au tour de ce client
+ */
+static void play_random_move(Worker* w, Conn* c, const AwaleState* s) {
+    if (s->current_player != c->player) {
+        return;
+    }
+    int legal[PITS_PER_SIDE];
+    int n = 0;
+    for (int pit = c->player * PITS_PER_SIDE; pit < (c->player + 1) * PITS_PER_SIDE; pit++) {
+        if (awale_is_valid_move(s, pit)) {
+            legal[n++] = pit;
+        }
+    }
+    if (n == 0) {
+        return;  // Partie terminée : END suit
+    }
+    char line[32];
+    snprintf(line, sizeof(line), "MOVE %d\n", legal[rand_r(&w->seed) % n]);
+    c->move_sent = now_sec();
+    send_str(c, line);
+}
+
+static void handle_state(Worker* w, Conn* c, const AwaleState* s) {
+    if (c->move_sent > 0) {
+        if (w->num_latencies == w->cap_latencies) {
+            w->cap_latencies = w->cap_latencies ? 2 * w->cap_latencies : 4096;
+            w->latencies = realloc(w->latencies, w->cap_latencies * sizeof(float));
+        }
+        w->latencies[w->num_latencies++] = (float)(now_sec() - c->move_sent);
+        w->moves++;
+        c->move_sent = 0;
+    }
+    play_random_move(w, c, s);
+}
+
+static void handle_line(Worker* w, Conn* c, const char* line) {
+    Conn* partner = &w->conns[c->partner];
+    if (!strcmp(line, "PING")) {
+        send_str(c, "PONG\n");
+    } else if (!strncmp(line, "REGISTER", 8)) {
+        char reply[64];
+        snprintf(reply, sizeof(reply), "USERNAME %s%s%s\n", c->name, use_v2 ? " " PROTO_V2_TOKEN : "",
+                 use_delta ? " " PROTO_DELTA_TOKEN : "");
+        send_str(c, reply);
+        if (use_v2) {
+            c->proto = 2;
+        }
+    } else if (!strncmp(line, "MSG Bienvenue", 13) || !strncmp(line, "MSG Bon retour", 14)) {
+        c->registered = 1;
+        if (partner->registered) {
+            send_challenge(w->conns, c->challenger ? c : partner);
+        }
+    } else if (!strncmp(line, "CHALLENGED_BY ", 14)) {
+        char reply[64];
+        snprintf(reply, sizeof(reply), "ACCEPT %s\n", line + 14);
+        send_str(c, reply);
+    } else if (!strncmp(line, "ROLE ", 5)) {
+        c->player = atoi(line + 5);
+    } else if (!strncmp(line, "STATE ", 6)) {
+        AwaleState s;
+        if (parse_state(line, &s)) {
+            handle_state(w, c, &s);
+        }
+    } else if (!strcmp(line, "ASKSAVE")) {
+        send_str(c, "NO\n");
+    } else if (!strcmp(line, "MSG Partie non sauvegardée.") && c->challenger) {
+        // Les deux réponses sont arrivées : la paire est libre
+        w->games++;
+        send_challenge(w->conns, c);
+    }
+}
+
+static void* worker_main(void* arg) {
+    Worker* w = arg;
+    struct pollfd fds[MAX_CONNECTIONS];
+    for (int k = 0; k < w->count; k++) {
+        fds[k].fd = w->conns[k].fd;
+        fds[k].events = POLLIN;
+    }
+    char line[512];
+    static __thread char payload[PROTO_MAX_PAYLOAD + 1];
+    while (now_sec() < deadline) {
+        if (poll(fds, w->count, 100) <= 0) {
+            continue;
+        }
+        for (int k = 0; k < w->count; k++) {
+            if (!(fds[k].revents & (POLLIN | POLLHUP | POLLERR))) {
+                continue;
+            }
+            Conn* c = &w->conns[k];
+            ssize_t r = linebuf_fill(&c->input, c->fd, MSG_DONTWAIT);
+            if (r == 0 || (r < 0 && errno != EAGAIN && errno != EINTR)) {
+                fprintf(stderr, "%s : connexion fermée par le serveur\n", c->name);
+                fds[k].fd = -1;
+                continue;
+            }
+            if (r > 0) {
+                w->bytes += (unsigned long long)r;
+            }
+            while (c->proto != 2 && linebuf_next_line(&c->input, line, sizeof(line))) {
+                w->lines++;
+                handle_line(w, c, line);
+            }
+            int op;
+            size_t len;
+            while (c->proto == 2 && proto_next_frame(&c->input, &op, payload, sizeof(payload), &len) > 0) {
+                w->lines++;
+                if (op == PROTO_STATE && len == PROTO_STATE_LEN) {
+                    AwaleState s;
+                    proto_decode_state(payload, &s);
+                    handle_state(w, c, &s);
+                } else if (op == PROTO_STATE_DELTA) {
+                    int applied = proto_apply_delta(payload, len, &c->view, &c->seq);
+                    if (applied > 0) {
+                        handle_state(w, c, &c->view);
+                    } else if (applied == 0) {
+                        send_str(c, "RESYNC\n");
+                    }
+                } else {
+                    proto_decode_line(op, payload, len, line, sizeof(line));
+                    handle_line(w, c, line);
+                }
+            }
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char** argv) {
+    int connections = DEFAULT_CONNECTIONS;
+    int duration = DEFAULT_DURATION;
+    int threads = 1;
+    int port = DEFAULT_PORT;
+    const char* host = "127.0.0.1";
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-b") == 0) {
+            use_v2 = 1;
+        } else if (strcmp(argv[i], "-D") == 0) {
+            use_v2 = 1;
+            use_delta = 1;
+        } else if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+            connections = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) {
+            duration = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (argv[i][0] != '-') {
+            host = argv[i];
+        } else {
+            fprintf(stderr, "Usage : %s [-b] [-D] [-c connexions] [-d secondes] [-j threads] [-p port] [hôte]\n", argv[0]);
+            return 2;
+        }
+    }
+    connections -= connections % 2;
+    if (connections < 2 || connections > MAX_CONNECTIONS) {
+        fprintf(stderr, "Nombre de connexions pair, entre 2 et %d\n", MAX_CONNECTIONS);
+        return 2;
+    }
+    if (threads < 1) {
+        threads = 1;
+    } else if (threads > MAX_THREADS) {
+        threads = MAX_THREADS;
+    }
+    if (threads > connections / 2) {
+        threads = connections / 2;
+    }
+
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_port = htons(port);
+    if (inet_pton(AF_INET, host, &server_addr.sin_addr) != 1) {
+        fprintf(stderr, "Adresse invalide : %s\n", host);
+        return 2;
+    }
+
+    static Conn conns[MAX_CONNECTIONS];
+    for (int k = 0; k < connections; k++) {
+        Conn* c = &conns[k];
+        c->fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (c->fd < 0 || connect(c->fd, (struct sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+            perror("connect");
+            return 1;
+        }
+        // Pas d'algorithme de Nagle : chaque MOVE part tout de suite
+        int one = 1;
+        setsockopt(c->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        linebuf_init(&c->input);
+        snprintf(c->name, sizeof(c->name), "lg%d_%d", (int)(getpid() % 100000), k);
+        c->challenger = (k % 2) == 0;
+        c->registered = 0;
+        c->player = -1;
+        c->move_sent = 0;
+        c->proto = 1;
+        c->seq = -1;
+    }
+
+    // Chaque thread reçoit des paires entières
+    static Worker workers[MAX_THREADS];
+    int pairs = connections / 2;
+    double t0 = now_sec();
+    deadline = t0 + duration;
+    for (int t = 0, first = 0; t < threads; t++) {
+        int n = pairs / threads + (t < pairs % threads);
+        workers[t].conns = &conns[2 * first];
+        workers[t].count = 2 * n;
+        workers[t].seed = (unsigned)time(NULL) ^ (unsigned)(t * 2654435761u);
+        first += n;
+    }
+    for (int t = 0; t < threads; t++) {
+        // Les index de partenaire sont relatifs au tableau du thread
+        for (int k = 0; k < workers[t].count; k++) {
+            workers[t].conns[k].partner = k ^ 1;
+        }
+        if (pthread_create(&workers[t].thread, NULL, worker_main, &workers[t]) != 0) {
+            perror("pthread_create");
+            return 1;
+        }
+    }
+
+    unsigned long long moves = 0;
+    unsigned long long games = 0;
+    unsigned long long lines = 0;
+    unsigned long long bytes = 0;
+    size_t count = 0;
+    for (int t = 0; t < threads; t++) {
+        pthread_join(workers[t].thread, NULL);
+        moves += workers[t].moves;
+        games += workers[t].games;
+        lines += workers[t].lines;
+        bytes += workers[t].bytes;
+        count += workers[t].num_latencies;
+    }
+    double elapsed = now_sec() - t0;
+
+    // Toutes les mesures dans un seul tableau trié, pour le p99
+    float* latencies = malloc((count > 0 ? count : 1) * sizeof(float));
+    double sum = 0;
+    for (int t = 0, k = 0; t < threads; t++) {
+        for (size_t m = 0; m < workers[t].num_latencies; m++) {
+            latencies[k++] = workers[t].latencies[m];
+            sum += workers[t].latencies[m];
+        }
+        free(workers[t].latencies);
+    }
+    qsort(latencies, count, sizeof(float), by_value);
+
+    printf("%d connexions, %d thread%s : %llu coups en %.1f s (%.0f coups/s), %llu parties\n",
+           connections, threads, threads > 1 ? "s" : "", moves, elapsed,
+           elapsed > 0 ? moves / elapsed : 0.0, games);
+    printf("%llu %s reçues (%.0f/s), %llu octets (%.1f par coup)\n", lines, use_v2 ? "trames" : "lignes",
+           elapsed > 0 ? lines / elapsed : 0.0, bytes, moves > 0 ? (double)bytes / moves : 0.0);
+    if (count > 0) {
+        printf("Latence MOVE -> STATE : moyenne %.3f ms, p99 %.3f ms, max %.3f ms\n",
+               1000 * sum / count, 1000 * latencies[(size_t)(0.99 * (count - 1))],
+               1000 * latencies[count - 1]);
+    }
+    free(latencies);
+
+    // Segments de données reçus du serveur, compte tenu par le noyau
+    unsigned long long segments = 0;
+    for (int k = 0; k < connections; k++) {
+        struct tcp_info info;
+        socklen_t len = sizeof(info);
+        if (getsockopt(conns[k].fd, IPPROTO_TCP, TCP_INFO, &info, &len) == 0 &&
+            len >= offsetof(struct tcp_info, tcpi_data_segs_in) + sizeof(info.tcpi_data_segs_in)) {
+            segments += info.tcpi_data_segs_in;
+        }
+        close(conns[k].fd);
+    }
+    if (moves > 0 && segments > 0) {
+        printf("%llu segments reçus (%.2f par coup)\n", segments, (double)segments / moves);
+    }
+    return 0;
+}
@@ -0,0 +1,310 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+// Vérification du protocole v2 contre les lignes forgées : une trame CHAT
+// dont le contenu porte un '\n' redeviendrait, retraduite, plusieurs lignes
+// chez un client en texte ("hello\nEND ..." : un faux END).
+//   - proto_payload_is_line sur quelques contenus ;
+//   - serveur (déjà lancé) : un client v2 envoie un CHAT normal, reçu par un
+//     client texte, puis le CHAT forgé : il est déconnecté et le client
+//     texte ne reçoit rien ;
+//   - relais (bin/relay, lancé par l'outil) : l'outil joue le serveur, envoie
+//     le CHAT forgé entre deux CHAT normaux et vérifie ce que reçoit un
+//     spectateur texte.
+//
+// Usage : proto_check [-p port] [-r bin/relay]
+// Code de retour 1 si une vérification échoue.
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../../include/linebuf.h"
+#include "../../include/proto.h"
+
+#define DEFAULT_PORT 4321
+#define ORIGIN_PORT 4340        // Faux serveur auquel s'abonne le relais
+#define RELAY_PORT 4341
+#define TIMEOUT_MS 2000
+#define FORGED "hello\nEND 0 forged"
+
+typedef struct {
+    int fd;
+    int proto;                  // 2 une fois "USERNAME <nom> V2" envoyé
+    LineBuffer input;
+} Conn;
+
+static int failures;
+
+static void check(int ok, const char* what) {
+    printf("%s : %s\n", ok ? "ok   " : "ÉCHEC", what);
+    if (!ok) {
+        failures++;
+    }
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void set_timeout(int fd, int ms) {
+    struct timeval tv = {ms / 1000, (ms % 1000) * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+}
+
+static int connect_to(int port, double timeout) {
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_port = htons(port)};
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    double give_up = now_sec() + timeout;
+    for (;;) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) {
+            return -1;
+        }
+        if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0) {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            set_timeout(fd, TIMEOUT_MS);
+            return fd;
+        }
+        close(fd);
+        if (errno != ECONNREFUSED || now_sec() > give_up) {
+            return -1;
+        }
+        usleep(10000);  // Pas encore à l'écoute
+    }
+}
+
+static void send_str(int fd, const char* s) {
+    send(fd, s, strlen(s), MSG_NOSIGNAL);
+}
+
+/**
+ * Trame au contenu brut : rien n'est retraduit ni filtré
+ */
+static void send_frame(int fd, int op, const char* payload) {
+    char frame[PROTO_HEADER_LEN + 256];
+    size_t len = strlen(payload);
+    frame[0] = (char)op;
+    frame[1] = (char)(len >> 8);
+    frame[2] = (char)(len & 0xff);
+    memcpy(frame + PROTO_HEADER_LEN, payload, len);
+    send(fd, frame, PROTO_HEADER_LEN + len, MSG_NOSIGNAL);
+}
+
+/**
+ * Message suivant sous forme de ligne (trames retraduites) ; 0 si la
+ * connexion est fermée, -1 si rien n'arrive avant le délai de réception
+ */
+static int next_line(Conn* c, char* line, size_t cap) {
+    static char payload[PROTO_MAX_PAYLOAD + 1];
+    for (;;) {
+        if (c->proto == 2) {
+            int op;
+            size_t len;
+            if (proto_next_frame(&c->input, &op, payload, sizeof(payload), &len) > 0) {
+                proto_decode_line(op, payload, len, line, cap);
+                return 1;
+            }
+        } else if (linebuf_next_line(&c->input, line, cap)) {
+            return 1;
+        }
+        ssize_t r = linebuf_fill(&c->input, c->fd, 0);
+        if (r == 0) {
+            return 0;
+        }
+        if (r < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK ? -1 : 0;
+        }
+    }
+}
+
+/**
+ * Lit jusqu'à une ligne contenant pattern ; retourne 1 si trouvée, et
+ * *forged vaut 1 si une ligne contenant "forged" est passée avant
+ */
+static int wait_for(Conn* c, const char* pattern, int* forged) {
+    char line[PROTO_MAX_PAYLOAD + 64];
+    while (next_line(c, line, sizeof(line)) > 0) {
+        if (forged != NULL && strstr(line, "forged") != NULL) {
+            *forged = 1;
+        }
+        if (strstr(line, pattern) != NULL) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int open_conn(Conn* c, int port, const char* name, int v2) {
+    c->fd = connect_to(port, 2.0);
+    c->proto = 1;
+    linebuf_init(&c->input);
+    if (c->fd < 0 || !wait_for(c, "REGISTER", NULL)) {
+        return -1;
+    }
+    char hello[96];
+    snprintf(hello, sizeof(hello), "USERNAME %s%s\n", name, v2 ? " " PROTO_V2_TOKEN : "");
+    send_str(c->fd, hello);
+    if (v2) {
+        c->proto = 2;
+    }
+    return 0;
+}
+
+static void check_helper(void) {
+    char move = 0;
+    check(proto_payload_is_line(PROTO_CHAT, "bonjour", 7), "contenu d'une ligne accepté");
+    check(!proto_payload_is_line(PROTO_CHAT, FORGED, strlen(FORGED)), "'\\n' refusé");
+    check(!proto_payload_is_line(PROTO_CHAT, "a\rb", 3), "'\\r' refusé");
+    check(!proto_payload_is_line(PROTO_CHAT, "a\0b", 3), "'\\0' refusé");
+    check(proto_payload_is_line(PROTO_MOVE, &move, 1), "MOVE binaire (case 0) accepté");
+}
+
+static void check_server(int port) {
+    char text_name[32];
+    char v2_name[32];
+    char ok_chat[32];
+    snprintf(text_name, sizeof(text_name), "chk_t%d", (int)getpid());
+    snprintf(v2_name, sizeof(v2_name), "chk_v%d", (int)getpid());
+    snprintf(ok_chat, sizeof(ok_chat), "ok-%d", (int)getpid());
+
+    Conn text;
+    Conn v2;
+    if (open_conn(&text, port, text_name, 0) < 0 || !wait_for(&text, "Bienvenue", NULL) ||
+        open_conn(&v2, port, v2_name, 1) < 0 || !wait_for(&v2, "Bienvenue", NULL)) {
+        check(0, "connexion au serveur");
+        return;
+    }
+
+    send_frame(v2.fd, PROTO_CHAT, ok_chat);
+    int forged = 0;
+    check(wait_for(&text, ok_chat, &forged), "serveur : CHAT v2 normal reçu en texte");
+
+    send_frame(v2.fd, PROTO_CHAT, FORGED);
+    char line[PROTO_MAX_PAYLOAD + 64];
+    int r;
+    while ((r = next_line(&v2, line, sizeof(line))) > 0) {
+    }
+    check(r == 0, "serveur : client v2 déconnecté sur le CHAT forgé");
+    set_timeout(text.fd, 500);
+    while (next_line(&text, line, sizeof(line)) > 0) {
+        if (strstr(line, "forged") != NULL || strstr(line, "hello") != NULL) {
+            forged = 1;
+        }
+    }
+    check(!forged, "serveur : rien du CHAT forgé chez le client texte");
+    close(text.fd);
+    close(v2.fd);
+}
+
+/**
+ * Accueil et abonnement du relais, comme le ferait le serveur
+ */
+static int serve_relay(int fd, Conn* origin) {
+    origin->fd = fd;
+    origin->proto = 1;
+    linebuf_init(&origin->input);
+    set_timeout(fd, TIMEOUT_MS);
+    send_str(fd, "REGISTER " PROTO_V2_TOKEN "\n");
+    if (!wait_for(origin, "USERNAME", NULL)) {
+        return -1;
+    }
+    origin->proto = 2;
+    send_frame(fd, PROTO_MSG, "Bienvenue relais");
+    if (!wait_for(origin, "WATCH", NULL)) {
+        return -1;
+    }
+    send_frame(fd, PROTO_MSG, "Vous regardez la partie entre a et b.");
+    AwaleState s;
+    awale_init(&s);
+    char frame[PROTO_HEADER_LEN + PROTO_STATE_LEN];
+    send(fd, frame, proto_encode_state(frame, &s), MSG_NOSIGNAL);
+    return 0;
+}
+
+static void check_relay(const char* relay_path) {
+    int srv = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(srv, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_port = htons(ORIGIN_PORT)};
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (bind(srv, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(srv, 1) < 0) {
+        check(0, "écoute du faux serveur");
+        close(srv);
+        return;
+    }
+
+    char origin_port[16];
+    char listen_port[16];
+    snprintf(origin_port, sizeof(origin_port), "%d", ORIGIN_PORT);
+    snprintf(listen_port, sizeof(listen_port), "%d", RELAY_PORT);
+    pid_t pid = fork();
+    if (pid == 0) {
+        execl(relay_path, "relay", "-l", listen_port, "-t", "10", "-p", origin_port, "0", (char*)NULL);
+        _exit(127);
+    }
+
+    Conn origin;
+    Conn spectator;
+    int fd = accept(srv, NULL, NULL);
+    if (fd < 0 || serve_relay(fd, &origin) < 0 || open_conn(&spectator, RELAY_PORT, "spectateur", 0) < 0 ||
+        !wait_for(&spectator, "STATE", NULL)) {
+        check(0, "abonnement du relais");
+    } else {
+        send_frame(fd, PROTO_CHAT, "[a]: avant");
+        send_frame(fd, PROTO_CHAT, FORGED);
+        send_frame(fd, PROTO_CHAT, "[b]: après");
+        send_frame(fd, PROTO_END, "Partie terminée");
+        int forged = 0;
+        check(wait_for(&spectator, "avant", &forged) && wait_for(&spectator, "après", &forged),
+              "relais : CHAT normaux rediffusés");
+        check(wait_for(&spectator, "END Partie terminée", &forged), "relais : END du serveur rediffusé");
+        check(!forged, "relais : CHAT forgé écarté");
+        close(spectator.fd);
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+    close(srv);
+    kill(pid, SIGTERM);
+    waitpid(pid, NULL, 0);
+}
+
+int main(int argc, char** argv) {
+    int port = DEFAULT_PORT;
+    const char* relay_path = "bin/relay";
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            relay_path = argv[++i];
+        } else {
+            fprintf(stderr, "Usage : %s [-p port] [-r bin/relay]\n", argv[0]);
+            return 2;
+        }
+    }
+    check_helper();
+    check_server(port);
+    check_relay(relay_path);
+    printf("%s\n", failures ? "Des vérifications ont échoué" : "Toutes les vérifications passent");
+    return failures > 0;
+}
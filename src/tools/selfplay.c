@@ -0,0 +1,397 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+// Simulateur de parties sans interface : deux stratégies s'affrontent sur
+// tous les cœurs, en alternant qui commence. Affiche parties/s, répartition
+// des longueurs, avantage du premier joueur et écarts de score.
+//
+// Usage : selfplay [-n parties] [-j threads] [-a stratégie] [-b stratégie]
+//                  [-r demi-coups aléatoires] [-l limite] [-s graine] [-o fichier]
+//   stratégie : random | greedy | engine:N (alpha-bêta à profondeur N)
+//   -o : un enregistrement SelfplayRecord par partie après un SelfplayHeader
+
+#include <math.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../../include/engine.h"
+
+#define DEFAULT_GAMES 100000
+#define DEFAULT_PLY_LIMIT 300   // Au-delà, partie interrompue (cycle)
+#define ENGINE_TT_MB 4          // Table de transposition par thread
+#define LENGTH_BUCKET 20        // Largeur des classes de l'histogramme des longueurs
+#define LENGTH_BUCKETS 16
+#define MARGIN_BUCKET 8
+#define MAX_THREADS 256
+
+typedef enum { POLICY_RANDOM, POLICY_GREEDY, POLICY_ENGINE } PolicyType;
+
+typedef struct {
+    PolicyType type;
+    int depth;                  // POLICY_ENGINE
+    char name[32];
+} Policy;
+
+// Fichier de résultats : en-tête puis un enregistrement par partie
+typedef struct {
+    char magic[4];              // "AWSP"
+    uint32_t games;
+} SelfplayHeader;
+
+typedef struct {
+    uint16_t plies;
+    int8_t scores[2];           // Scores finaux de P1 et P2
+    uint8_t flags;              // Bit 0 : stratégie a en P2, bit 1 : limite atteinte
+    uint8_t reserved;
+} SelfplayRecord;
+
+typedef struct {
+    unsigned long long games;
+    unsigned long long plies;
+    unsigned long long first_wins;      // Victoires de P1
+    unsigned long long draws;
+    unsigned long long a_wins;          // Victoires de la stratégie a
+    unsigned long long capped;
+    long long margin_sum;               // Somme de score P1 - score P2
+    long long margin_sq;
+    int min_plies;
+    int max_plies;
+    unsigned long long lengths[LENGTH_BUCKETS];
+    unsigned long long margins[2 * TOTAL_SEEDS / MARGIN_BUCKET + 1];
+} Stats;
+
+typedef struct {
+    pthread_t thread;
+    int id;
+    int threads;
+    int games;
+    uint64_t rng;
+    Stats stats;
+} Worker;
+
+// Paramètres communs (lecture seule pendant la simulation)
+static Policy policies[2];
+static int random_plies = 2;
+static int ply_limit = DEFAULT_PLY_LIMIT;
+static SelfplayRecord* records;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t next_random(uint64_t* x) {
+    // xorshift64*
+    *x ^= *x >> 12;
+    *x ^= *x << 25;
+    *x ^= *x >> 27;
+    return *x * 0x2545F4914F6CDD1Dull;
+}
+
+static int parse_policy(const char* text, Policy* p) {
+    snprintf(p->name, sizeof(p->name), "%s", text);
+    p->depth = 0;
+    if (!strcmp(text, "random")) {
+        p->type = POLICY_RANDOM;
+    } else if (!strcmp(text, "greedy")) {
+        p->type = POLICY_GREEDY;
+    } else if (!strncmp(text, "engine:", 7) && atoi(text + 7) >= 1) {
+        p->type = POLICY_ENGINE;
+        p->depth = atoi(text + 7);
+    } else {
+        return -1;
+    }
+    return 0;
+}
+
+static int random_move(const AwaleState* s, uint64_t* rng) {
+    int legal = awale_legal_moves(s);
+    int k = (int)(next_random(rng) % __builtin_popcount(legal));
+    while (k--) {
+        legal &= legal - 1;
+    }
+    return s->current_player * PITS_PER_SIDE + __builtin_ctz(legal);
+}
+
+/**
+ * Plus grosse capture immédiate, au hasard parmi les ex aequo
+ */
+static int greedy_move(const AwaleState* s, uint64_t* rng) {
+    int legal = awale_legal_moves(s);
+    int first = s->current_player * PITS_PER_SIDE;
+    int best = -1;
+    int best_pit = -1;
+    int ties = 0;
+    while (legal) {
+        int pit = first + __builtin_ctz(legal);
+        legal &= legal - 1;
+        AwaleState child = *s;
+        int gained = awale_play(&child, pit);
+        if (gained > best) {
+            best = gained;
+            best_pit = pit;
+            ties = 1;
+        } else if (gained == best && next_random(rng) % ++ties == 0) {
+            best_pit = pit;
+        }
+    }
+    return best_pit;
+}
+
+static int choose(const Policy* p, const AwaleState* s, uint64_t* rng, TranspositionTable* tt) {
+    switch (p->type) {
+    case POLICY_GREEDY:
+        return greedy_move(s, rng);
+    case POLICY_ENGINE: {
+        EngineLimits limits = {p->depth, 0, NULL, tt, 1, NULL, NULL};
+        EngineResult result;
+        return engine_search(s, &limits, &result);
+    }
+    default:
+        return random_move(s, rng);
+    }
+}
+
+static void record_game(Stats* st, const AwaleState* s, int plies, int a_second, int capped) {
+    int margin = s->scores[0] - s->scores[1];
+    int winner = margin > 0 ? 0 : margin < 0 ? 1 : -1;
+    st->games++;
+    st->plies += plies;
+    st->first_wins += winner == 0;
+    st->draws += winner == -1;
+    st->a_wins += winner == a_second;
+    st->capped += capped;
+    st->margin_sum += margin;
+    st->margin_sq += margin * margin;
+    if (st->games == 1 || plies < st->min_plies) {
+        st->min_plies = plies;
+    }
+    if (plies > st->max_plies) {
+        st->max_plies = plies;
+    }
+    int bucket = plies / LENGTH_BUCKET;
+    st->lengths[bucket < LENGTH_BUCKETS ? bucket : LENGTH_BUCKETS - 1]++;
+    st->margins[(margin + TOTAL_SEEDS) / MARGIN_BUCKET]++;
+}
+
+static void* worker_main(void* arg) {
+    Worker* w = arg;
+    TranspositionTable tt;
+    TranspositionTable* table = NULL;
+    if ((policies[0].type == POLICY_ENGINE || policies[1].type == POLICY_ENGINE) &&
+        tt_init(&tt, ENGINE_TT_MB) == 0) {
+        table = &tt;
+    }
+
+    // Partie i : la stratégie a joue P1 si i est pair
+    for (int i = w->id; i < w->games; i += w->threads) {
+        int a_second = i & 1;
+        AwaleState s;
+        awale_init(&s);
+        int plies = 0;
+        while (!awale_is_over(&s) && plies < ply_limit) {
+            int side = s.current_player ^ a_second;  // 0 : stratégie a
+            int pit = plies < random_plies ? random_move(&s, &w->rng)
+                                           : choose(&policies[side], &s, &w->rng, table);
+            awale_play(&s, pit);
+            plies++;
+        }
+        int capped = !awale_is_over(&s);
+        awale_collect_remaining(&s);
+        record_game(&w->stats, &s, plies, a_second, capped);
+
+        if (records != NULL) {
+            SelfplayRecord* r = &records[i];
+            r->plies = (uint16_t)plies;
+            r->scores[0] = s.scores[0];
+            r->scores[1] = s.scores[1];
+            r->flags = (uint8_t)(a_second | capped << 1);
+            r->reserved = 0;
+        }
+    }
+
+    if (table != NULL) {
+        tt_free(table);
+    }
+    return NULL;
+}
+
+static void merge(Stats* total, const Stats* st) {
+    if (st->games == 0) {
+        return;
+    }
+    if (total->games == 0 || st->min_plies < total->min_plies) {
+        total->min_plies = st->min_plies;
+    }
+    if (st->max_plies > total->max_plies) {
+        total->max_plies = st->max_plies;
+    }
+    total->games += st->games;
+    total->plies += st->plies;
+    total->first_wins += st->first_wins;
+    total->draws += st->draws;
+    total->a_wins += st->a_wins;
+    total->capped += st->capped;
+    total->margin_sum += st->margin_sum;
+    total->margin_sq += st->margin_sq;
+    for (int i = 0; i < LENGTH_BUCKETS; i++) {
+        total->lengths[i] += st->lengths[i];
+    }
+    for (size_t i = 0; i < sizeof(st->margins) / sizeof(st->margins[0]); i++) {
+        total->margins[i] += st->margins[i];
+    }
+}
+
+static void print_bar(const char* label, unsigned long long count, unsigned long long total) {
+    double share = total ? (double)count / total : 0;
+    printf("  %-10s %6.2f%% ", label, 100 * share);
+    for (int i = 0; i < (int)(share * 100 + 0.5); i++) {
+        putchar('#');
+    }
+    putchar('\n');
+}
+
+static void report(const Stats* st, double elapsed, int threads) {
+    double n = st->games ? (double)st->games : 1;
+    unsigned long long decided = st->games - st->draws;
+    printf("%llu parties, %s contre %s (chacune commence une partie sur deux), %d thread%s\n",
+           st->games, policies[0].name, policies[1].name, threads, threads > 1 ? "s" : "");
+    printf("%.3f s : %.0f parties/s, %.2f M demi-coups/s\n\n", elapsed, st->games / elapsed,
+           st->plies / elapsed / 1e6);
+
+    printf("Victoires : %s %.2f%%, %s %.2f%%, nulles %.2f%%\n", policies[0].name,
+           100 * st->a_wins / n, policies[1].name, 100 * (decided - st->a_wins) / n,
+           100 * st->draws / n);
+    printf("Premier joueur : %.2f%% gagnées, %.2f%% nulles, %.2f%% perdues\n\n",
+           100 * st->first_wins / n, 100 * st->draws / n,
+           100 * (decided - st->first_wins) / n);
+
+    printf("Longueur (demi-coups) : moyenne %.1f, min %d, max %d, %.2f%% interrompues à %d\n",
+           st->plies / n, st->min_plies, st->max_plies, 100 * st->capped / n, ply_limit);
+    for (int i = 0; i < LENGTH_BUCKETS; i++) {
+        if (st->lengths[i] == 0) {
+            continue;
+        }
+        char label[16];
+        if (i == LENGTH_BUCKETS - 1) {
+            snprintf(label, sizeof(label), "%d+", i * LENGTH_BUCKET);
+        } else {
+            snprintf(label, sizeof(label), "%d-%d", i * LENGTH_BUCKET, (i + 1) * LENGTH_BUCKET - 1);
+        }
+        print_bar(label, st->lengths[i], st->games);
+    }
+
+    double mean = st->margin_sum / n;
+    double variance = st->margin_sq / n - mean * mean;
+    printf("\nÉcart de score P1 - P2 : moyenne %+.2f, écart-type %.2f\n", mean,
+           variance > 0 ? sqrt(variance) : 0.0);
+    for (size_t i = 0; i < sizeof(st->margins) / sizeof(st->margins[0]); i++) {
+        if (st->margins[i] == 0) {
+            continue;
+        }
+        char label[16];
+        int low = (int)i * MARGIN_BUCKET - TOTAL_SEEDS;
+        snprintf(label, sizeof(label), "%+d..%+d", low, low + MARGIN_BUCKET - 1);
+        print_bar(label, st->margins[i], st->games);
+    }
+}
+
+int main(int argc, char** argv) {
+    int games = DEFAULT_GAMES;
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    uint64_t seed = (uint64_t)time(NULL);
+    const char* output = NULL;
+    parse_policy("random", &policies[0]);
+    parse_policy("greedy", &policies[1]);
+
+    for (int i = 1; i < argc; i++) {
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        int ok = value != NULL;
+        if (ok && !strcmp(argv[i], "-n")) {
+            games = atoi(value);
+        } else if (ok && !strcmp(argv[i], "-j")) {
+            threads = atoi(value);
+        } else if (ok && !strcmp(argv[i], "-a")) {
+            ok = parse_policy(value, &policies[0]) == 0;
+        } else if (ok && !strcmp(argv[i], "-b")) {
+            ok = parse_policy(value, &policies[1]) == 0;
+        } else if (ok && !strcmp(argv[i], "-r")) {
+            random_plies = atoi(value);
+        } else if (ok && !strcmp(argv[i], "-l")) {
+            ply_limit = atoi(value);
+        } else if (ok && !strcmp(argv[i], "-s")) {
+            seed = strtoull(value, NULL, 10);
+        } else if (ok && !strcmp(argv[i], "-o")) {
+            output = value;
+        } else {
+            ok = 0;
+        }
+        if (!ok || games < 1 || ply_limit < 1 || ply_limit > UINT16_MAX) {
+            fprintf(stderr, "Usage : %s [-n parties] [-j threads] [-a stratégie] [-b stratégie]\n"
+                            "       [-r demi-coups aléatoires] [-l limite] [-s graine] [-o fichier]\n"
+                            "  stratégie : random | greedy | engine:N\n", argv[0]);
+            return 2;
+        }
+        i++;
+    }
+    if (threads < 1) {
+        threads = 1;
+    } else if (threads > MAX_THREADS) {
+        threads = MAX_THREADS;
+    }
+
+    if (output != NULL) {
+        records = calloc(games, sizeof(SelfplayRecord));
+        if (records == NULL) {
+            fprintf(stderr, "Mémoire insuffisante pour %d enregistrements\n", games);
+            return 1;
+        }
+    }
+
+    static Worker workers[MAX_THREADS];
+    double t0 = now_sec();
+    for (int t = 0; t < threads; t++) {
+        workers[t].id = t;
+        workers[t].threads = threads;
+        workers[t].games = games;
+        workers[t].rng = seed * 0x9E3779B97F4A7C15ull + (uint64_t)t * 0xD1B54A32D192ED03ull + 1;
+        if (pthread_create(&workers[t].thread, NULL, worker_main, &workers[t]) != 0) {
+            perror("pthread_create");
+            return 1;
+        }
+    }
+    Stats total;
+    memset(&total, 0, sizeof(total));
+    for (int t = 0; t < threads; t++) {
+        pthread_join(workers[t].thread, NULL);
+        merge(&total, &workers[t].stats);
+    }
+    double elapsed = now_sec() - t0;
+
+    report(&total, elapsed, threads);
+
+    if (output != NULL) {
+        FILE* f = fopen(output, "wb");
+        SelfplayHeader header = {{'A', 'W', 'S', 'P'}, (uint32_t)games};
+        int ok = f != NULL && fwrite(&header, sizeof(header), 1, f) == 1 &&
+                 fwrite(records, sizeof(SelfplayRecord), games, f) == (size_t)games;
+        if (f == NULL || fclose(f) != 0 || !ok) {
+            perror(output);
+            return 1;
+        }
+        free(records);
+    }
+    return 0;
+}
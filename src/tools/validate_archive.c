@@ -0,0 +1,190 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+// Vérification des parties sauvegardées : chaque fichier est relu et rejoué
+// coup par coup (voir include/archive.h) sur tous les cœurs. Signale les
+// coups illégaux, les captures et les scores finaux qui ne correspondent pas
+// à la simulation, puis affiche le débit en parties/s.
+//
+// Usage : validate-archive [-j threads] [-q] [dossier]
+//   -q : n'affiche que le bilan
+// Code de retour 1 si au moins une partie est invalide.
+
+#include <dirent.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../../include/archive.h"
+
+#define MAX_THREADS 256
+
+typedef struct {
+    char* path;
+    int line;                   // Ligne fautive, 0 si l'erreur porte sur le résultat
+    const char* error;          // NULL si la partie est valide
+} Record;
+
+typedef struct {
+    pthread_t thread;
+    int id;
+    int threads;
+    Record* records;
+    size_t count;
+    size_t moves;               // Demi-coups rejoués
+} Worker;
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int by_path(const void* a, const void* b) {
+    return strcmp(((const Record*)a)->path, ((const Record*)b)->path);
+}
+
+/**
+ * Liste les fichiers .txt du dossier, triés par nom ; -1 si illisible
+ */
+static long list_games(const char* dir, Record** out) {
+    DIR* d = opendir(dir);
+    if (d == NULL) {
+        return -1;
+    }
+    Record* records = NULL;
+    size_t count = 0;
+    size_t capacity = 0;
+    struct dirent* entry;
+    while ((entry = readdir(d)) != NULL) {
+        size_t len = strlen(entry->d_name);
+        if (len < 4 || strcmp(entry->d_name + len - 4, ".txt") != 0) {
+            continue;
+        }
+        if (count == capacity) {
+            capacity = capacity ? 2 * capacity : 1024;
+            records = realloc(records, capacity * sizeof(Record));
+        }
+        size_t size = strlen(dir) + len + 2;
+        records[count].path = malloc(size);
+        snprintf(records[count].path, size, "%s/%s", dir, entry->d_name);
+        records[count].line = 0;
+        records[count].error = NULL;
+        count++;
+    }
+    closedir(d);
+    if (count > 0) {
+        qsort(records, count, sizeof(Record), by_path);
+    }
+    *out = records;
+    return (long)count;
+}
+
+/**
+ * Les fichiers sont répartis en entrelacé : le thread t traite t, t + n, ...
+ */
+static void* worker_main(void* arg) {
+    Worker* w = arg;
+    ArchiveGame game;
+    for (size_t i = w->id; i < w->count; i += w->threads) {
+        Record* r = &w->records[i];
+        FILE* f = fopen(r->path, "r");
+        if (f == NULL) {
+            r->error = "fichier illisible";
+            continue;
+        }
+        if (archive_read_game(f, &game) != 0) {
+            r->line = game.line;
+            r->error = game.error;
+        } else {
+            r->error = archive_check_result(&game);
+        }
+        fclose(f);
+        w->moves += game.num_moves;
+    }
+    return NULL;
+}
+
+int main(int argc, char** argv) {
+    int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    int quiet = 0;
+    const char* dir = ARCHIVE_DIR;
+    int positional = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-q") == 0) {
+            quiet = 1;
+        } else if (argv[i][0] != '-' && positional == 0) {
+            dir = argv[i];
+            positional++;
+        } else {
+            fprintf(stderr, "Usage : %s [-j threads] [-q] [dossier]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (threads < 1) {
+        threads = 1;
+    } else if (threads > MAX_THREADS) {
+        threads = MAX_THREADS;
+    }
+
+    double t0 = now_sec();
+    Record* records;
+    long count = list_games(dir, &records);
+    if (count < 0) {
+        perror(dir);
+        return 1;
+    }
+
+    static Worker workers[MAX_THREADS];
+    for (int t = 0; t < threads; t++) {
+        workers[t].id = t;
+        workers[t].threads = threads;
+        workers[t].records = records;
+        workers[t].count = (size_t)count;
+        if (pthread_create(&workers[t].thread, NULL, worker_main, &workers[t]) != 0) {
+            perror("pthread_create");
+            return 1;
+        }
+    }
+    size_t moves = 0;
+    for (int t = 0; t < threads; t++) {
+        pthread_join(workers[t].thread, NULL);
+        moves += workers[t].moves;
+    }
+    double elapsed = now_sec() - t0;
+
+    long invalid = 0;
+    for (long i = 0; i < count; i++) {
+        if (records[i].error == NULL) {
+            continue;
+        }
+        invalid++;
+        if (!quiet) {
+            if (records[i].line > 0) {
+                printf("%s:%d : %s\n", records[i].path, records[i].line, records[i].error);
+            } else {
+                printf("%s : %s\n", records[i].path, records[i].error);
+            }
+        }
+    }
+    printf("%ld parties, %ld invalides, %zu coups rejoués en %.3f s (%.0f parties/s, %d thread%s)\n",
+           count, invalid, moves, elapsed, elapsed > 0 ? count / elapsed : 0.0, threads,
+           threads > 1 ? "s" : "");
+
+    for (long i = 0; i < count; i++) {
+        free(records[i].path);
+    }
+    free(records);
+    return invalid > 0;
+}
@@ -0,0 +1,570 @@
+/*************************************************************************
+                           Awale -- Game
+                             -------------------
+    début                : 21/10/2025
+    copyright            : (C) 2025 par Mohamed et Diego
+    e-mail               : mohamed.lemseffer@insa-lyon.fr / diego.aquinoh@insa-lyon.fr / 
+
+*************************************************************************/
+
+// Générateur de public : deux joueurs font une partie sur le serveur, des
+// relais (bin/relay, lancés par l'outil) la suivent et la rediffusent à un
+// grand nombre de spectateurs répartis entre eux. Les joueurs jouent un coup
+// légal au hasard toutes les -m ms ; pour chaque position reçue par un
+// spectateur, la latence est comptée depuis sa réception par le premier
+// joueur. Affiche les positions reçues par spectateur (moins que de coups
+// quand le tick des relais en fusionne), la latence (moyenne, p99, max) et
+// le nombre de spectateurs qui voient la position finale.
+//
+// Usage : watchgen [-b] [-D] [-r relais] [-s spectateurs] [-m ms] [-t tick_ms] [-p port] [-l port_relais]
+//   -b : spectateurs en protocole v2, -D : v2 avec STATE_DELTA
+//   Les relais écoutent sur port_relais, port_relais + 1, ... ; tout tourne
+//   sur cette machine, et ulimit -n doit couvrir les spectateurs.
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../../include/game.h"
+#include "../../include/linebuf.h"
+#include "../../include/proto.h"
+
+#define DEFAULT_RELAYS 4
+#define DEFAULT_SPECTATORS 1000
+#define DEFAULT_MOVE_MS 50
+#define DEFAULT_TICK_MS 50
+#define DEFAULT_PORT 4321
+#define DEFAULT_RELAY_PORT 4330
+#define MAX_RELAYS 64
+#define DIR_LEN 1024            // Répertoire de l'exécutable, où sont les relais
+#define MAX_EVENTS 512
+#define END_TIMEOUT 10          // Secondes laissées aux relais après la fin de la partie
+
+typedef struct {
+    int fd;
+    LineBuffer input;
+    int proto;                  // 2 une fois "USERNAME <nom> V2" envoyé
+    int watching;               // Accueil du relais reçu
+    int closed;
+    AwaleState view;            // Dernière position reçue
+    int seq;                    // Numéro de view (STATE_DELTA), -1 si aucune
+    int matched;                // Index dans published de la dernière position reconnue
+    int updates;
+} Watcher;
+
+typedef struct {
+    int fd;
+    LineBuffer input;
+    int player;                 // ROLE
+} Player;
+
+// Positions de la partie, dans l'ordre, à leur réception par le premier joueur
+typedef struct {
+    AwaleState s;
+    double t;
+} Published;
+
+static Player players[2];
+static Watcher* watchers;
+static int num_watchers;
+static int use_v2;              // Option -b
+static int use_delta;           // Option -D
+static Published* published;
+static int num_published;
+static int game_over;
+static float* latencies;
+static size_t num_latencies;
+static size_t cap_latencies;
+
+static int by_value(const void* a, const void* b) {
+    float x = *(const float*)a;
+    float y = *(const float*)b;
+    return (x > y) - (x < y);
+}
+
+static double now_sec(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static void send_str(int fd, int proto, const char* s) {
+    char frame[PROTO_HEADER_LEN + 64];
+    size_t n = strlen(s);
+    if (proto == 2) {
+        n = proto_encode_line(s, n, frame, sizeof(frame));
+        s = frame;
+    }
+    while (n > 0) {
+        ssize_t w = send(fd, s, n, MSG_NOSIGNAL);
+        if (w < 0 && errno == EINTR) {
+            continue;
+        }
+        if (w <= 0) {
+            return;
+        }
+        s += w;
+        n -= (size_t)w;
+    }
+}
+
+static int connect_to(int port, double timeout) {
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_port = htons(port)};
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    double give_up = now_sec() + timeout;
+    for (;;) {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0) {
+            return -1;
+        }
+        if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0) {
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            return fd;
+        }
+        close(fd);
+        if (errno != ECONNREFUSED || now_sec() > give_up) {
+            return -1;
+        }
+        usleep(10000);  // Relais pas encore à l'écoute
+    }
+}
+
+/**
+ * Ligne suivante d'un joueur, en attendant au besoin ; 0 si la connexion
+ * est fermée
+ */
+static int player_line(Player* p, char* line, size_t cap) {
+    while (!linebuf_next_line(&p->input, line, cap)) {
+        if (linebuf_fill(&p->input, p->fd, 0) <= 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static int parse_state(const char* state_line, AwaleState* s) {
+    int v[15];
+    const char* p = state_line + 6;
+    for (int k = 0; k < 15; k++) {
+        char* end;
+        v[k] = (int)strtol(p, &end, 10);
+        if (end == p) {
+            return 0;
+        }
+        p = end;
+    }
+    for (int k = 0; k < NUM_PITS; k++) {
+        s->board[k] = (char)v[k];
+    }
+    s->scores[0] = (char)v[12];
+    s->scores[1] = (char)v[13];
+    s->current_player = (char)v[14];
+    s->key = 0;
+    return 1;
+}
+
+static int same_position(const AwaleState* a, const AwaleState* b) {
+    return !memcmp(a->board, b->board, sizeof(a->board)) && a->scores[0] == b->scores[0] &&
+           a->scores[1] == b->scores[1] && a->current_player == b->current_player;
+}
+
+static void publish(const AwaleState* s) {
+    static int cap;
+    if (num_published == cap) {
+        cap = cap ? 2 * cap : 256;
+        published = realloc(published, cap * sizeof(Published));
+    }
+    published[num_published].s = *s;
+    published[num_published].t = now_sec();
+    num_published++;
+}
+
+/**
+ * Position reçue par un spectateur : reconnue parmi les positions publiées
+ * depuis la précédente, sa latence est enregistrée
+ */
+static void watcher_state(Watcher* w, const AwaleState* s) {
+    w->view = *s;
+    w->updates++;
+    for (int j = w->matched + 1; j < num_published; j++) {
+        if (same_position(&published[j].s, s)) {
+            if (num_latencies == cap_latencies) {
+                cap_latencies = cap_latencies ? 2 * cap_latencies : 65536;
+                latencies = realloc(latencies, cap_latencies * sizeof(float));
+            }
+            latencies[num_latencies++] = (float)(now_sec() - published[j].t);
+            w->matched = j;
+            return;
+        }
+    }
+}
+
+static void watcher_line(Watcher* w, const char* line, int index) {
+    if (!strncmp(line, "REGISTER", 8)) {
+        char reply[64];
+        snprintf(reply, sizeof(reply), "USERNAME wg%d_%d%s%s\n", (int)(getpid() % 100000), index,
+                 use_v2 ? " " PROTO_V2_TOKEN : "", use_delta ? " " PROTO_DELTA_TOKEN : "");
+        send_str(w->fd, w->proto, reply);
+        if (use_v2) {
+            w->proto = 2;
+        }
+    } else if (!strncmp(line, "MSG Vous regardez", 17)) {
+        w->watching = 1;
+    } else if (!strncmp(line, "STATE ", 6)) {
+        AwaleState s;
+        if (parse_state(line, &s)) {
+            watcher_state(w, &s);
+        }
+    }
+}
+
+static void read_watcher(int epfd, Watcher* w) {
+    static char line[512];
+    static char payload[PROTO_MAX_PAYLOAD + 1];
+    ssize_t r = linebuf_fill(&w->input, w->fd, MSG_DONTWAIT);
+    if (r < 0 && (errno == EAGAIN || errno == EINTR)) {
+        return;
+    }
+    if (r <= 0) {
+        epoll_ctl(epfd, EPOLL_CTL_DEL, w->fd, NULL);
+        close(w->fd);
+        w->closed = 1;
+        return;
+    }
+    int index = (int)(w - watchers);
+    while (w->proto != 2 && linebuf_next_line(&w->input, line, sizeof(line))) {
+        watcher_line(w, line, index);
+    }
+    int op;
+    size_t len;
+    while (w->proto == 2 && proto_next_frame(&w->input, &op, payload, sizeof(payload), &len) > 0) {
+        if (op == PROTO_STATE && len == PROTO_STATE_LEN) {
+            AwaleState s;
+            proto_decode_state(payload, &s);
+            watcher_state(w, &s);
+        } else if (op == PROTO_STATE_DELTA) {
+            AwaleState s = w->view;
+            int applied = proto_apply_delta(payload, len, &s, &w->seq);
+            if (applied > 0) {
+                watcher_state(w, &s);
+            } else if (applied == 0) {
+                send_str(w->fd, 2, "RESYNC\n");
+            }
+        } else {
+            proto_decode_line(op, payload, len, line, sizeof(line));
+            watcher_line(w, line, index);
+        }
+    }
+}
+
+/**
+ * Ligne d'un joueur pendant la partie ; retourne 1 si c'est à lui de jouer
+ */
+static int read_player_line(Player* p, const char* line) {
+    if (!strncmp(line, "STATE ", 6)) {
+        AwaleState s;
+        if (!parse_state(line, &s)) {
+            return 0;
+        }
+        if (p == &players[0]) {
+            publish(&s);
+        }
+        return s.current_player == p->player && awale_legal_moves(&s) > 0;
+    }
+    if (!strncmp(line, "END ", 4)) {
+        game_over = 1;
+    } else if (!strcmp(line, "PING")) {
+        send_str(p->fd, 1, "PONG\n");
+    } else if (!strcmp(line, "ASKSAVE")) {
+        send_str(p->fd, 1, "NO\n");
+    }
+    return 0;
+}
+
+static void play_random_move(Player* p, unsigned* seed) {
+    const AwaleState* s = &published[num_published - 1].s;
+    int legal[PITS_PER_SIDE];
+    int n = 0;
+    for (int pit = p->player * PITS_PER_SIDE; pit < (p->player + 1) * PITS_PER_SIDE; pit++) {
+        if (awale_is_valid_move(s, pit)) {
+            legal[n++] = pit;
+        }
+    }
+    if (n > 0) {
+        char line[32];
+        snprintf(line, sizeof(line), "MOVE %d\n", legal[rand_r(seed) % n]);
+        send_str(p->fd, 1, line);
+    }
+}
+
+/**
+ * Les deux joueurs se connectent et commencent une partie ; retourne son
+ * numéro sur le serveur, -1 en cas d'échec
+ */
+static int start_game(int port) {
+    char names[2][24];
+    char line[1024];
+    for (int k = 0; k < 2; k++) {
+        snprintf(names[k], sizeof(names[k]), "wg%d_%c", (int)(getpid() % 100000), 'a' + k);
+        players[k].fd = connect_to(port, 0);
+        if (players[k].fd < 0) {
+            perror("connect");
+            return -1;
+        }
+        linebuf_init(&players[k].input);
+        if (!player_line(&players[k], line, sizeof(line))) {
+            return -1;
+        }
+        snprintf(line, sizeof(line), "USERNAME %s\n", names[k]);
+        send_str(players[k].fd, 1, line);
+        do {
+            if (!player_line(&players[k], line, sizeof(line))) {
+                return -1;
+            }
+        } while (strncmp(line, "MSG Bienvenue", 13) && strncmp(line, "MSG Bon retour", 14));
+    }
+    snprintf(line, sizeof(line), "CHALLENGE %s\n", names[1]);
+    send_str(players[0].fd, 1, line);
+    do {
+        if (!player_line(&players[1], line, sizeof(line))) {
+            return -1;
+        }
+    } while (strncmp(line, "CHALLENGED_BY ", 14));
+    snprintf(line, sizeof(line), "ACCEPT %s\n", names[0]);
+    send_str(players[1].fd, 1, line);
+
+    // ROLE puis la position de départ, pour les deux joueurs
+    AwaleState s;
+    for (int k = 0; k < 2; k++) {
+        do {
+            if (!player_line(&players[k], line, sizeof(line))) {
+                return -1;
+            }
+            if (!strncmp(line, "ROLE ", 5)) {
+                players[k].player = atoi(line + 5);
+            }
+        } while (strncmp(line, "STATE ", 6));
+        if (k == 0 && parse_state(line, &s)) {
+            publish(&s);
+        }
+    }
+
+    send_str(players[0].fd, 1, "GAMES\n");
+    do {
+        if (!player_line(&players[0], line, sizeof(line))) {
+            return -1;
+        }
+    } while (strncmp(line, "GAMESLIST", 9));
+    char* entry = strstr(line, names[0]);
+    if (entry == NULL) {
+        return -1;
+    }
+    while (entry > line && entry[-1] != ' ') {
+        entry--;
+    }
+    return atoi(entry);
+}
+
+static pid_t start_relay(const char* dir, int listen_port, int tick_ms, int port, int game_id) {
+    char path[DIR_LEN + sizeof("/relay")];
+    char args[4][16];
+    snprintf(path, sizeof(path), "%s/relay", dir);
+    snprintf(args[0], sizeof(args[0]), "%d", listen_port);
+    snprintf(args[1], sizeof(args[1]), "%d", tick_ms);
+    snprintf(args[2], sizeof(args[2]), "%d", port);
+    snprintf(args[3], sizeof(args[3]), "%d", game_id);
+    pid_t pid = fork();
+    if (pid == 0) {
+        execl(path, "relay", "-l", args[0], "-t", args[1], "-p", args[2], args[3], (char*)NULL);
+        perror(path);
+        _exit(127);
+    }
+    return pid;
+}
+
+int main(int argc, char** argv) {
+    int relays = DEFAULT_RELAYS;
+    int spectators = DEFAULT_SPECTATORS;
+    int move_ms = DEFAULT_MOVE_MS;
+    int tick_ms = DEFAULT_TICK_MS;
+    int port = DEFAULT_PORT;
+    int relay_port = DEFAULT_RELAY_PORT;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-b") == 0) {
+            use_v2 = 1;
+        } else if (strcmp(argv[i], "-D") == 0) {
+            use_v2 = 1;
+            use_delta = 1;
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            relays = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-s") == 0 && i + 1 < argc) {
+            spectators = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            move_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            tick_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+            relay_port = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage : %s [-b] [-D] [-r relais] [-s spectateurs] [-m ms] [-t tick_ms] [-p port] [-l port_relais]\n", argv[0]);
+            return 2;
+        }
+    }
+    if (relays < 1 || relays > MAX_RELAYS || spectators < 1 || tick_ms < 1) {
+        fprintf(stderr, "Entre 1 et %d relais, au moins un spectateur, tick >= 1 ms\n", MAX_RELAYS);
+        return 2;
+    }
+
+    int game_id = start_game(port);
+    if (game_id < 0) {
+        fprintf(stderr, "Impossible de lancer la partie sur le port %d\n", port);
+        return 1;
+    }
+
+    // Les relais sont à côté de cet exécutable
+    char dir[DIR_LEN];
+    snprintf(dir, sizeof(dir), "%s", argv[0]);
+    char* slash = strrchr(dir, '/');
+    if (slash != NULL) {
+        *slash = '\0';
+    } else {
+        snprintf(dir, sizeof(dir), ".");
+    }
+    static pid_t pids[MAX_RELAYS];
+    for (int r = 0; r < relays; r++) {
+        pids[r] = start_relay(dir, relay_port + r, tick_ms, port, game_id);
+    }
+
+    int epfd = epoll_create1(0);
+    watchers = calloc(spectators, sizeof(Watcher));
+    if (watchers == NULL) {
+        perror("calloc");
+        return 1;
+    }
+    for (int k = 0; k < spectators; k++) {
+        Watcher* w = &watchers[k];
+        w->fd = connect_to(relay_port + k % relays, 5);
+        if (w->fd < 0) {
+            fprintf(stderr, "Relais %d injoignable après %d spectateurs\n", k % relays, k);
+            break;
+        }
+        linebuf_init(&w->input);
+        w->proto = 1;
+        w->seq = -1;
+        w->matched = -1;
+        num_watchers++;
+        struct epoll_event ev = {.events = EPOLLIN, .data.u32 = (unsigned)k};
+        epoll_ctl(epfd, EPOLL_CTL_ADD, w->fd, &ev);
+    }
+    for (int k = 0; k < 2; k++) {
+        struct epoll_event ev = {.events = EPOLLIN, .data.u32 = (unsigned)(spectators + k)};
+        epoll_ctl(epfd, EPOLL_CTL_ADD, players[k].fd, &ev);
+    }
+
+    // La partie commence quand tout le public est installé
+    struct epoll_event events[MAX_EVENTS];
+    int ready = 0;
+    double t0 = now_sec();
+    while (ready < num_watchers && now_sec() < t0 + 30) {
+        int n = epoll_wait(epfd, events, MAX_EVENTS, 100);
+        for (int k = 0; k < n; k++) {
+            unsigned id = events[k].data.u32;
+            if ((int)id < spectators) {
+                int was = watchers[id].watching;
+                read_watcher(epfd, &watchers[id]);
+                ready += !was && watchers[id].watching;
+            }
+        }
+    }
+    printf("%d spectateurs sur %d relais, partie %d en cours (installation %.1f s)\n", ready, relays,
+           game_id, now_sec() - t0);
+    fflush(stdout);
+
+    unsigned seed = (unsigned)time(NULL) ^ (unsigned)getpid();
+    const AwaleState* start = &published[num_published - 1].s;
+    Player* to_move = start->current_player == players[0].player ? &players[0] : &players[1];
+    double next_move = now_sec() + move_ms / 1e3;
+    double deadline = 0;
+    int open = num_watchers;
+    char line[1024];
+    t0 = now_sec();
+    while (open > 0 && (deadline == 0 || now_sec() < deadline)) {
+        double now = now_sec();
+        int timeout = to_move == NULL ? 100 : next_move > now ? (int)((next_move - now) * 1e3) + 1 : 0;
+        int n = epoll_wait(epfd, events, MAX_EVENTS, timeout);
+        for (int k = 0; k < n; k++) {
+            unsigned id = events[k].data.u32;
+            if ((int)id < spectators) {
+                read_watcher(epfd, &watchers[id]);
+                open -= watchers[id].closed;
+                continue;
+            }
+            Player* p = &players[id - spectators];
+            if (linebuf_fill(&p->input, p->fd, MSG_DONTWAIT) == 0) {
+                epoll_ctl(epfd, EPOLL_CTL_DEL, p->fd, NULL);
+                continue;
+            }
+            while (linebuf_next_line(&p->input, line, sizeof(line))) {
+                if (read_player_line(p, line)) {
+                    to_move = p;
+                    next_move = now_sec() + move_ms / 1e3;
+                }
+            }
+        }
+        if (game_over && deadline == 0) {
+            to_move = NULL;
+            deadline = now_sec() + END_TIMEOUT;
+        }
+        if (to_move != NULL && now_sec() >= next_move) {
+            play_random_move(to_move, &seed);
+            to_move = NULL;
+        }
+    }
+    double elapsed = now_sec() - t0;
+
+    int up_to_date = 0;
+    long updates = 0;
+    const AwaleState* final = &published[num_published - 1].s;
+    for (int k = 0; k < num_watchers; k++) {
+        updates += watchers[k].updates;
+        up_to_date += same_position(&watchers[k].view, final);
+        if (!watchers[k].closed) {
+            close(watchers[k].fd);
+        }
+    }
+    for (int r = 0; r < relays; r++) {
+        kill(pids[r], SIGTERM);
+        waitpid(pids[r], NULL, 0);
+    }
+
+    qsort(latencies, num_latencies, sizeof(float), by_value);
+    double sum = 0;
+    for (size_t k = 0; k < num_latencies; k++) {
+        sum += latencies[k];
+    }
+    printf("%d coups en %.1f s, %.1f positions reçues par spectateur (tick %d ms)\n", num_published - 1,
+           elapsed, num_watchers > 0 ? (double)updates / num_watchers : 0.0, tick_ms);
+    if (num_latencies > 0) {
+        printf("Latence joueur -> spectateur : moyenne %.3f ms, p99 %.3f ms, max %.3f ms\n",
+               1000 * sum / num_latencies, 1000 * latencies[(size_t)(0.99 * (num_latencies - 1))],
+               1000 * latencies[num_latencies - 1]);
+    }
+    printf("%d/%d spectateurs voient la position finale\n", up_to_date, num_watchers);
+    free(latencies);
+    free(published);
+    free(watchers);
+    return up_to_date == num_watchers && game_over ? 0 : 1;
+}